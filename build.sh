@@ -74,14 +74,72 @@ WHISPER_LIB="../whisper.cpp/libwhisper.a"
 g++ $CXX_FLAGS \
     ../src/main_fixed.cpp \
     ../src/transcriber/transcriber.cpp \
+    ../src/transcriber/wire_protocol.cpp \
+    ../src/transcriber/pcm_convert.cpp \
+    ../src/transcriber/shm_ring.cpp \
+    ../src/transcriber/wav_file.cpp \
+    ../src/transcriber/resampler.cpp \
+    ../src/transcriber/smart_chunker.cpp \
+    ../src/transcriber/sample_span.cpp \
+    ../src/transcriber/audio_pool.cpp \
+    ../src/transcriber/chunk_queue.cpp \
+    ../src/transcriber/audio_energy.cpp \
+    ../src/transcriber/voice_activity.cpp \
+    ../src/transcriber/fft.cpp \
+    ../src/transcriber/whisper_vad.cpp \
+    ../src/transcriber/vad_gate.cpp \
+    ../src/transcriber/chunk_controller.cpp \
+    ../src/transcriber/local_agreement.cpp \
+    ../src/transcriber/overlap_budget.cpp \
+    ../src/transcriber/edge_trim.cpp \
+    ../src/transcriber/pcm_source.cpp \
+    ../src/transcriber/whisper_model.cpp \
+    ../src/transcriber/decode_scheduler.cpp \
+    ../src/transcriber/session_server.cpp \
     $WHISPER_LIB \
     $LINK_FLAGS \
     -o transcriber
 
 echo "✅ Main application built"
 
+# Build shared memory replay tool
+g++ $CXX_FLAGS \
+    ../src/shm_replay/shm_replay.cpp \
+    ../src/transcriber/shm_ring.cpp \
+    ../src/transcriber/wav_file.cpp \
+    ../src/transcriber/pcm_convert.cpp \
+    ../src/transcriber/resampler.cpp \
+    -pthread \
+    -o shm_replay
+
+echo "✅ Shared memory replay tool built"
+
+# Build audio front-end benchmarks
+g++ $CXX_FLAGS \
+    ../src/audio_bench/audio_bench.cpp \
+    ../src/transcriber/resampler.cpp \
+    ../src/transcriber/smart_chunker.cpp \
+    ../src/transcriber/sample_span.cpp \
+    ../src/transcriber/audio_pool.cpp \
+    ../src/transcriber/chunk_queue.cpp \
+    ../src/transcriber/audio_energy.cpp \
+    ../src/transcriber/voice_activity.cpp \
+    ../src/transcriber/fft.cpp \
+    ../src/transcriber/wav_file.cpp \
+    ../src/transcriber/pcm_convert.cpp \
+    ../src/transcriber/chunk_controller.cpp \
+    ../src/transcriber/local_agreement.cpp \
+    ../src/transcriber/overlap_budget.cpp \
+    ../src/transcriber/edge_trim.cpp \
+    ../src/transcriber/pcm_source.cpp \
+    ../src/transcriber/decode_scheduler.cpp \
+    -pthread \
+    -o audio_bench
+
+echo "✅ Benchmark tool built"
+
 # Copy executables to root
-cp audio_capture transcriber ../
+cp audio_capture transcriber shm_replay audio_bench ../
 
 cd ..
 
@@ -113,6 +171,8 @@ echo ""
 echo "📁 Generated files:"
 echo "  ./transcriber     - Main transcription application"
 echo "  ./audio_capture   - Audio capture tool"
+echo "  ./shm_replay      - Replays WAV files into a shared memory ring"
+echo "  ./audio_bench     - Audio front-end benchmarks"
 echo ""
 echo "🚀 Ready to use:"
 echo "  ./transcriber --help"
@@ -10,6 +10,7 @@ echo "📥 Downloading Whisper models for real-time transcription..."
 
 # Base URLs
 HUGGINGFACE_BASE="https://huggingface.co/ggerganov/whisper.cpp/resolve/main"
+VAD_BASE="https://huggingface.co/ggml-org/whisper-vad/resolve/main"
 
 # Model configurations (simplified for better compatibility)
 TINY_MODEL="ggml-tiny.en.bin"
@@ -18,6 +19,7 @@ SMALL_MODEL="ggml-small.en.bin"
 MEDIUM_MODEL="ggml-medium.en.bin"
 LARGE_V3_TURBO_MODEL="ggml-large-v3-turbo.bin"
 LARGE_V3_TURBO_Q8_MODEL="ggml-large-v3-turbo-q8_0.bin"
+SILERO_VAD_MODEL="ggml-silero-v5.1.2.bin"
 
 # Check available disk space
 AVAILABLE_SPACE=$(df -m "$MODELS_DIR" | tail -1 | awk '{print $4}')
@@ -26,6 +28,7 @@ echo "💾 Available disk space: ${AVAILABLE_SPACE}MB"
 download_model() {
     local model_name="$1"
     local description="$2"
+    local base_url="${3:-$HUGGINGFACE_BASE}"
     local model_path="$MODELS_DIR/$model_name"
     
     if [ -f "$model_path" ]; then
@@ -40,7 +43,7 @@ download_model() {
          --retry 3 \
          --retry-delay 5 \
          --continue-at - \
-         "$HUGGINGFACE_BASE/$model_name" \
+         "$base_url/$model_name" \
          -o "$model_path.tmp"
     
     # Verify download completed successfully
@@ -106,6 +109,12 @@ if [[ $REPLY =~ ^[Yy]$ ]]; then
     download_model "ggml-base.bin" "Multilingual base model (142MB)"
 fi
 
+read -p "❓ Download Silero VAD model for --vad-mode whisper? [y/N]: " -n 1 -r
+echo
+if [[ $REPLY =~ ^[Yy]$ ]]; then
+    download_model "$SILERO_VAD_MODEL" "whisper.cpp built-in VAD (1MB)" "$VAD_BASE"
+fi
+
 echo ""
 echo "📊 Model recommendations:"
 echo "  🚀 Real-time: Use ggml-tiny.en.bin or ggml-base.en.bin"
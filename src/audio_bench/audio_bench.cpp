@@ -0,0 +1,2284 @@
+// audio_bench - micro-benchmarks for the audio front end.
+//
+// Runs on synthetic signals so no capture device or model is needed:
+//   ./audio_bench resample     # polyphase vs. linear interpolation
+//   ./audio_bench chunker      # SmartChunker break-point search
+//   ./audio_bench alloc        # Heap allocations per chunk once warmed up
+//   ./audio_bench kernels      # Energy kernels: check against scalar, GB/s per ISA
+//   ./audio_bench vad          # Frame VAD: running-sum ring vs. erase-and-resum, cost per backend
+//   ./audio_bench vad-eval     # Energy vs. spectral VAD on labelled audio: recall, decoder calls avoided
+//   ./audio_bench trim         # Edge trimming: audio never decoded, loud samples kept
+//   ./audio_bench coalesce     # Chunks merged on a full queue keep their timeline positions
+//   ./audio_bench adaptive     # Adaptive chunk sizing against a simulated decoder under changing load
+//   ./audio_bench partials     # LocalAgreement streaming partials: time to first word, commit delay
+//   ./audio_bench convert      # 16-bit PCM to float per ISA, and pipe ingest CPU for float32 vs. int16
+//   ./audio_bench reader       # Pipe reader: per-sample istream vs. read(2) blocks, samples/s and CPU
+//   ./audio_bench source       # PCM source startup handshake, restart gap and pipe capacity
+//   ./audio_bench sessions     # Shared decode pool: live sessions per worker, fairness under a backlog
+
+#include <iostream>
+#include <algorithm>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cerrno>
+#include <cstring>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <optional>
+#include <random>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <sstream>
+#include <thread>
+#include "transcriber/audio_energy.h"
+#include "transcriber/chunk_controller.h"
+#include "transcriber/decode_scheduler.h"
+#include "transcriber/local_agreement.h"
+#include "transcriber/overlap_budget.h"
+#include "transcriber/pcm_convert.h"
+#include "transcriber/edge_trim.h"
+#include "transcriber/pcm_source.h"
+#include "transcriber/resampler.h"
+#include "transcriber/smart_chunker.h"
+#include "transcriber/voice_activity.h"
+#include "transcriber/wav_file.h"
+
+// Every heap allocation in the process is counted, so the alloc benchmark can
+// check that the chunk path stops allocating once warmed up
+static std::atomic<uint64_t> g_heap_allocations{0};
+
+static void* countedAlloc(std::size_t size, std::size_t alignment) {
+    g_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, std::max(alignment, sizeof(void*)), size ? size : 1) != 0) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new(std::size_t size) { return countedAlloc(size, alignof(std::max_align_t)); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return countedAlloc(size, std::size_t(alignment)); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+namespace {
+
+constexpr uint32_t TARGET_RATE = 16000;
+constexpr double BENCH_SECONDS = 30.0;
+constexpr size_t BLOCK_FRAMES = 1024;
+
+struct Tone {
+    double frequency;
+    double amplitude;
+};
+
+// In-band tones every converter should keep, plus one above 8 kHz that must
+// be filtered out rather than aliased back into the speech band
+const std::vector<Tone> IN_BAND = {{220.0, 0.2}, {1000.0, 0.2}, {3150.0, 0.15}, {6400.0, 0.1}};
+const Tone OUT_OF_BAND = {9500.0, 0.1};
+
+// Tones at or above band_limit are left out so a low-rate source is only
+// judged on what it can represent
+std::vector<float> synthesize(uint32_t rate, size_t frames, uint16_t channels,
+                              double band_limit, bool with_alias_tone) {
+    std::vector<float> signal(frames * channels);
+    for (size_t i = 0; i < frames; i++) {
+        double t = double(i) / rate;
+        double sample = 0.0;
+        for (const Tone& tone : IN_BAND) {
+            if (tone.frequency < band_limit) {
+                sample += tone.amplitude * std::sin(2.0 * M_PI * tone.frequency * t);
+            }
+        }
+        if (with_alias_tone && OUT_OF_BAND.frequency < rate / 2.0) {
+            sample += OUT_OF_BAND.amplitude * std::sin(2.0 * M_PI * OUT_OF_BAND.frequency * t);
+        }
+        for (uint16_t c = 0; c < channels; c++) {
+            signal[i * channels + c] = static_cast<float>(sample);
+        }
+    }
+    return signal;
+}
+
+// The capture tool's original converter: linear interpolation per sample
+void resampleLinear(const float* in, size_t count, uint32_t input_rate, std::vector<float>& out) {
+    double step = double(input_rate) / TARGET_RATE;
+    size_t frames = static_cast<size_t>(count / step);
+    for (size_t i = 0; i < frames; i++) {
+        double position = i * step;
+        size_t index = static_cast<size_t>(position);
+        double fraction = position - index;
+        float next = index + 1 < count ? in[index + 1] : in[index];
+        out.push_back(static_cast<float>(in[index] * (1.0 - fraction) + next * fraction));
+    }
+}
+
+// SNR of a 16 kHz result against the ideal in-band signal, ignoring the
+// first and last 100 ms where block edges dominate
+double measureSnr(const std::vector<float>& out, double band_limit) {
+    std::vector<float> reference = synthesize(TARGET_RATE, out.size(), 1, band_limit, false);
+    size_t margin = TARGET_RATE / 10;
+    double signal = 0.0;
+    double noise = 0.0;
+    for (size_t i = margin; i + margin < out.size(); i++) {
+        double error = out[i] - reference[i];
+        signal += double(reference[i]) * reference[i];
+        noise += error * error;
+    }
+    return noise > 0.0 ? 10.0 * std::log10(signal / noise) : 999.0;
+}
+
+double timeSeconds(const std::function<void()>& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int benchResample() {
+    const uint32_t rates[] = {8000, 22050, 44100, 48000};
+    const uint16_t layouts[] = {1, 2};
+
+    std::cout << "🔬 Resampling to " << TARGET_RATE << " Hz mono (" << BENCH_SECONDS
+              << "s of audio per case, dot product: " << resamplerIsa() << ")\n\n";
+    std::cout << std::left << std::setw(16) << "input"
+              << std::setw(12) << "method"
+              << std::right << std::setw(14) << "Msamples/s"
+              << std::setw(12) << "x realtime"
+              << std::setw(10) << "SNR dB" << "\n";
+    std::cout << std::string(64, '-') << "\n";
+
+    for (uint32_t rate : rates) {
+        for (uint16_t channels : layouts) {
+            size_t frames = static_cast<size_t>(rate * BENCH_SECONDS);
+            double band_limit = 0.45 * std::min(rate, TARGET_RATE);
+            std::vector<float> input = synthesize(rate, frames, channels, band_limit, true);
+            std::vector<float> mono(BLOCK_FRAMES);
+
+            // Both converters see the same block-at-a-time downmix
+            std::vector<float> polyphase_out;
+            polyphase_out.reserve(size_t(TARGET_RATE * BENCH_SECONDS) + 1);
+            PolyphaseResampler resampler(rate, TARGET_RATE);
+            double polyphase_time = timeSeconds([&]() {
+                for (size_t offset = 0; offset < frames; offset += BLOCK_FRAMES) {
+                    size_t count = std::min(BLOCK_FRAMES, frames - offset);
+                    downmixToMono(input.data() + offset * channels, count, channels, mono.data());
+                    resampler.process(mono.data(), count, polyphase_out);
+                }
+                resampler.flush(polyphase_out);
+            });
+
+            std::vector<float> linear_out;
+            linear_out.reserve(size_t(TARGET_RATE * BENCH_SECONDS) + 1);
+            double linear_time = timeSeconds([&]() {
+                std::vector<float> whole(frames);
+                downmixToMono(input.data(), frames, channels, whole.data());
+                resampleLinear(whole.data(), frames, rate, linear_out);
+            });
+
+            std::string label = std::to_string(rate) + " Hz " + (channels == 1 ? "mono" : "stereo");
+            auto row = [&](const char* method, double seconds, const std::vector<float>& out) {
+                std::cout << std::left << std::setw(16) << label
+                          << std::setw(12) << method
+                          << std::right << std::fixed << std::setprecision(1)
+                          << std::setw(14) << frames / seconds / 1e6
+                          << std::setw(12) << std::setprecision(0) << BENCH_SECONDS / seconds
+                          << std::setw(10) << std::setprecision(1) << measureSnr(out, band_limit) << "\n";
+            };
+            row("polyphase", polyphase_time, polyphase_out);
+            row("linear", linear_time, linear_out);
+        }
+    }
+
+    std::cout << "\nPolyphase latency (input samples): ";
+    for (uint32_t rate : rates) {
+        std::cout << rate << " Hz: " << PolyphaseResampler(rate, TARGET_RATE).latency() << "  ";
+    }
+    std::cout << std::endl;
+    return 0;
+}
+
+// The original break-point search, which rescans from the optimal size on
+// every call and tests a whole pause window at each frame. Frames are
+// classified by the same VAD as they arrive; only the search is rescanned.
+class RescanChunker {
+public:
+    static constexpr size_t FRAME_SAMPLES = 320;
+
+    explicit RescanChunker(const TranscriptionConfig& config)
+        : config_(config)
+        , vad_(1, 0, config.silence_threshold, FRAME_SAMPLES) {}
+
+    std::optional<std::pair<uint64_t, uint64_t>> processAudio(const float* audio, size_t count) {
+        buffer_.insert(buffer_.end(), audio, audio + count);
+        for (size_t i = 0; i < count; i++) {
+            if (vad_.process(audio + i, 1) > 0) {
+                voiced_.push_back(true);
+            } else if ((fed_ + i + 1) % FRAME_SAMPLES == 0) {
+                voiced_.push_back(false);
+            }
+        }
+        fed_ += count;
+
+        int samples_per_ms = TARGET_RATE / 1000;
+        size_t min_samples = config_.min_chunk_duration_ms * samples_per_ms;
+        size_t max_samples = config_.max_chunk_duration_ms * samples_per_ms;
+        size_t optimal_samples = config_.optimal_chunk_duration_ms * samples_per_ms;
+        size_t silence_frames = std::max<size_t>((config_.min_silence_duration_ms * samples_per_ms + FRAME_SAMPLES - 1) / FRAME_SAMPLES, 1);
+        if (buffer_.size() < min_samples) {
+            return std::nullopt;
+        }
+        // Frames are aligned to the stream, not the buffer
+        for (size_t frame = (start_ + optimal_samples + FRAME_SAMPLES - 1) / FRAME_SAMPLES;
+             frame + silence_frames <= voiced_.size() && frame * FRAME_SAMPLES - start_ < max_samples; frame++) {
+            bool pause = std::none_of(voiced_.begin() + frame, voiced_.begin() + frame + silence_frames,
+                                      [](bool voiced) { return voiced; });
+            if (pause) {
+                return extract(frame * FRAME_SAMPLES - start_ + silence_frames * FRAME_SAMPLES / 2);
+            }
+        }
+        if (buffer_.size() >= max_samples) {
+            return extract(max_samples);
+        }
+        return std::nullopt;
+    }
+
+private:
+    std::pair<uint64_t, uint64_t> extract(size_t samples) {
+        std::pair<uint64_t, uint64_t> span = {start_, start_ + samples};
+        size_t overlap = OverlapBudget::leadSamples(config_);
+        size_t consumed = samples > overlap ? samples - overlap : samples;
+        buffer_.erase(buffer_.begin(), buffer_.begin() + consumed);
+        start_ += consumed;
+        return span;
+    }
+
+    TranscriptionConfig config_;
+    LevelVad vad_;
+    std::vector<bool> voiced_;  // Per stream frame
+    uint64_t fed_ = 0;
+    std::vector<float> buffer_;
+    uint64_t start_ = 0;
+};
+
+// Voiced speech stand-in: a 120 Hz harmonic stack under a 4 Hz syllable
+// envelope. Zero crossings dip below the silence threshold, but no run is
+// long enough to split on unless pauses are inserted.
+std::vector<float> synthesizeSpeech(size_t frames, bool with_pauses) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> noise(-0.005f, 0.005f);
+    std::uniform_int_distribution<int> pause_gap(4, 9);
+
+    std::vector<float> signal(frames);
+    size_t next_pause = size_t(pause_gap(rng)) * TARGET_RATE;
+    for (size_t i = 0; i < frames; i++) {
+        if (with_pauses && i >= next_pause) {
+            // 400 ms of room noise, then speech resumes
+            size_t end = std::min(frames, i + TARGET_RATE * 2 / 5);
+            for (; i < end; i++) {
+                signal[i] = noise(rng);
+            }
+            next_pause = i + size_t(pause_gap(rng)) * TARGET_RATE;
+            i--;
+            continue;
+        }
+        double t = double(i) / TARGET_RATE;
+        double envelope = 0.55 + 0.45 * std::sin(2.0 * M_PI * 4.0 * t);
+        double voiced = 0.0;
+        for (int harmonic = 1; harmonic <= 4; harmonic++) {
+            voiced += std::sin(2.0 * M_PI * 120.0 * harmonic * t) / harmonic;
+        }
+        signal[i] = static_cast<float>(0.2 * envelope * voiced) + noise(rng);
+    }
+    return signal;
+}
+
+int benchChunker() {
+    constexpr double SECONDS = 300.0;
+    constexpr size_t CALL_SAMPLES = 1024;  // What the streaming chunker thread feeds per call
+    TranscriptionConfig config;
+    size_t frames = static_cast<size_t>(TARGET_RATE * SECONDS);
+
+    std::cout << "🔬 SmartChunker break-point search (" << SECONDS << "s of audio, "
+              << CALL_SAMPLES << " samples per call)\n\n";
+    std::cout << std::left << std::setw(22) << "signal"
+              << std::setw(12) << "search"
+              << std::right << std::setw(10) << "chunks"
+              << std::setw(14) << "us / call"
+              << std::setw(14) << "x realtime" << "\n";
+    std::cout << std::string(72, '-') << "\n";
+
+    bool all_match = true;
+    size_t context_samples = config.context_duration_ms * TARGET_RATE / 1000;
+    std::vector<std::pair<std::string, std::pair<double, double>>> redundancy;
+    for (bool with_pauses : {false, true}) {
+        std::vector<float> signal = synthesizeSpeech(frames, with_pauses);
+        std::vector<std::pair<uint64_t, uint64_t>> incremental_spans;
+        std::vector<std::pair<uint64_t, uint64_t>> rescan_spans;
+
+        AudioBlockPool pool;
+        SmartChunker chunker(config, pool);
+        AudioChunk chunk;
+        double incremental_time = timeSeconds([&]() {
+            for (size_t offset = 0; offset < frames; offset += CALL_SAMPLES) {
+                size_t count = std::min(CALL_SAMPLES, frames - offset);
+                if (chunker.processAudio(signal.data() + offset, count, chunk)) {
+                    incremental_spans.push_back({chunk.start_sample, chunk.end_sample});
+                }
+            }
+        });
+        chunk.audio.clear();
+
+        RescanChunker rescan(config);
+        double rescan_time = timeSeconds([&]() {
+            for (size_t offset = 0; offset < frames; offset += CALL_SAMPLES) {
+                size_t count = std::min(CALL_SAMPLES, frames - offset);
+                auto span = rescan.processAudio(signal.data() + offset, count);
+                if (span) {
+                    rescan_spans.push_back(*span);
+                }
+            }
+        });
+
+        // The incremental search may accept a window one call earlier than
+        // the rescan, which needs a sample past the window; allow one call
+        bool match = incremental_spans.size() == rescan_spans.size();
+        for (size_t i = 0; match && i < incremental_spans.size(); i++) {
+            auto diff = [](uint64_t a, uint64_t b) { return a > b ? a - b : b - a; };
+            match = diff(incremental_spans[i].first, rescan_spans[i].first) <= CALL_SAMPLES &&
+                    diff(incremental_spans[i].second, rescan_spans[i].second) <= CALL_SAMPLES;
+        }
+        all_match = all_match && match;
+
+        const char* label = with_pauses ? "speech with pauses" : "unbroken speech";
+        size_t calls = (frames + CALL_SAMPLES - 1) / CALL_SAMPLES;
+        auto row = [&](const char* method, double seconds, size_t chunks) {
+            std::cout << std::left << std::setw(22) << label
+                      << std::setw(12) << method
+                      << std::right << std::setw(10) << chunks
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(14) << seconds * 1e6 / calls
+                      << std::setprecision(0)
+                      << std::setw(14) << SECONDS / seconds << "\n";
+        };
+        row("incremental", incremental_time, incremental_spans.size());
+        row("rescan", rescan_time, rescan_spans.size());
+        
+        // Audio decoded twice: the lead-in only, against the former 2 s
+        // overlap plus the previous chunk's last 2 s prepended as context
+        uint64_t decoded_end = 0;
+        uint64_t previous_length = 0;
+        double redundant = 0.0;
+        double before = 0.0;
+        for (const auto& span : incremental_spans) {
+            uint64_t shared = decoded_end > span.first ? decoded_end - span.first : 0;
+            redundant += shared;
+            before += 2.0 * TARGET_RATE * (decoded_end > 0) + std::min<uint64_t>(previous_length, context_samples);
+            decoded_end = span.second;
+            previous_length = span.second - span.first;
+        }
+        double new_audio = double(decoded_end) - redundant;
+        redundancy.push_back({label, {redundant / new_audio, before / new_audio}});
+    }
+    
+    std::cout << "\nAudio decoded twice per second of new audio (lead-in "
+              << OverlapBudget::leadSamples(config) * 1000 / TARGET_RATE << "ms):\n";
+    for (const auto& entry : redundancy) {
+        std::cout << "  " << std::left << std::setw(20) << entry.first << std::right << std::fixed
+                  << std::setprecision(2) << entry.second.first << "s (was " << entry.second.second
+                  << "s with overlap + prepended context)\n";
+    }
+
+    std::cout << "\nChunk boundaries " << (all_match ? "match" : "DIFFER") << " between searches" << std::endl;
+    return all_match ? 0 : 1;
+}
+
+// Drives the streaming chunk path the way the chunker and transcription
+// threads do: chunker -> queue -> VAD energy -> gather -> overlap -> recycle.
+// Only whisper itself is left out.
+int benchAlloc() {
+    constexpr double WARMUP_SECONDS = 120.0;   // Unbroken speech: every chunk hits the maximum length
+    constexpr double MEASURE_SECONDS = 600.0;  // Speech with pauses: chunks of varying length
+    constexpr size_t CALL_SAMPLES = 4096;      // StreamingTranscriber::CHUNKER_BLOCK_SAMPLES
+    TranscriptionConfig config;
+
+    AudioBlockPool pool;
+    SmartChunker chunker(config, pool);
+    ChunkQueue queue(config.chunk_queue_size, config.queue_overflow_policy,
+                     size_t(config.max_chunk_duration_ms) * TARGET_RATE / 1000);
+    OverlapBudget overlap;
+    uint64_t decoded_end = 0;
+    std::vector<float> audio;
+    AudioChunkPtr next_chunk;
+    float energy = 0.0f;
+
+    auto run = [&](const std::vector<float>& signal) {
+        size_t chunks = 0;
+        for (size_t offset = 0; offset < signal.size(); offset += CALL_SAMPLES) {
+            size_t count = std::min(CALL_SAMPLES, signal.size() - offset);
+            if (!next_chunk) {
+                next_chunk = queue.acquire();
+            }
+            if (!chunker.processAudio(signal.data() + offset, count, *next_chunk)) {
+                continue;
+            }
+            queue.push(std::move(next_chunk));
+
+            AudioChunkPtr chunk = queue.pop();
+            energy += chunk->audio.sumOfSquares();
+            audio.resize(chunk->audio.size());
+            chunk->audio.copyTo(audio.data());
+            overlap.record(chunk->audio.size(), OverlapBudget::redundantSamples(*chunk, decoded_end), 0);
+            decoded_end = chunk->end_sample;
+            queue.recycle(std::move(chunk));
+            chunks++;
+        }
+        return chunks;
+    };
+
+    std::vector<float> warmup = synthesizeSpeech(size_t(TARGET_RATE * WARMUP_SECONDS), false);
+    std::vector<float> measured = synthesizeSpeech(size_t(TARGET_RATE * MEASURE_SECONDS), true);
+
+    uint64_t before = g_heap_allocations.load();
+    size_t warmup_chunks = run(warmup);
+    uint64_t warmup_allocations = g_heap_allocations.load() - before;
+
+    before = g_heap_allocations.load();
+    size_t measured_chunks = run(measured);
+    uint64_t measured_allocations = g_heap_allocations.load() - before;
+
+    AudioPoolStats pool_stats = pool.stats();
+    ChunkQueueStats queue_stats = queue.stats();
+    std::cout << "🔬 Heap allocations on the chunk path (" << CALL_SAMPLES << " samples per call)\n\n";
+    std::cout << std::left << std::setw(26) << "phase"
+              << std::right << std::setw(10) << "chunks"
+              << std::setw(14) << "allocations"
+              << std::setw(14) << "per chunk" << "\n";
+    std::cout << std::string(64, '-') << "\n";
+    auto row = [](const char* phase, size_t chunks, uint64_t allocations) {
+        std::cout << std::left << std::setw(26) << phase
+                  << std::right << std::setw(10) << chunks
+                  << std::setw(14) << allocations
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(14) << (chunks ? double(allocations) / chunks : 0.0) << "\n";
+    };
+    row("warmup (unbroken speech)", warmup_chunks, warmup_allocations);
+    row("steady (with pauses)", measured_chunks, measured_allocations);
+
+    std::cout << "\nBlocks: " << pool_stats.blocks_allocated << " allocated, "
+              << pool_stats.blocks_reused << " reused, peak " << pool_stats.peak_blocks_in_use << " in use"
+              << "\nChunks: " << queue_stats.chunks_allocated << " allocated, "
+              << queue_stats.chunks_reused << " reused" << "\n";
+
+    bool clean = measured_allocations == 0 && measured_chunks > 0 && energy > 0.0f;
+    std::cout << "\nSteady state " << (clean ? "allocation-free" : "ALLOCATES") << std::endl;
+    return clean ? 0 : 1;
+}
+
+// Every supported ISA level is checked against the scalar reference on odd
+// lengths and misaligned starts, then timed on a cache-resident chunk
+int benchKernels() {
+    constexpr size_t TIMED_SAMPLES = 16000;  // One second: stays in L1/L2
+    constexpr int TIMED_PASSES = 20000;
+    constexpr float THRESHOLD = 0.02f;
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> sample(-0.05f, 0.05f);
+    std::vector<float> signal(TIMED_SAMPLES);
+    for (float& x : signal) {
+        x = sample(rng);
+    }
+    signal[1234] = -0.9f;  // A negative peak must still win max-abs
+
+    std::vector<EnergyKernels> kernels = supportedEnergyKernels();
+    const EnergyKernels& reference = kernels.front();
+
+    std::cout << "🔬 Energy kernels (selected: " << energyKernelIsa() << ")\n\n";
+    std::cout << std::left << std::setw(10) << "isa"
+              << std::setw(10) << "matches"
+              << std::right << std::setw(16) << "sumsq GB/s"
+              << std::setw(16) << "maxabs GB/s"
+              << std::setw(16) << "count GB/s" << "\n";
+    std::cout << std::string(68, '-') << "\n";
+
+    bool all_match = true;
+    volatile float sink = 0.0f;
+    for (const EnergyKernels& kernel : kernels) {
+        bool match = true;
+        for (size_t start = 0; start < 8 && match; start++) {
+            for (size_t count : {size_t(0), size_t(1), size_t(7), size_t(15), size_t(16), size_t(33), size_t(1000), size_t(4096)}) {
+                const float* x = signal.data() + start;
+                float expected = reference.sum_of_squares(x, count);
+                float got = kernel.sum_of_squares(x, count);
+                match = match && std::abs(got - expected) <= 1e-4f * std::max(expected, 1e-6f) &&
+                        kernel.max_abs(x, count) == reference.max_abs(x, count) &&
+                        kernel.count_above(x, count, THRESHOLD) == reference.count_above(x, count, THRESHOLD);
+            }
+        }
+        all_match = all_match && match;
+
+        auto throughput = [&](const std::function<float()>& pass) {
+            double seconds = timeSeconds([&]() {
+                for (int i = 0; i < TIMED_PASSES; i++) {
+                    sink = sink + pass();
+                }
+            });
+            return double(TIMED_SAMPLES) * sizeof(float) * TIMED_PASSES / seconds / 1e9;
+        };
+        const float* x = signal.data();
+        double sumsq = throughput([&]() { return kernel.sum_of_squares(x, TIMED_SAMPLES); });
+        double maxabs = throughput([&]() { return kernel.max_abs(x, TIMED_SAMPLES); });
+        double count = throughput([&]() { return float(kernel.count_above(x, TIMED_SAMPLES, THRESHOLD)); });
+
+        std::cout << std::left << std::setw(10) << kernel.isa
+                  << std::setw(10) << (match ? "yes" : "NO")
+                  << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(16) << sumsq
+                  << std::setw(16) << maxabs
+                  << std::setw(16) << count << "\n";
+    }
+
+    std::cout << "\nAll kernels " << (all_match ? "match" : "DIFFER FROM") << " the scalar reference" << std::endl;
+    return all_match ? 0 : 1;
+}
+
+// The original detector: a vector window that erases its front and re-sums
+// every entry per frame, with a single threshold and no hangover
+class LegacyVad {
+public:
+    LegacyVad(float threshold, size_t window_size) : threshold_(threshold), window_size_(window_size) {}
+
+    bool isVoiceActive(const std::vector<float>& frame) {
+        float energy = 0.0f;
+        for (float sample : frame) {
+            energy += sample * sample;
+        }
+        energy = std::sqrt(energy / frame.size());
+        if (frame_count_++ == 0) {
+            background_ = energy;
+        } else if (energy < background_ * 2.0f) {
+            background_ = 0.01f * energy + 0.99f * background_;
+        }
+        energies_.push_back(energy);
+        if (energies_.size() > window_size_) {
+            energies_.erase(energies_.begin());
+        }
+        float average = 0.0f;
+        for (float e : energies_) {
+            average += e;
+        }
+        average /= energies_.size();
+        return average > threshold_ * background_;
+    }
+
+private:
+    float threshold_;
+    size_t window_size_;
+    std::vector<float> energies_;
+    float background_ = 0.0f;
+    uint64_t frame_count_ = 0;
+};
+
+// Reference for the template policies: the energy backend behind an
+// interface, paying a virtual call per frame
+class VirtualFramePolicy {
+public:
+    virtual ~VirtualFramePolicy() = default;
+    virtual FrameVerdict classify(const float* frame) = 0;
+    virtual void reset() = 0;
+};
+
+class VirtualEnergyPolicy : public VirtualFramePolicy {
+public:
+    FrameVerdict classify(const float* frame) override { return energy_.classify(frame); }
+    void reset() override { energy_.reset(); }
+
+private:
+    EnergyVadPolicy energy_{0.6f, TARGET_RATE / 50, 10, 0.0f};
+};
+
+class VirtualSilencePolicy : public VirtualFramePolicy {
+public:
+    FrameVerdict classify(const float*) override { return FrameVerdict::Silence; }
+    void reset() override {}
+};
+
+// The choice depends on a runtime value so the compiler cannot devirtualize
+std::unique_ptr<VirtualFramePolicy> makeVirtualEnergyPolicy(bool silence) {
+    if (silence) {
+        return std::make_unique<VirtualSilencePolicy>();
+    }
+    return std::make_unique<VirtualEnergyPolicy>();
+}
+
+struct VirtualPolicy {
+    explicit VirtualPolicy(std::unique_ptr<VirtualFramePolicy> impl) : impl_(std::move(impl)) {}
+    size_t frameSamples() const { return TARGET_RATE / 50; }
+    FrameVerdict classify(const float* frame) { return impl_->classify(frame); }
+    void reset() { impl_->reset(); }
+
+    std::unique_ptr<VirtualFramePolicy> impl_;
+};
+
+int benchVad() {
+    constexpr double SECONDS = 600.0;
+    constexpr size_t FRAME = 320;    // 20 ms
+    constexpr size_t HANGOVER = 15;  // 300 ms
+    size_t frames = size_t(TARGET_RATE * SECONDS) / FRAME;
+    std::vector<float> signal = synthesizeSpeech(frames * FRAME, true);
+    std::vector<float> frame(FRAME);
+
+    std::cout << "🔬 Frame VAD (" << SECONDS << "s of speech with pauses, " << FRAME << "-sample frames)\n\n";
+    std::cout << std::left << std::setw(28) << "detector"
+              << std::right << std::setw(16) << "window frames"
+              << std::setw(14) << "ns / frame" << "\n";
+    std::cout << std::string(58, '-') << "\n";
+
+    volatile size_t sink = 0;
+    for (size_t window : {size_t(10), size_t(100), size_t(512)}) {
+        LegacyVad legacy(0.6f, window);
+        double legacy_time = timeSeconds([&]() {
+            for (size_t f = 0; f < frames; f++) {
+                std::copy(signal.begin() + f * FRAME, signal.begin() + (f + 1) * FRAME, frame.begin());
+                sink = sink + legacy.isVoiceActive(frame);
+            }
+        });
+
+        EnergyVad detector(ENERGY_VAD_ONSET_FRAMES, HANGOVER, 0.6f, FRAME, window, 0.0f);
+        double ring_time = timeSeconds([&]() {
+            for (size_t f = 0; f < frames; f++) {
+                sink = sink + detector.process(signal.data() + f * FRAME, FRAME);
+            }
+        });
+
+        auto row = [&](const char* name, double seconds) {
+            std::cout << std::left << std::setw(28) << name
+                      << std::right << std::setw(16) << window
+                      << std::fixed << std::setprecision(1)
+                      << std::setw(14) << seconds * 1e9 / frames << "\n";
+        };
+        row("erase + re-sum", legacy_time);
+        row("running sum + hysteresis", ring_time);
+    }
+    std::cout << "\nThe running-sum cost is the frame's energy plus a constant, at any window\n";
+
+    // Backends on 10 s of audio replayed from cache, so the per-frame work
+    // rather than memory bandwidth is what gets timed (best of 5 runs)
+    constexpr size_t PASS_FRAMES = 500;
+    constexpr int PASSES = 60;
+    auto perFrame = [&](auto& vad) {
+        double best = 1e30;
+        for (int run = 0; run < 5; run++) {
+            best = std::min(best, timeSeconds([&]() {
+                for (int pass = 0; pass < PASSES; pass++) {
+                    sink = sink + vad.process(signal.data(), PASS_FRAMES * FRAME);
+                }
+            }));
+        }
+        return best * 1e9 / (PASS_FRAMES * PASSES);
+    };
+
+    EnergyVad energy(ENERGY_VAD_ONSET_FRAMES, HANGOVER, 0.6f, FRAME, 10, 0.0f);
+    FrameVad<VirtualPolicy> energy_virtual(ENERGY_VAD_ONSET_FRAMES, HANGOVER,
+                                           makeVirtualEnergyPolicy(sink == size_t(-1)));
+    SpectralVad spectral(SPECTRAL_VAD_ONSET_FRAMES, HANGOVER, 0.6f, int(TARGET_RATE), 10, HANGOVER, 0.0f);
+
+    std::cout << "\n" << std::left << std::setw(36) << "backend (window 10)"
+              << std::right << std::setw(14) << "ns / frame" << "\n";
+    std::cout << std::string(50, '-') << "\n";
+    auto backendRow = [&](const char* name, double ns) {
+        std::cout << std::left << std::setw(36) << name
+                  << std::right << std::fixed << std::setprecision(1) << std::setw(14) << ns << "\n";
+    };
+    backendRow("energy", perFrame(energy));
+    backendRow("energy, virtual call per frame", perFrame(energy_virtual));
+    backendRow("spectral", perFrame(spectral));
+    std::cout << "whisper (Silero) needs libwhisper and its model; not built into audio_bench" << std::endl;
+    return 0;
+}
+
+enum class SoundClass : uint8_t { Speech, Silence, Keyboard, Fan, Music, Other };
+constexpr size_t SOUND_CLASSES = 6;
+
+const char* soundClassName(SoundClass sound) {
+    switch (sound) {
+        case SoundClass::Speech: return "speech";
+        case SoundClass::Silence: return "silence";
+        case SoundClass::Keyboard: return "keyboard";
+        case SoundClass::Fan: return "fan";
+        case SoundClass::Music: return "music";
+        case SoundClass::Other: return "other";
+    }
+    return "?";
+}
+
+// 16 kHz audio with a ground-truth class per 20 ms frame
+struct LabelledAudio {
+    std::vector<float> samples;
+    std::vector<SoundClass> frames;
+};
+
+constexpr size_t EVAL_FRAME = TARGET_RATE / 50;  // 20 ms, the detectors' frame
+
+size_t msToSamples(double ms) { return size_t(ms * TARGET_RATE / 1000.0); }
+
+// Syllables of 120-300 ms with a gliding pitch, harmonics shaped by two
+// formants that move per syllable, short gaps and the odd longer pause
+void addSpeech(std::vector<float>& signal, size_t begin, size_t end, std::mt19937& rng) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    double phase = 0.0;
+    size_t i = begin;
+    while (i < end) {
+        size_t length = msToSamples(120 + 180 * unit(rng));
+        double f0_start = 100 + 100 * unit(rng);
+        double f0_end = f0_start * (0.85 + 0.3 * unit(rng));
+        double f1 = 300 + 500 * unit(rng);
+        double f2 = 900 + 1300 * unit(rng);
+        double amplitude = 0.03 + 0.06 * unit(rng);
+        for (size_t n = 0; n < length && i < end; n++, i++) {
+            double progress = double(n) / length;
+            double f0 = f0_start + (f0_end - f0_start) * progress;
+            phase += 2.0 * M_PI * f0 / TARGET_RATE;
+            double voiced = 0.0;
+            for (int h = 1; h * f0 < 3800.0; h++) {
+                double f = h * f0;
+                double gain = std::exp(-std::pow((f - f1) / 250.0, 2)) + 0.6 * std::exp(-std::pow((f - f2) / 350.0, 2)) + 0.05;
+                voiced += gain * std::sin(h * phase);
+            }
+            signal[i] += static_cast<float>(amplitude * std::sin(M_PI * progress) * voiced);
+        }
+        i += msToSamples(unit(rng) < 0.15 ? 250 + 150 * unit(rng) : 30 + 120 * unit(rng));
+    }
+}
+
+// Key press and release clicks: a few ms of decaying broadband noise
+void addKeyboard(std::vector<float>& signal, size_t begin, size_t end, std::mt19937& rng) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::normal_distribution<float> white(0.0f, 1.0f);
+    size_t i = begin + msToSamples(20 + 180 * unit(rng));
+    while (i < end) {
+        for (double gain : {0.25 + 0.2 * unit(rng), 0.1 * unit(rng)}) {
+            size_t length = msToSamples(4);
+            for (size_t n = 0; n < length && i + n < end; n++) {
+                signal[i + n] += static_cast<float>(gain * std::exp(-double(n) / msToSamples(1))) * white(rng);
+            }
+            i += msToSamples(30 + 30 * unit(rng));
+        }
+        i += msToSamples(50 + 170 * unit(rng));
+    }
+}
+
+// Low-passed noise with a motor hum: loud, steady and broadband
+void addFan(std::vector<float>& signal, size_t begin, size_t end, std::mt19937& rng) {
+    std::normal_distribution<float> white(0.0f, 1.0f);
+    float level = 0.0f;
+    for (size_t i = begin; i < end; i++) {
+        level += 0.15f * (white(rng) - level);
+        double t = double(i) / TARGET_RATE;
+        signal[i] += 0.12f * level + static_cast<float>(0.01 * std::sin(2.0 * M_PI * 120.0 * t));
+    }
+}
+
+// Legato chords: three notes with harmonics, each chord cross-fading into the
+// next so the level stays steady
+void addMusic(std::vector<float>& signal, size_t begin, size_t end, std::mt19937& rng) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_int_distribution<int> root(48, 64);
+    const size_t fade = msToSamples(50);
+    for (size_t chord_start = begin; chord_start < end;) {
+        size_t length = msToSamples(400 + 600 * unit(rng));
+        int base = root(rng);
+        double notes[3] = {0, 0, 0};
+        int intervals[3] = {0, unit(rng) < 0.5 ? 3 : 4, 7};
+        for (int n = 0; n < 3; n++) {
+            notes[n] = 440.0 * std::pow(2.0, (base + intervals[n] - 69) / 12.0);
+        }
+        size_t chord_end = std::min(end, chord_start + length + fade);
+        for (size_t i = chord_start; i < chord_end; i++) {
+            size_t n = i - chord_start;
+            double envelope = std::min({1.0, double(n) / fade, double(chord_end - i) / fade});
+            double t = double(i) / TARGET_RATE;
+            double tone = 0.0;
+            for (double note : notes) {
+                for (int h = 1; h <= 6; h++) {
+                    tone += std::sin(2.0 * M_PI * note * h * t) / h;
+                }
+            }
+            signal[i] += static_cast<float>(0.04 * envelope * tone);
+        }
+        chord_start += length;
+    }
+}
+
+// Segments of 3-8 s of one sound each over a faint room-noise bed. Speech
+// takes about 40% of the time; the rest is split across the distractors.
+LabelledAudio synthesizeLabelledMix(double seconds) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::normal_distribution<float> room(0.0f, 0.002f);
+
+    LabelledAudio audio;
+    size_t total = size_t(seconds * TARGET_RATE) / EVAL_FRAME * EVAL_FRAME;
+    audio.samples.resize(total);
+    for (float& sample : audio.samples) {
+        sample = room(rng);
+    }
+    audio.frames.assign(total / EVAL_FRAME, SoundClass::Silence);
+
+    // Two seconds of room noise first, as when a session starts
+    for (size_t begin = 2 * TARGET_RATE; begin < total;) {
+        size_t end = std::min(total, begin + msToSamples(3000 + 5000 * unit(rng)));
+        double pick = unit(rng);
+        SoundClass sound = pick < 0.4 ? SoundClass::Speech
+                         : pick < 0.55 ? SoundClass::Silence
+                         : pick < 0.7 ? SoundClass::Keyboard
+                         : pick < 0.85 ? SoundClass::Fan
+                         : SoundClass::Music;
+        switch (sound) {
+            case SoundClass::Speech: addSpeech(audio.samples, begin, end, rng); break;
+            case SoundClass::Keyboard: addKeyboard(audio.samples, begin, end, rng); break;
+            case SoundClass::Fan: addFan(audio.samples, begin, end, rng); break;
+            case SoundClass::Music: addMusic(audio.samples, begin, end, rng); break;
+            default: break;
+        }
+        for (size_t f = begin / EVAL_FRAME; f < end / EVAL_FRAME; f++) {
+            audio.frames[f] = sound;
+        }
+        begin = end;
+    }
+    return audio;
+}
+
+// A WAV file plus an Audacity label track (start<TAB>end[<TAB>name] in
+// seconds, one line per speech region). Everything unlabelled is "other".
+bool loadLabelledAudio(const std::string& wav_path, const std::string& labels_path, LabelledAudio& audio) {
+    WavFile wav;
+    if (!wav.open(wav_path)) {
+        return false;
+    }
+    std::vector<float> mono(wav.frames());
+    wav.readMono(0, mono.data(), mono.size());
+    if (wav.sampleRate() != TARGET_RATE) {
+        PolyphaseResampler resampler(wav.sampleRate(), TARGET_RATE);
+        resampler.process(mono.data(), mono.size(), audio.samples);
+        resampler.flush(audio.samples);
+    } else {
+        audio.samples = std::move(mono);
+    }
+    audio.samples.resize(audio.samples.size() / EVAL_FRAME * EVAL_FRAME);
+    audio.frames.assign(audio.samples.size() / EVAL_FRAME, SoundClass::Other);
+
+    std::ifstream labels(labels_path);
+    if (!labels) {
+        std::cerr << "❌ Cannot open label file: " << labels_path << std::endl;
+        return false;
+    }
+    double start = 0.0;
+    double end = 0.0;
+    std::string rest;
+    while (labels >> start >> end) {
+        std::getline(labels, rest);
+        size_t first = size_t(std::max(start, 0.0) * 50.0);
+        size_t last = std::min(audio.frames.size(), size_t(std::max(end, 0.0) * 50.0));
+        for (size_t f = first; f < last; f++) {
+            audio.frames[f] = SoundClass::Speech;
+        }
+    }
+    return true;
+}
+
+struct VadScore {
+    uint64_t frames[SOUND_CLASSES] = {};
+    uint64_t voiced[SOUND_CLASSES] = {};
+    uint64_t chunks = 0;
+    uint64_t decoder_calls = 0;
+    uint64_t speech_chunks = 0;
+    uint64_t speech_chunks_missed = 0;
+    double seconds = 0.0;
+};
+
+// Frame-level decisions against the labels, plus the fixed-mode gate: a 3 s
+// chunk reaches the decoder if any of its frames is voiced. A chunk with at
+// least 0.5 s of labelled speech that gets gated is a missed one.
+template <typename Detector>
+VadScore scoreDetector(Detector& detector, const LabelledAudio& audio) {
+    constexpr size_t CHUNK_FRAMES = 150;
+    constexpr size_t SPEECH_CHUNK_FRAMES = 25;
+
+    VadScore score;
+    std::vector<uint8_t> decisions(audio.frames.size());
+    score.seconds = timeSeconds([&]() {
+        for (size_t f = 0; f < audio.frames.size(); f++) {
+            decisions[f] = detector.process(audio.samples.data() + f * EVAL_FRAME, EVAL_FRAME) > 0;
+        }
+    });
+
+    for (size_t chunk = 0; chunk < audio.frames.size(); chunk += CHUNK_FRAMES) {
+        size_t end = std::min(audio.frames.size(), chunk + CHUNK_FRAMES);
+        bool any_voiced = false;
+        size_t speech_frames = 0;
+        for (size_t f = chunk; f < end; f++) {
+            size_t sound = size_t(audio.frames[f]);
+            score.frames[sound]++;
+            score.voiced[sound] += decisions[f];
+            any_voiced = any_voiced || decisions[f];
+            speech_frames += audio.frames[f] == SoundClass::Speech;
+        }
+        score.chunks++;
+        score.decoder_calls += any_voiced;
+        if (speech_frames >= SPEECH_CHUNK_FRAMES) {
+            score.speech_chunks++;
+            score.speech_chunks_missed += !any_voiced;
+        }
+    }
+    return score;
+}
+
+int benchVadEval(int argc, char** argv) {
+    constexpr size_t HANGOVER = 15;  // 300 ms, the transcriber default
+    constexpr size_t WINDOW = 10;    // 200 ms
+
+    LabelledAudio audio;
+    std::string description;
+    if (argc >= 2) {
+        if (!loadLabelledAudio(argv[0], argv[1], audio)) {
+            return 1;
+        }
+        description = argv[0];
+    } else {
+        audio = synthesizeLabelledMix(300.0);
+        description = "300s synthetic mix";
+    }
+
+    std::vector<SoundClass> present;
+    for (size_t c = 0; c < SOUND_CLASSES; c++) {
+        if (c != size_t(SoundClass::Speech) &&
+            std::find(audio.frames.begin(), audio.frames.end(), SoundClass(c)) != audio.frames.end()) {
+            present.push_back(SoundClass(c));
+        }
+    }
+
+    EnergyVad energy(ENERGY_VAD_ONSET_FRAMES, HANGOVER, 0.6f, EVAL_FRAME, WINDOW, 0.0f);
+    SpectralVad spectral(SPECTRAL_VAD_ONSET_FRAMES, HANGOVER, 0.6f, TARGET_RATE, WINDOW, HANGOVER, 0.0f);
+    VadScore scores[2] = {scoreDetector(energy, audio), scoreDetector(spectral, audio)};
+    const char* names[2] = {"energy", "spectral"};
+
+    std::cout << "🔬 VAD evaluation (" << description << ", " << audio.frames.size() << " frames)\n\n";
+    std::cout << std::left << std::setw(12) << "detector"
+              << std::right << std::setw(10) << "recall";
+    for (SoundClass sound : present) {
+        std::cout << std::setw(10) << soundClassName(sound);
+    }
+    std::cout << std::setw(14) << "decoder calls" << std::setw(10) << "avoided"
+              << std::setw(10) << "missed" << std::setw(12) << "ns / frame" << "\n";
+    std::cout << std::string(68 + 10 * present.size(), '-') << "\n";
+
+    for (size_t d = 0; d < 2; d++) {
+        const VadScore& score = scores[d];
+        auto percent = [](uint64_t part, uint64_t whole) {
+            return whole == 0 ? 0.0 : 100.0 * double(part) / double(whole);
+        };
+        size_t speech = size_t(SoundClass::Speech);
+        std::cout << std::left << std::setw(12) << names[d]
+                  << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(9) << percent(score.voiced[speech], score.frames[speech]) << "%";
+        for (SoundClass sound : present) {
+            std::cout << std::setw(9) << percent(score.voiced[size_t(sound)], score.frames[size_t(sound)]) << "%";
+        }
+        std::string calls = std::to_string(score.decoder_calls) + "/" + std::to_string(score.chunks);
+        std::string missed = std::to_string(score.speech_chunks_missed) + "/" + std::to_string(score.speech_chunks);
+        std::cout << std::setw(14) << calls
+                  << std::setw(9) << percent(score.chunks - score.decoder_calls, score.chunks) << "%"
+                  << std::setw(10) << missed
+                  << std::setw(12) << score.seconds * 1e9 / audio.frames.size() << "\n";
+    }
+    std::cout << "\nrecall: speech frames voiced; per-sound columns: frames wrongly voiced;\n"
+              << "decoder calls/avoided: 3s chunks passing the gate; missed: speech chunks gated" << std::endl;
+    return 0;
+}
+
+// A decoder that costs overhead + per_second * chunk seconds per call, as
+// whisper does once every call is padded to its 30 s window
+struct DecoderLoad {
+    const char* name;
+    double seconds;
+    double overhead;
+    double per_second;
+};
+
+struct PhaseResult {
+    size_t chunks = 0;
+    double chunk_seconds = 0.0;
+    std::vector<double> latencies;
+    size_t max_queue = 0;
+};
+
+// Event simulation of the streaming pipeline: the chunker cuts a chunk every
+// optimal-length seconds (speech with frequent pauses) and one decoder drains
+// the queue in order. Latency is from a chunk's first sample to its text.
+std::vector<PhaseResult> simulateChunking(const std::vector<DecoderLoad>& phases, double fixed_chunk_s,
+                                          AdaptiveChunkController* controller) {
+    struct Pending {
+        double start;
+        double cut;
+        double length;
+    };
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> jitter(0.9, 1.1);
+
+    double total = 0.0;
+    std::vector<double> phase_end;
+    for (const DecoderLoad& phase : phases) {
+        total += phase.seconds;
+        phase_end.push_back(total);
+    }
+    auto phaseAt = [&](double t) {
+        return size_t(std::upper_bound(phase_end.begin(), phase_end.end(), t) - phase_end.begin());
+    };
+    auto chunkLength = [&]() {
+        if (!controller) {
+            return fixed_chunk_s;
+        }
+        int min_ms, optimal_ms, max_ms;
+        controller->durations(min_ms, optimal_ms, max_ms);
+        return optimal_ms / 1000.0;
+    };
+
+    std::vector<PhaseResult> results(phases.size());
+    std::deque<Pending> queue;
+    double chunk_start = 0.0;
+    double chunk_length = chunkLength();
+    bool busy = false;
+    Pending decoding = {0, 0, 0};
+    double decode_begin = 0.0;
+    double decode_end = 0.0;
+
+    while (true) {
+        double next_cut = chunk_start + chunk_length;
+        if (next_cut > total && !busy && queue.empty()) {
+            break;
+        }
+        if (next_cut <= total && (!busy || next_cut <= decode_end)) {
+            queue.push_back({chunk_start, next_cut, chunk_length});
+            size_t phase = std::min(phaseAt(next_cut), phases.size() - 1);
+            results[phase].max_queue = std::max(results[phase].max_queue, queue.size());
+            chunk_start = next_cut;
+            chunk_length = chunkLength();
+        } else if (busy) {
+            size_t phase = std::min(phaseAt(decoding.start), phases.size() - 1);
+            results[phase].chunks++;
+            results[phase].chunk_seconds += decoding.length;
+            results[phase].latencies.push_back(decode_end - decoding.start);
+            if (controller) {
+                controller->recordDecode(size_t(decoding.length * TARGET_RATE), decode_begin - decoding.cut,
+                                         decode_end - decode_begin, queue.size());
+            }
+            busy = false;
+        } else {
+            chunk_start = next_cut;  // Past the end: let the queue drain
+            chunk_length = total;
+            continue;
+        }
+
+        if (!busy && !queue.empty()) {
+            decoding = queue.front();
+            queue.pop_front();
+            const DecoderLoad& load = phases[std::min(phaseAt(decoding.cut), phases.size() - 1)];
+            decode_begin = std::max(decoding.cut, decode_end);
+            decode_end = decode_begin + (load.overhead + load.per_second * decoding.length) * jitter(rng);
+            busy = true;
+        }
+    }
+    return results;
+}
+
+// Chunks the signal with SmartChunker and edge-trims every chunk. No sample
+// over the threshold may fall outside the trimmed span, and the span must
+// stay the size of its sample range.
+EdgeTrimStats trimChunks(const TranscriptionConfig& config, const std::vector<float>& signal,
+                         size_t call_samples, double& seconds, bool& keeps_speech) {
+    AudioBlockPool pool;
+    SmartChunker chunker(config, pool);
+    EdgeTrimmer trimmer(config);
+    AudioChunk chunk;
+    for (size_t offset = 0; offset < signal.size(); offset += call_samples) {
+        size_t count = std::min(call_samples, signal.size() - offset);
+        if (!chunker.processAudio(signal.data() + offset, count, chunk)) {
+            continue;
+        }
+        uint64_t start = chunk.start_sample;
+        uint64_t end = chunk.end_sample;
+        seconds += timeSeconds([&]() { trimmer.trim(chunk); });
+        for (uint64_t i = start; i < end && keeps_speech; i++) {
+            bool outside = i < chunk.start_sample || i >= chunk.end_sample;
+            keeps_speech = !(outside && std::abs(signal[i]) > config.silence_threshold);
+        }
+        keeps_speech = keeps_speech && chunk.audio.size() == chunk.end_sample - chunk.start_sample;
+    }
+    return trimmer.stats();
+}
+
+int benchTrim() {
+    constexpr double SECONDS = 300.0;
+    constexpr size_t CALL_SAMPLES = 1024;
+    TranscriptionConfig config;
+
+    std::cout << "🔬 Edge trimming of smart chunks (" << SECONDS << "s per signal, guard "
+              << config.edge_guard_ms << "ms)\n\n";
+    std::cout << std::left << std::setw(22) << "signal"
+              << std::right << std::setw(10) << "chunks"
+              << std::setw(10) << "trimmed"
+              << std::setw(16) << "s / hour cut"
+              << std::setw(14) << "us / chunk" << "\n";
+    std::cout << std::string(72, '-') << "\n";
+
+    std::vector<std::pair<std::string, std::vector<float>>> signals;
+    signals.push_back({"speech", synthesizeSpeech(size_t(TARGET_RATE * SECONDS), false)});
+    signals.push_back({"speech + pauses", synthesizeSpeech(size_t(TARGET_RATE * SECONDS), true)});
+    // Long silences and noise between utterances, as in the VAD evaluation
+    signals.push_back({"labelled mix", synthesizeLabelledMix(SECONDS).samples});
+
+    bool keeps_speech = true;
+    for (const auto& entry : signals) {
+        double seconds = 0.0;
+        EdgeTrimStats stats = trimChunks(config, entry.second, CALL_SAMPLES, seconds, keeps_speech);
+        std::cout << std::left << std::setw(22) << entry.first
+                  << std::right << std::setw(10) << stats.chunks
+                  << std::setw(10) << stats.trimmed_chunks
+                  << std::fixed << std::setprecision(0) << std::setw(16) << stats.secondsPerHour()
+                  << std::setprecision(2) << std::setw(14) << seconds * 1e6 / std::max<uint64_t>(stats.chunks, 1)
+                  << "\n";
+    }
+
+    std::cout << "\nSamples over the silence threshold " << (keeps_speech ? "all kept" : "CUT") << std::endl;
+    return keeps_speech ? 0 : 1;
+}
+
+// Coalescing on a full queue, where the chunks merged into the held one do not
+// always meet: the chunker may gate a silent chunk out between them, or edge
+// trimming may cut the held chunk's tail. The merged audio must still cover
+// start..end with every sample at its timeline position, silence in the hole.
+int benchCoalesce() {
+    constexpr size_t TOTAL_SAMPLES = 64000;
+    struct Range {
+        uint64_t start;
+        uint64_t end;
+    };
+    struct Case {
+        const char* name;
+        std::vector<Range> merged;  // Pushed while the queue is full
+    };
+    const std::vector<Case> cases = {
+        {"overlapping", {{14000, 32000}, {30000, 48000}}},
+        {"gated chunk between", {{14000, 32000}, {46000, 64000}}},  // [32000, 46000) never pushed
+        {"trimmed tail", {{14000, 30000}, {32000, 48000}}},
+        {"two holes", {{14000, 20000}, {30000, 40000}, {50000, 64000}}},
+    };
+
+    // Each sample holds its timeline position, so misplaced audio shows up
+    std::vector<float> signal(TOTAL_SAMPLES);
+    for (size_t i = 0; i < signal.size(); i++) {
+        signal[i] = float(i + 1);
+    }
+    AudioBlockPool pool;
+    SampleBuffer buffer(pool);
+    buffer.append(signal.data(), signal.size());
+
+    std::cout << "🔬 Coalesced chunks on a full queue (capacity 2)\n\n";
+    std::cout << std::left << std::setw(22) << "case"
+              << std::right << std::setw(16) << "range"
+              << std::setw(10) << "samples"
+              << std::setw(10) << "silent"
+              << std::setw(12) << "placed" << "\n";
+    std::cout << std::string(70, '-') << "\n";
+
+    bool ok = true;
+    std::vector<float> audio;
+    for (const Case& entry : cases) {
+        ChunkQueue queue(2, QueueOverflowPolicy::Coalesce, TOTAL_SAMPLES);
+        auto push = [&](uint64_t start, uint64_t end) {
+            AudioChunkPtr chunk = queue.acquire();
+            buffer.view(start, end - start, chunk->audio);
+            chunk->start_sample = start;
+            chunk->end_sample = end;
+            chunk->next_start_sample = end;
+            queue.push(std::move(chunk));
+        };
+        push(0, 8000);  // Fill the queue
+        push(6000, 16000);
+        for (const Range& range : entry.merged) {
+            push(range.start, range.end);
+        }
+        queue.recycle(queue.pop());
+        queue.recycle(queue.pop());
+        queue.flush();
+        AudioChunkPtr merged = queue.pop();
+
+        bool placed = merged && merged->audio.size() == merged->end_sample - merged->start_sample &&
+                      merged->start_sample == entry.merged.front().start &&
+                      merged->end_sample == entry.merged.back().end;
+        size_t silent = 0;
+        if (placed) {
+            audio.resize(merged->audio.size());
+            merged->audio.copyTo(audio.data());
+            for (size_t i = 0; i < audio.size(); i++) {
+                uint64_t position = merged->start_sample + i;
+                bool covered = false;
+                for (const Range& range : entry.merged) {
+                    covered = covered || (position >= range.start && position < range.end);
+                }
+                silent += audio[i] == 0.0f ? 1 : 0;
+                placed = placed && audio[i] == (covered ? signal[position] : 0.0f);
+            }
+        }
+        ok = ok && placed;
+
+        std::ostringstream range;
+        if (merged) {
+            range << merged->start_sample << "-" << merged->end_sample;
+        }
+        std::cout << std::left << std::setw(22) << entry.name
+                  << std::right << std::setw(16) << range.str()
+                  << std::setw(10) << (merged ? merged->audio.size() : 0)
+                  << std::setw(10) << silent
+                  << std::setw(12) << (placed ? "yes" : "NO") << "\n";
+    }
+
+    std::cout << "\nMerged audio " << (ok ? "matches its timeline" : "MISPLACED") << std::endl;
+    return ok ? 0 : 1;
+}
+
+int benchAdaptive() {
+    const std::vector<DecoderLoad> phases = {
+        {"idle", 600.0, 0.5, 0.10},
+        {"loaded", 600.0, 1.5, 0.40},
+        {"overloaded", 600.0, 2.0, 0.60},
+        {"idle again", 600.0, 0.5, 0.10},
+    };
+    TranscriptionConfig config;
+    config.adaptive_chunking = true;
+    config.target_latency_ms = 8000;
+
+    std::cout << "🔬 Adaptive chunk sizing (simulated decoder, target latency "
+              << config.target_latency_ms / 1000.0 << "s)\n\n";
+    std::cout << std::left << std::setw(20) << "chunking" << std::setw(14) << "phase"
+              << std::right << std::setw(12) << "decode cost" << std::setw(12) << "mean chunk"
+              << std::setw(14) << "mean latency" << std::setw(13) << "p95 latency"
+              << std::setw(11) << "max queue" << "\n";
+    std::cout << std::string(96, '-') << "\n";
+
+    auto report = [&](const char* name, const std::vector<PhaseResult>& results) {
+        for (size_t p = 0; p < phases.size(); p++) {
+            const PhaseResult& result = results[p];
+            std::vector<double> sorted = result.latencies;
+            std::sort(sorted.begin(), sorted.end());
+            double mean = 0.0;
+            for (double latency : sorted) {
+                mean += latency;
+            }
+            mean = sorted.empty() ? 0.0 : mean / sorted.size();
+            double p95 = sorted.empty() ? 0.0 : sorted[std::min(sorted.size() - 1, sorted.size() * 95 / 100)];
+            std::string cost = std::to_string(phases[p].overhead).substr(0, 3) + "+" +
+                               std::to_string(phases[p].per_second).substr(0, 4) + "x";
+            std::cout << std::left << std::setw(20) << (p == 0 ? name : "") << std::setw(14) << phases[p].name
+                      << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(12) << cost
+                      << std::setw(11) << (result.chunks ? result.chunk_seconds / result.chunks : 0.0) << "s"
+                      << std::setw(13) << mean << "s"
+                      << std::setw(12) << p95 << "s"
+                      << std::setw(11) << result.max_queue << "\n";
+        }
+    };
+
+    report("fixed 10s", simulateChunking(phases, 10.0, nullptr));
+    report("fixed 4s", simulateChunking(phases, 4.0, nullptr));
+    AdaptiveChunkController controller(config);
+    report("adaptive", simulateChunking(phases, 0.0, &controller));
+
+    ChunkSizingStats stats = controller.stats();
+    std::cout << "\nController: " << stats.adjustments << " adjustments over " << stats.decodes
+              << " decodes, last reason " << chunkSizingReasonName(stats.reason)
+              << ", fitted " << std::setprecision(2) << stats.call_overhead_s << "s + "
+              << stats.cost_per_audio_s << "x per call" << std::endl;
+    return 0;
+}
+
+struct SpokenWord {
+    std::string text;
+    double start;
+    double end;
+    bool opens_utterance;
+};
+
+// Two minutes of sentences, some separated by pauses long enough to close an utterance
+std::vector<SpokenWord> makeSpeech(double seconds, std::mt19937& rng) {
+    static const char* vocabulary[] = {"the", "meeting", "moves", "budget", "review", "to", "next",
+                                       "quarter", "because", "hiring", "slipped", "and", "we", "need",
+                                       "numbers", "from", "finance", "before", "friday", "launch"};
+    std::uniform_int_distribution<int> pick(0, 19);
+    std::uniform_int_distribution<int> sentence_words(6, 14);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    std::vector<SpokenWord> words;
+    double t = 1.0;
+    bool opens = true;
+    while (t < seconds) {
+        int count = sentence_words(rng);
+        for (int i = 0; i < count; i++) {
+            double length = 0.2 + 0.3 * unit(rng);
+            words.push_back({vocabulary[pick(rng)], t, t + length, opens});
+            opens = false;
+            t += length + 0.05 + 0.1 * unit(rng);
+        }
+        words.back().text += ".";
+        opens = unit(rng) < 0.4;
+        t += opens ? 1.2 : 0.2;
+    }
+    return words;
+}
+
+// A decoder whose last second is unreliable, as whisper's is when words are
+// cut off by the window end: recent words come out wrong a quarter of the
+// time and a word still being spoken comes out truncated or not at all
+std::vector<TimedWord> simulateDecode(const std::vector<SpokenWord>& speech, double window_start,
+                                      double window_end, std::mt19937& rng) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_real_distribution<double> jitter(-0.03, 0.03);
+    auto sample = [](double t) { return uint64_t(std::max(t, 0.0) * TARGET_RATE); };
+
+    std::vector<TimedWord> hypothesis;
+    for (const SpokenWord& word : speech) {
+        if (word.start < window_start - 0.05 || word.start >= window_end) {
+            continue;
+        }
+        std::string text = word.text;
+        double end = word.end;
+        if (word.end > window_end) {
+            if (unit(rng) < 0.4) {
+                continue;
+            }
+            text = text.substr(0, std::max<size_t>(1, text.size() * (window_end - word.start) / (word.end - word.start)));
+            end = window_end;
+        } else if (unit(rng) < (window_end - word.end < 1.0 ? 0.25 : 0.03)) {
+            static const char* wrong[] = {"uh", "then", "a"};
+            text = wrong[int(unit(rng) * 3) % 3];
+        }
+        hypothesis.push_back({text, sample(word.start + jitter(rng)), sample(end + jitter(rng))});
+    }
+    return hypothesis;
+}
+
+struct PartialsResult {
+    std::vector<double> first_word;  // Utterance onset to its first word on screen
+    std::vector<double> shown;       // Word end to the word on screen
+    std::vector<double> committed;   // Word end to the word committed
+    size_t wrong = 0;
+    size_t missing = 0;
+    double decoded_seconds = 0.0;
+    size_t decodes = 0;
+};
+
+// Replays the streaming loop of StreamingTranscriber::feedStream and
+// processStreamWindow in 50 ms steps against the simulated decoder
+PartialsResult simulatePartials(const std::vector<SpokenWord>& speech, double seconds, double interval_s,
+                                double trim_s, bool trim_at_sentences) {
+    const double STEP = 0.05;
+    const double MAX_WINDOW = 30.0;
+    std::mt19937 rng(5);
+    LocalAgreement agreement;
+    PartialsResult result;
+
+    std::vector<double> shown_at(speech.size(), -1.0);
+    std::vector<double> committed_at(speech.size(), -1.0);
+    std::vector<std::string> committed_text(speech.size());
+    auto wordAt = [&](uint64_t start_sample) {
+        double t = double(start_sample) / TARGET_RATE;
+        size_t best = 0;
+        for (size_t i = 0; i < speech.size(); i++) {
+            if (std::abs(speech[i].start - t) < std::abs(speech[best].start - t)) {
+                best = i;
+            }
+        }
+        return best;
+    };
+    auto speaking = [&](double from, double to) {
+        for (const SpokenWord& word : speech) {
+            if (word.start < to && word.end > from) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    struct Window {
+        double start;
+        double end;
+        bool is_final;
+    };
+    std::deque<Window> queue;
+    Window decoding = {0.0, 0.0, false};
+    bool busy = false;
+    double busy_until = 0.0;
+    double window_start = 0.0;
+    double new_audio = 0.0;
+    double commit_point = 0.0;
+    bool has_speech = false;
+
+    for (double t = STEP; t < seconds + 5.0; t += STEP) {
+        // Decoder finishes: agree, publish, maybe let the chunker trim
+        if (busy && t >= busy_until) {
+            std::vector<TimedWord> committed;
+            agreement.insert(simulateDecode(speech, decoding.start, decoding.end, rng), committed);
+            if (decoding.is_final) {
+                agreement.flush(committed);
+            }
+            for (const TimedWord& word : committed) {
+                size_t i = wordAt(word.start_sample);
+                if (committed_at[i] < 0) {
+                    committed_at[i] = t;
+                    committed_text[i] = word.text;
+                }
+                shown_at[i] = shown_at[i] < 0 ? t : shown_at[i];
+            }
+            for (const TimedWord& word : agreement.tentative()) {
+                size_t i = wordAt(word.start_sample);
+                shown_at[i] = shown_at[i] < 0 ? t : shown_at[i];
+            }
+            if (!decoding.is_final && !committed.empty()) {
+                char last = committed.back().text.back();
+                bool sentence_end = trim_at_sentences && (last == '.' || last == '?' || last == '!');
+                if (sentence_end || decoding.end - decoding.start >= trim_s) {
+                    commit_point = double(agreement.committedEnd()) / TARGET_RATE;
+                }
+            }
+            busy = false;
+        }
+        if (!busy && !queue.empty()) {
+            decoding = queue.front();
+            queue.pop_front();
+            busy = true;
+            double length = decoding.end - decoding.start;
+            busy_until = t + 0.25 + 0.03 * length;
+            result.decoded_seconds += length;
+            result.decodes++;
+        }
+
+        // Chunker: the same window, trim and pause rules as feedStream
+        if (t > seconds) {
+            continue;
+        }
+        new_audio += STEP;
+        window_start = std::max(window_start, commit_point);
+        bool full = t - window_start >= MAX_WINDOW;
+        if (!full && (new_audio < interval_s - 1e-9 || !queue.empty())) {
+            continue;
+        }
+        bool speech_now = speaking(t - new_audio - 0.3, t);  // VAD with its hangover
+        new_audio = 0.0;
+        Window window = {window_start, t, full || !speech_now};
+        if (speech_now && !full) {
+            has_speech = true;
+        } else {
+            window_start = has_speech ? t : std::max(window_start, t - 0.3);
+            if (!has_speech) {
+                continue;
+            }
+            has_speech = false;
+        }
+        queue.push_back(window);
+    }
+
+    double onset_shown = -1.0;
+    for (size_t i = 0; i < speech.size(); i++) {
+        if (speech[i].opens_utterance) {
+            onset_shown = shown_at[i];
+            if (onset_shown >= 0) {
+                result.first_word.push_back(onset_shown - speech[i].start);
+            }
+        }
+        if (shown_at[i] >= 0) {
+            result.shown.push_back(std::max(0.0, shown_at[i] - speech[i].end));
+        }
+        if (committed_at[i] < 0) {
+            result.missing++;
+        } else {
+            result.committed.push_back(std::max(0.0, committed_at[i] - speech[i].end));
+            result.wrong += committed_text[i] != speech[i].text;
+        }
+    }
+    return result;
+}
+
+int benchPartials() {
+    const double seconds = 120.0;
+    std::mt19937 rng(3);
+    std::vector<SpokenWord> speech = makeSpeech(seconds, rng);
+
+    std::cout << "🔬 Streaming partials, LocalAgreement-2 (" << speech.size() << " words over " << seconds
+              << "s, simulated decoder 0.25s + 0.03x per call)\n\n";
+    std::cout << std::left << std::setw(24) << "policy" << std::right << std::setw(12) << "first word"
+              << std::setw(14) << "shown p50/95" << std::setw(16) << "commit p50/95" << std::setw(9) << "wrong"
+              << std::setw(9) << "missing" << std::setw(10) << "decodes" << std::setw(12) << "decoded/s" << "\n";
+    std::cout << std::string(106, '-') << "\n";
+
+    auto percentile = [](std::vector<double> values, double p) {
+        if (values.empty()) {
+            return 0.0;
+        }
+        std::sort(values.begin(), values.end());
+        return values[std::min(values.size() - 1, size_t(values.size() * p))];
+    };
+    auto mean = [](const std::vector<double>& values) {
+        double sum = 0.0;
+        for (double v : values) {
+            sum += v;
+        }
+        return values.empty() ? 0.0 : sum / values.size();
+    };
+    auto report = [&](const std::string& name, const PartialsResult& r) {
+        std::ostringstream shown, committed;
+        shown << std::fixed << std::setprecision(2) << percentile(r.shown, 0.5) << "/" << percentile(r.shown, 0.95);
+        committed << std::fixed << std::setprecision(2) << percentile(r.committed, 0.5) << "/"
+                  << percentile(r.committed, 0.95);
+        std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(11) << mean(r.first_word) << "s" << std::setw(13) << shown.str() << "s"
+                  << std::setw(15) << committed.str() << "s"
+                  << std::setw(8) << std::setprecision(1) << 100.0 * r.wrong / speech.size() << "%"
+                  << std::setw(9) << r.missing << std::setw(10) << r.decodes
+                  << std::setw(11) << std::setprecision(2) << r.decoded_seconds / seconds << "x\n";
+    };
+
+    report("250ms, trim", simulatePartials(speech, seconds, 0.25, 10.0, true));
+    report("500ms, trim", simulatePartials(speech, seconds, 0.5, 10.0, true));
+    report("1000ms, trim", simulatePartials(speech, seconds, 1.0, 10.0, true));
+    report("500ms, full history", simulatePartials(speech, seconds, 0.5, 1e9, false));
+    std::cout << "\nfirst word: utterance onset to its first word on screen; shown/commit: word end to\n"
+              << "partial/committed display; decoded/s: audio decoded per second of input" << std::endl;
+    return 0;
+}
+
+// Reads a source the way audioReaderThread does until want_bytes arrived or
+// it ends; records the longest wait between two reads (a restart's gap)
+size_t drainSource(PcmSource& source, size_t want_bytes, double& longest_gap_ms) {
+    std::atomic<bool> running{true};
+    std::vector<char> buffer(65536);
+    size_t total = 0;
+    auto last_data = std::chrono::steady_clock::now();
+    longest_gap_ms = 0.0;
+    while (total < want_bytes) {
+        struct pollfd pfd = {source.fd(), POLLIN, 0};
+        if (poll(&pfd, 1, 100) <= 0) {
+            if (!source.producerAlive() && !source.recover(running)) {
+                break;
+            }
+            continue;
+        }
+        ssize_t bytes_read = read(source.fd(), buffer.data(), buffer.size());
+        if (bytes_read < 0 && (errno == EINTR || errno == EAGAIN)) {
+            continue;
+        }
+        if (bytes_read <= 0) {
+            if (!source.recover(running)) {
+                break;
+            }
+            continue;
+        }
+        auto now = std::chrono::steady_clock::now();
+        longest_gap_ms = std::max(longest_gap_ms, std::chrono::duration<double, std::milli>(now - last_data).count());
+        last_data = now;
+        total += bytes_read;
+    }
+    return total;
+}
+
+int benchSource() {
+    constexpr double OLD_STARTUP_MS = 2000.0;  // The fixed sleep the capture launch used to take
+    constexpr size_t SECOND_BYTES = TARGET_RATE * sizeof(float);
+
+    std::cout << "🔬 PCM source: startup handshake, restarts and pipe capacity\n\n";
+    bool ok = true;
+
+    // A producer that needs 50ms to open its device, then streams
+    PcmSourceConfig config;
+    parsePcmSource("cmd:sleep 0.05; head -c " + std::to_string(4 * SECOND_BYTES) + " /dev/zero", config);
+    config.restart = false;
+    {
+        PcmSource source(config);
+        auto start = std::chrono::steady_clock::now();
+        ok = source.open() && ok;
+        double open_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        double gap_ms = 0.0;
+        size_t bytes = drainSource(source, 4 * SECOND_BYTES, gap_ms);
+        PcmSourceStats stats = source.stats();
+        ok = ok && bytes == 4 * SECOND_BYTES;
+        std::cout << "startup        ready after " << std::fixed << std::setprecision(1) << open_ms
+                  << "ms (producer init 50ms; was a fixed " << int(OLD_STARTUP_MS) << "ms sleep)\n";
+        std::cout << "pipe buffer    " << stats.pipe_bytes / 1024 << " KiB = " << std::setprecision(2)
+                  << double(stats.pipe_bytes) / SECOND_BYTES << "s of float32 audio (default pipe: 64 KiB = "
+                  << 65536.0 / SECOND_BYTES << "s)\n";
+    }
+
+    // A producer that dies after every second of audio, via stdout and via {pipe}
+    for (const char* command : {"head -c %B /dev/zero; exit 1", "head -c %B /dev/zero > {pipe}; exit 1"}) {
+        std::string text = command;
+        text.replace(text.find("%B"), 2, std::to_string(SECOND_BYTES));
+        PcmSourceConfig crash_config;
+        parsePcmSource("cmd:" + text, crash_config);
+        crash_config.pipe_path = "/tmp/audio_bench_source_" + std::to_string(getpid());
+        PcmSource source(crash_config);
+        ok = source.open() && ok;
+        double gap_ms = 0.0;
+        size_t bytes = drainSource(source, 3 * SECOND_BYTES, gap_ms);
+        PcmSourceStats stats = source.stats();
+        ok = ok && bytes == 3 * SECOND_BYTES && stats.restarts == 2;
+        std::cout << "restart        " << std::left << std::setw(44) << text << std::right
+                  << stats.restarts << " restarts, longest gap " << std::setprecision(0) << gap_ms << "ms, "
+                  << bytes / SECOND_BYTES << "s of audio kept\n";
+    }
+
+    std::cout << "\nSource behaviour " << (ok ? "as expected" : "WRONG") << std::endl;
+    return ok ? 0 : 1;
+}
+
+// CPU time of the calling thread, so a reader is measured apart from its writer
+double threadCpuSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+using SampleSink = std::function<void(const float*, size_t)>;
+
+// The original reader: one istream call per float, handing on every 1024 samples
+size_t readPerSample(const std::string& path, const SampleSink& consume) {
+    std::ifstream pipe(path, std::ios::binary);
+    std::vector<float> read_buffer;
+    read_buffer.reserve(4096);
+    size_t total = 0;
+    float sample;
+    while (pipe.read(reinterpret_cast<char*>(&sample), sizeof(float))) {
+        read_buffer.push_back(sample);
+        if (read_buffer.size() >= 1024) {
+            consume(read_buffer.data(), read_buffer.size());
+            total += read_buffer.size();
+            read_buffer.clear();
+        }
+    }
+    consume(read_buffer.data(), read_buffer.size());
+    return total + read_buffer.size();
+}
+
+using S16Converter = void (*)(const int16_t*, float*, size_t);
+
+// audioReaderThread's loop: poll, then read(2) whole blocks, carrying a
+// partial sample over to the next read. With a converter the pipe carries
+// 16-bit samples, converted block by block.
+size_t readBlocks(const std::string& path, size_t block_bytes, const SampleSink& consume,
+                  S16Converter convert = nullptr) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    const size_t sample_bytes = convert ? sizeof(int16_t) : sizeof(float);
+    std::vector<float> read_buffer(block_bytes / sizeof(float));
+    std::vector<float> convert_buffer(convert ? block_bytes / sizeof(int16_t) : 0);
+    char* read_bytes = reinterpret_cast<char*>(read_buffer.data());
+    size_t pending_bytes = 0;
+    size_t total = 0;
+    while (true) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 100) <= 0) {
+            continue;
+        }
+        ssize_t bytes_read = read(fd, read_bytes + pending_bytes, block_bytes - pending_bytes);
+        if (bytes_read < 0 && (errno == EINTR || errno == EAGAIN)) {
+            continue;
+        }
+        if (bytes_read <= 0) {
+            break;
+        }
+        size_t total_bytes = pending_bytes + bytes_read;
+        size_t sample_count = total_bytes / sample_bytes;
+        if (convert) {
+            convert(reinterpret_cast<const int16_t*>(read_bytes), convert_buffer.data(), sample_count);
+            consume(convert_buffer.data(), sample_count);
+        } else {
+            consume(read_buffer.data(), sample_count);
+        }
+        total += sample_count;
+        pending_bytes = total_bytes - sample_count * sample_bytes;
+        if (pending_bytes > 0) {
+            std::memmove(read_bytes, read_bytes + sample_count * sample_bytes, pending_bytes);
+        }
+    }
+    close(fd);
+    return total;
+}
+
+struct IngestResult {
+    size_t samples = 0;
+    double wall_s = 0.0;
+    double cpu_s = 0.0;    // Reader thread only
+};
+
+// A writer thread streams payload through a FIFO in 4 KiB writes, the size
+// the capture tool writes, while read_all drains it on this thread
+IngestResult measureIngest(const std::vector<char>& payload, const std::function<size_t(const std::string&)>& read_all) {
+    std::string path = "/tmp/audio_bench_reader_" + std::to_string(getpid());
+    unlink(path.c_str());
+    IngestResult result;
+    if (mkfifo(path.c_str(), 0600) != 0) {
+        return result;
+    }
+    std::thread writer([&]() {
+        int fd = open(path.c_str(), O_WRONLY);
+        for (size_t offset = 0; fd >= 0 && offset < payload.size();) {
+            ssize_t written = write(fd, payload.data() + offset, std::min<size_t>(4096, payload.size() - offset));
+            if (written <= 0) {
+                break;
+            }
+            offset += written;
+        }
+        close(fd);
+    });
+    auto wall_start = std::chrono::steady_clock::now();
+    double cpu_start = threadCpuSeconds();
+    result.samples = read_all(path);
+    result.cpu_s = threadCpuSeconds() - cpu_start;
+    result.wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    writer.join();
+    unlink(path.c_str());
+    return result;
+}
+
+int benchReader() {
+    constexpr double AUDIO_SECONDS = 300.0;
+    const size_t samples = static_cast<size_t>(AUDIO_SECONDS * TARGET_RATE);
+    std::vector<float> audio = synthesizeSpeech(samples, true);
+    std::vector<char> payload(reinterpret_cast<const char*>(audio.data()),
+                              reinterpret_cast<const char*>(audio.data() + audio.size()));
+
+    // Both readers hand samples on the way the ring write does: one copy out
+    std::vector<float> received(samples);
+    size_t received_count = 0;
+    SampleSink consume = [&](const float* data, size_t count) {
+        count = std::min(count, received.size() - received_count);
+        std::copy(data, data + count, received.begin() + received_count);
+        received_count += count;
+    };
+
+    std::cout << "🔬 Pipe reader: " << AUDIO_SECONDS << "s of float32 audio through a FIFO\n\n";
+    std::cout << std::left << std::setw(22) << "reader"
+              << std::right << std::setw(14) << "Msamples/s"
+              << std::setw(12) << "x realtime"
+              << std::setw(18) << "CPU at realtime" << "\n";
+    std::cout << std::string(66, '-') << "\n";
+
+    bool ok = true;
+    auto row = [&](const std::string& name, const IngestResult& result) {
+        ok = ok && result.samples == samples && received_count == samples &&
+             std::equal(received.begin(), received.end(), audio.begin());
+        received_count = 0;
+        std::cout << std::left << std::setw(22) << name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(14) << result.samples / result.wall_s / 1e6
+                  << std::setprecision(0) << std::setw(12) << AUDIO_SECONDS / result.wall_s
+                  << std::setprecision(3) << std::setw(17) << 100.0 * result.cpu_s / AUDIO_SECONDS << "%\n";
+        return result.cpu_s;
+    };
+
+    IngestResult old_result = measureIngest(payload, [&](const std::string& path) { return readPerSample(path, consume); });
+    double old_cpu = row("istream per sample", old_result);
+    double new_cpu = old_cpu;
+    for (size_t block_bytes : {size_t(4096), size_t(16384), size_t(65536)}) {
+        IngestResult result = measureIngest(payload, [&](const std::string& path) {
+            return readBlocks(path, block_bytes, consume);
+        });
+        double cpu = row("read(2) " + std::to_string(block_bytes / 1024) + " KiB blocks", result);
+        if (block_bytes == 16384) {
+            new_cpu = cpu;
+        }
+    }
+
+    std::cout << "\nCPU at realtime: reader thread CPU time per second of audio ingested\n"
+              << "Default 16 KiB blocks: " << std::setprecision(1) << old_cpu / std::max(new_cpu, 1e-9)
+              << "x less CPU than the per-sample reader\n"
+              << "\nReaders " << (ok ? "agree" : "DISAGREE") << " on every sample" << std::endl;
+    return ok ? 0 : 1;
+}
+
+// Every converter is checked against the scalar reference on odd lengths
+// and misaligned starts and timed on a cache-resident second of audio. Then
+// the whole ingest path is timed: a pipe of float32 against a pipe of int16
+// converted on arrival, which moves half the bytes through the kernel.
+int benchConvert() {
+    constexpr size_t TIMED_SAMPLES = 16000;
+    constexpr int TIMED_PASSES = 20000;
+    constexpr double AUDIO_SECONDS = 300.0;
+
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> sample(-32768, 32767);
+    std::vector<int16_t> input(TIMED_SAMPLES + 16);
+    for (int16_t& x : input) {
+        x = static_cast<int16_t>(sample(rng));
+    }
+    input[3] = -32768;  // The extremes must map to -1 and just under 1
+    input[4] = 32767;
+
+    std::vector<PcmConverter> converters = supportedPcmConverters();
+    const PcmConverter& reference = converters.front();
+
+    std::cout << "🔬 16-bit PCM to float (selected: " << pcmConvertIsa() << ")\n\n";
+    std::cout << std::left << std::setw(10) << "isa" << std::setw(10) << "matches"
+              << std::right << std::setw(14) << "Msamples/s" << std::setw(14) << "in GB/s" << "\n";
+    std::cout << std::string(48, '-') << "\n";
+
+    bool ok = true;
+    std::vector<float> expected(input.size());
+    std::vector<float> got(input.size());
+    for (const PcmConverter& converter : converters) {
+        bool match = true;
+        for (size_t start = 0; start < 8 && match; start++) {
+            for (size_t count : {size_t(0), size_t(1), size_t(7), size_t(8), size_t(15), size_t(17), size_t(33), size_t(4096)}) {
+                reference.convert(input.data() + start, expected.data(), count);
+                std::fill(got.begin(), got.end(), 2.0f);
+                converter.convert(input.data() + start, got.data() + 1, count);
+                match = match && std::equal(expected.begin(), expected.begin() + count, got.begin() + 1) &&
+                        got[count + 1] == 2.0f;
+            }
+        }
+        ok = ok && match;
+
+        double seconds = timeSeconds([&]() {
+            for (int i = 0; i < TIMED_PASSES; i++) {
+                converter.convert(input.data(), got.data(), TIMED_SAMPLES);
+            }
+        });
+        double samples_per_s = double(TIMED_SAMPLES) * TIMED_PASSES / seconds;
+        std::cout << std::left << std::setw(10) << converter.isa << std::setw(10) << (match ? "yes" : "NO")
+                  << std::right << std::fixed << std::setprecision(0) << std::setw(14) << samples_per_s / 1e6
+                  << std::setprecision(1) << std::setw(14) << samples_per_s * sizeof(int16_t) / 1e9 << "\n";
+    }
+
+    // The same audio as float32 and as int16 through a FIFO
+    const size_t samples = static_cast<size_t>(AUDIO_SECONDS * TARGET_RATE);
+    std::vector<float> audio = synthesizeSpeech(samples, true);
+    std::vector<int16_t> audio_s16(samples);
+    for (size_t i = 0; i < samples; i++) {
+        audio_s16[i] = static_cast<int16_t>(std::clamp(std::lround(audio[i] * 32768.0f), -32768L, 32767L));
+    }
+    std::vector<float> audio_from_s16(samples);
+    reference.convert(audio_s16.data(), audio_from_s16.data(), samples);
+    auto bytes_of = [](const auto& data) {
+        const char* begin = reinterpret_cast<const char*>(data.data());
+        return std::vector<char>(begin, begin + data.size() * sizeof(data[0]));
+    };
+    std::vector<char> payload_f32 = bytes_of(audio);
+    std::vector<char> payload_s16 = bytes_of(audio_s16);
+
+    std::vector<float> received(samples);
+    size_t received_count = 0;
+    SampleSink consume = [&](const float* data, size_t count) {
+        count = std::min(count, received.size() - received_count);
+        std::copy(data, data + count, received.begin() + received_count);
+        received_count += count;
+    };
+
+    std::cout << "\nPipe ingest, " << AUDIO_SECONDS << "s of audio in 16 KiB reads:\n\n";
+    std::cout << std::left << std::setw(24) << "pipe" << std::right << std::setw(12) << "MiB piped"
+              << std::setw(14) << "Msamples/s" << std::setw(18) << "CPU at realtime" << "\n";
+    std::cout << std::string(68, '-') << "\n";
+    auto row = [&](const std::string& name, const std::vector<char>& payload, S16Converter convert,
+                   const std::vector<float>& want) {
+        IngestResult result = measureIngest(payload, [&](const std::string& path) {
+            return readBlocks(path, 16384, consume, convert);
+        });
+        ok = ok && result.samples == samples && received_count == samples &&
+             std::equal(received.begin(), received.end(), want.begin());
+        received_count = 0;
+        std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << payload.size() / 1048576.0
+                  << std::setw(14) << result.samples / result.wall_s / 1e6
+                  << std::setprecision(3) << std::setw(17) << 100.0 * result.cpu_s / AUDIO_SECONDS << "%\n";
+    };
+    row("float32", payload_f32, nullptr, audio);
+    row("int16, scalar convert", payload_s16, reference.convert, audio_from_s16);
+    row(std::string("int16, ") + pcmConvertIsa() + " convert", payload_s16, convertS16ToFloat, audio_from_s16);
+
+    std::cout << "\nCPU at realtime: reader thread CPU time per second of audio ingested\n"
+              << "\nAll converters " << (ok ? "match" : "DIFFER FROM") << " the scalar reference" << std::endl;
+    return ok ? 0 : 1;
+}
+
+// Sessions sharing one decode pool, in compressed time: one second of audio
+// passes in 1/SPEEDUP seconds and a decode sleeps its modelled cost
+struct SimulatedSessions {
+    static constexpr double SPEEDUP = 50.0;
+    static constexpr double CHUNK_S = 5.0;          // Chunk length
+    static constexpr double CALL_S = 0.2;           // Modelled decode: fixed cost per call
+    static constexpr double PER_AUDIO_S = 0.05;     // plus this per second of audio
+
+    struct Session {
+        std::mutex mutex;
+        std::deque<double> ready;                   // Audio time each queued chunk arrived
+        std::vector<double> latencies;              // Arrival to decoded, audio seconds
+        DecodePriority priority = DecodePriority::Live;
+    };
+
+    std::vector<std::unique_ptr<Session>> sessions;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    double now() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * SPEEDUP;
+    }
+
+    // Decodes one queued chunk of a session, the way decodeNext() does
+    bool decode(Session& session) {
+        double ready;
+        {
+            std::lock_guard<std::mutex> lock(session.mutex);
+            if (session.ready.empty()) {
+                return false;
+            }
+            ready = session.ready.front();
+            session.ready.pop_front();
+        }
+        double cost_s = CALL_S + PER_AUDIO_S * CHUNK_S;
+        std::this_thread::sleep_for(std::chrono::duration<double>(cost_s / SPEEDUP));
+        std::lock_guard<std::mutex> lock(session.mutex);
+        session.latencies.push_back(now() - ready);
+        return true;
+    }
+};
+
+// A simulated stream: live chunks every CHUNK_S between begin_s and end_s,
+// or backlog_chunks queued at once at begin_s
+struct StreamSpec {
+    DecodePriority priority;
+    double begin_s;
+    double end_s;
+    int backlog_chunks;
+};
+
+enum class PoolMode {
+    Fifo,      // One queue for every session's chunks
+    Fair,      // DecodeScheduler, every session in the live class
+    Classes    // DecodeScheduler with each stream's own class
+};
+
+struct SessionsResult {
+    std::vector<double> latencies[DECODE_PRIORITY_COUNT];  // Sorted, per stream class
+    double busy = 0.0;                                      // Worker utilization
+};
+
+SessionsResult simulateSessions(const std::vector<StreamSpec>& streams, int workers, PoolMode mode) {
+    using Sim = SimulatedSessions;
+    Sim sim;
+
+    // Every chunk arrival in audio time; live streams start staggered across a chunk
+    std::vector<std::pair<double, int>> arrivals;
+    for (size_t i = 0; i < streams.size(); i++) {
+        const StreamSpec& spec = streams[i];
+        sim.sessions.push_back(std::make_unique<Sim::Session>());
+        sim.sessions.back()->priority = spec.priority;
+        for (int c = 0; c < spec.backlog_chunks; c++) {
+            arrivals.push_back({spec.begin_s, int(i)});
+        }
+        if (spec.backlog_chunks == 0) {
+            double offset = Sim::CHUNK_S * double(i) / streams.size();
+            for (double end = spec.begin_s + Sim::CHUNK_S + offset; end <= spec.end_s; end += Sim::CHUNK_S) {
+                arrivals.push_back({end, int(i)});
+            }
+        }
+    }
+    std::stable_sort(arrivals.begin(), arrivals.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::mutex fifo_mutex;
+    std::condition_variable fifo_cv;
+    std::deque<int> fifo;
+    bool fifo_done = false;
+    std::atomic<double> busy_s{0.0};
+    std::unique_ptr<DecodeScheduler> scheduler;
+    std::vector<uint64_t> ids;
+    std::vector<std::thread> fifo_workers;
+    if (mode != PoolMode::Fifo) {
+        scheduler = std::make_unique<DecodeScheduler>(workers);
+        for (auto& session : sim.sessions) {
+            Sim::Session* s = session.get();
+            DecodeSessionOptions options;
+            options.priority = mode == PoolMode::Classes ? s->priority : DecodePriority::Live;
+            ids.push_back(scheduler->add([&sim, s]() { return sim.decode(*s); }, options));
+        }
+    } else {
+        for (int w = 0; w < workers; w++) {
+            fifo_workers.emplace_back([&]() {
+                std::unique_lock<std::mutex> lock(fifo_mutex);
+                while (true) {
+                    fifo_cv.wait(lock, [&]() { return fifo_done || !fifo.empty(); });
+                    if (fifo.empty()) {
+                        return;
+                    }
+                    int index = fifo.front();
+                    fifo.pop_front();
+                    lock.unlock();
+                    auto began = std::chrono::steady_clock::now();
+                    sim.decode(*sim.sessions[index]);
+                    double spent = std::chrono::duration<double>(std::chrono::steady_clock::now() - began).count();
+                    double total = busy_s.load();
+                    while (!busy_s.compare_exchange_weak(total, total + spent)) {
+                    }
+                    lock.lock();
+                }
+            });
+        }
+    }
+
+    sim.start = std::chrono::steady_clock::now();
+    for (const auto& arrival : arrivals) {
+        auto due = sim.start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                   std::chrono::duration<double>(arrival.first / Sim::SPEEDUP));
+        std::this_thread::sleep_until(due);
+        Sim::Session& session = *sim.sessions[arrival.second];
+        {
+            std::lock_guard<std::mutex> lock(session.mutex);
+            session.ready.push_back(arrival.first);
+        }
+        if (scheduler) {
+            scheduler->notify(ids[arrival.second], due);
+        } else {
+            std::lock_guard<std::mutex> lock(fifo_mutex);
+            fifo.push_back(arrival.second);
+            fifo_cv.notify_one();
+        }
+    }
+
+    // Let the queues drain, then stop the pool
+    auto drained = [&]() {
+        for (auto& session : sim.sessions) {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            if (!session->ready.empty()) {
+                return false;
+            }
+        }
+        return true;
+    };
+    while (!drained()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    double elapsed = sim.now() / Sim::SPEEDUP;
+    SessionsResult result;
+    if (scheduler) {
+        for (uint64_t id : ids) {
+            scheduler->remove(id);
+        }
+        result.busy = scheduler->stats().busy_s / (elapsed * workers);
+        scheduler.reset();
+    } else {
+        {
+            std::lock_guard<std::mutex> lock(fifo_mutex);
+            fifo_done = true;
+        }
+        fifo_cv.notify_all();
+        for (std::thread& worker : fifo_workers) {
+            worker.join();
+        }
+        result.busy = busy_s.load() / (elapsed * workers);
+    }
+    for (auto& session : sim.sessions) {
+        std::vector<double>& latencies = result.latencies[static_cast<int>(session->priority)];
+        latencies.insert(latencies.end(), session->latencies.begin(), session->latencies.end());
+    }
+    for (auto& latencies : result.latencies) {
+        std::sort(latencies.begin(), latencies.end());
+    }
+    return result;
+}
+
+int benchSessions() {
+    using Sim = SimulatedSessions;
+    const int workers = 4;
+    const double audio_s = 120.0;
+    double capacity = workers * Sim::CHUNK_S / (Sim::CALL_S + Sim::PER_AUDIO_S * Sim::CHUNK_S);
+    auto percentile = [](const std::vector<double>& sorted, double p) {
+        return sorted.empty() ? 0.0 : sorted[std::min(sorted.size() - 1, size_t(sorted.size() * p))];
+    };
+    auto live_streams = [&](int count, DecodePriority priority, double begin_s, double end_s) {
+        return std::vector<StreamSpec>(count, StreamSpec{priority, begin_s, end_s, 0});
+    };
+    bool ok = true;
+
+    std::cout << "🔬 Sessions on a shared decode pool (" << workers << " workers, simulated decoder "
+              << Sim::CALL_S << "s + " << Sim::PER_AUDIO_S << "x per " << Sim::CHUNK_S << "s chunk, capacity "
+              << std::fixed << std::setprecision(0) << capacity << " live streams)\n\n";
+    std::cout << std::left << std::setw(12) << "scheduler" << std::setw(20) << "load" << std::right
+              << std::setw(13) << "p50 latency" << std::setw(13) << "p95 latency" << std::setw(13) << "max latency"
+              << std::setw(13) << "utilization" << "\n";
+    std::cout << std::string(84, '-') << "\n";
+    auto report = [&](PoolMode mode, int live, int backlog) {
+        std::vector<StreamSpec> streams = live_streams(live, DecodePriority::Live, 0.0, audio_s);
+        if (backlog > 0) {
+            streams.push_back({DecodePriority::Batch, audio_s / 3.0, audio_s, backlog});
+        }
+        SessionsResult result = simulateSessions(streams, workers, mode);
+        const std::vector<double>& latencies = result.latencies[static_cast<int>(DecodePriority::Live)];
+        std::string load = std::to_string(live) + " live";
+        if (backlog > 0) {
+            load += " + " + std::to_string(backlog) + " backlog";
+        }
+        std::cout << std::left << std::setw(12) << (mode == PoolMode::Fifo ? "fifo" : "fair") << std::setw(20)
+                  << load << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << percentile(latencies, 0.5) << "s"
+                  << std::setw(12) << percentile(latencies, 0.95) << "s"
+                  << std::setw(12) << (latencies.empty() ? 0.0 : latencies.back()) << "s"
+                  << std::setw(12) << std::setprecision(0) << 100.0 * result.busy << "%\n";
+        return percentile(latencies, 0.95);
+    };
+    for (int live : {8, 16, 32, 40, 48}) {
+        double p95 = report(PoolMode::Fair, live, 0);
+        ok = ok && (live > capacity || p95 < 2.0);
+    }
+    double fifo_p95 = report(PoolMode::Fifo, 16, 120);
+    double fair_p95 = report(PoolMode::Fair, 16, 120);
+    ok = ok && fair_p95 < fifo_p95;
+
+    // A burst of near-live streams overloads the pool for 40s while a batch
+    // backlog waits; only classes keep the live streams inside their SLO
+    std::vector<StreamSpec> mixed = live_streams(36, DecodePriority::Live, 0.0, audio_s);
+    std::vector<StreamSpec> burst = live_streams(12, DecodePriority::NearLive, 40.0, 80.0);
+    mixed.insert(mixed.end(), burst.begin(), burst.end());
+    mixed.push_back({DecodePriority::Batch, 10.0, audio_s, 120});
+
+    std::cout << "\n36 live streams, 12 near-live for 40s of the run, 120 batch chunks queued at 10s:\n\n";
+    std::cout << std::left << std::setw(12) << "scheduler" << std::setw(12) << "class" << std::right
+              << std::setw(13) << "p50 latency" << std::setw(13) << "p95 latency" << std::setw(13) << "max latency"
+              << std::setw(15) << "past deadline" << "\n";
+    std::cout << std::string(78, '-') << "\n";
+    double live_missed[3] = {};
+    for (PoolMode mode : {PoolMode::Fifo, PoolMode::Fair, PoolMode::Classes}) {
+        SessionsResult result = simulateSessions(mixed, workers, mode);
+        const char* name = mode == PoolMode::Fifo ? "fifo" : mode == PoolMode::Fair ? "fair" : "classes";
+        for (DecodePriority priority : {DecodePriority::Live, DecodePriority::NearLive, DecodePriority::Batch}) {
+            const std::vector<double>& latencies = result.latencies[static_cast<int>(priority)];
+            double slo_s = DecodeScheduler::defaultSloMs(priority) / 1000.0;
+            double missed = 0.0;
+            if (slo_s > 0.0 && !latencies.empty()) {
+                auto first_late = std::upper_bound(latencies.begin(), latencies.end(), slo_s);
+                missed = 100.0 * (latencies.end() - first_late) / latencies.size();
+            }
+            if (priority == DecodePriority::Live) {
+                live_missed[static_cast<int>(mode)] = missed;
+            }
+            std::cout << std::left << std::setw(12) << (priority == DecodePriority::Live ? name : "")
+                      << std::setw(12) << decodePriorityName(priority) << std::right << std::fixed
+                      << std::setprecision(2)
+                      << std::setw(12) << percentile(latencies, 0.5) << "s"
+                      << std::setw(12) << percentile(latencies, 0.95) << "s"
+                      << std::setw(12) << (latencies.empty() ? 0.0 : latencies.back()) << "s";
+            if (slo_s > 0.0) {
+                std::cout << std::setw(14) << std::setprecision(1) << missed << "%";
+            } else {
+                std::cout << std::setw(15) << "-";
+            }
+            std::cout << "\n";
+        }
+    }
+    ok = ok && live_missed[static_cast<int>(PoolMode::Classes)] < 1.0 &&
+         live_missed[static_cast<int>(PoolMode::Classes)] <= live_missed[static_cast<int>(PoolMode::Fair)];
+
+    std::cout << "\nlatency: a chunk's arrival to its text, in audio seconds; deadlines "
+              << DecodeScheduler::defaultSloMs(DecodePriority::Live) / 1000 << "s live, "
+              << DecodeScheduler::defaultSloMs(DecodePriority::NearLive) / 1000 << "s near-live\n"
+              << "\nScheduling " << (ok ? "as expected" : "WRONG") << std::endl;
+    return ok ? 0 : 1;
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " BENCHMARK [ARGS]\n\n";
+    std::cout << "Benchmarks:\n";
+    std::cout << "  resample        Polyphase resampler vs. linear interpolation (speed, SNR)\n";
+    std::cout << "  chunker         Incremental vs. rescanning silence search on long speech\n";
+    std::cout << "  alloc           Heap allocations per chunk after warmup (must be zero)\n";
+    std::cout << "  kernels         Energy kernels per ISA level: correctness and GB/s\n";
+    std::cout << "  vad             Frame VAD cost per frame across window lengths and backends\n";
+    std::cout << "  vad-eval [WAV LABELS]\n";
+    std::cout << "                  Energy vs. spectral VAD: speech recall, false alarms, decoder\n";
+    std::cout << "                  calls avoided; LABELS is an Audacity track of speech regions\n";
+    std::cout << "  trim            Edge trimming of smart chunks: audio never decoded, speech kept\n";
+    std::cout << "  coalesce        Chunks merged on a full queue across gated-out or trimmed audio\n";
+    std::cout << "  adaptive        Adaptive chunk sizing vs. fixed chunks as decode speed changes\n";
+    std::cout << "  partials        Streaming partials: time to first word, commit delay, decode cost\n";
+    std::cout << "  convert         16-bit PCM to float per ISA; pipe ingest CPU, float32 vs. int16\n";
+    std::cout << "  reader          Pipe reader: per-sample istream vs. read(2) blocks, CPU per audio second\n";
+    std::cout << "  source          PCM source: startup handshake, restart gap, pipe capacity\n";
+    std::cout << "  sessions        Daemon decode pool: latency as live sessions are added, fairness\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string benchmark = argv[1];
+    if (benchmark == "resample") {
+        return benchResample();
+    }
+    if (benchmark == "chunker") {
+        return benchChunker();
+    }
+    if (benchmark == "alloc") {
+        return benchAlloc();
+    }
+    if (benchmark == "kernels") {
+        return benchKernels();
+    }
+    if (benchmark == "vad") {
+        return benchVad();
+    }
+    if (benchmark == "partials") {
+        return benchPartials();
+    }
+    if (benchmark == "adaptive") {
+        return benchAdaptive();
+    }
+    if (benchmark == "convert") {
+        return benchConvert();
+    }
+    if (benchmark == "reader") {
+        return benchReader();
+    }
+    if (benchmark == "source") {
+        return benchSource();
+    }
+    if (benchmark == "sessions") {
+        return benchSessions();
+    }
+    if (benchmark == "trim") {
+        return benchTrim();
+    }
+    if (benchmark == "coalesce") {
+        return benchCoalesce();
+    }
+    if (benchmark == "vad-eval") {
+        return benchVadEval(argc - 2, argv + 2);
+    }
+
+    printUsage(argv[0]);
+    return benchmark == "-h" || benchmark == "--help" ? 0 : 1;
+}
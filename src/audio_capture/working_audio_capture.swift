@@ -8,6 +8,12 @@ class WorkingAudioRecorder: NSObject {
     private let targetSampleRate: Int = 16000
     private let targetChannels: Int = 1
     
+    // Framed wire protocol (see src/transcriber/wire_protocol.h)
+    private let framed: Bool
+    private let s16: Bool
+    private let streamId = UInt32.random(in: 1...UInt32.max)
+    private var sequence: UInt32 = 0
+    
     private var audioEngine: AVAudioEngine!
     private var pipeHandle: FileHandle?
     private var isRecording = false
@@ -20,8 +26,10 @@ class WorkingAudioRecorder: NSObject {
     private var systemAudioBuffer: [Float] = []
     private let bufferLock = NSLock()
     
-    init(pipePath: String) {
+    init(pipePath: String, framed: Bool, s16: Bool) {
         self.pipePath = pipePath
+        self.framed = framed
+        self.s16 = s16
         super.init()
         audioEngine = AVAudioEngine()
     }
@@ -120,7 +128,11 @@ class WorkingAudioRecorder: NSObject {
         
         // Convert to data and write to pipe
         if let data = bufferToData(mixedBuffer) {
-            pipeHandle?.write(data)
+            if framed {
+                pipeHandle?.write(frameHeader(payloadBytes: data.count) + data)
+            } else {
+                pipeHandle?.write(data)
+            }
         }
     }
     
@@ -229,6 +241,18 @@ class WorkingAudioRecorder: NSObject {
         let channelCount = Int(buffer.format.channelCount)
         let totalSamples = frameLength * channelCount
         
+        if s16 {
+            // 16-bit PCM halves pipe bandwidth; the transcriber converts back to float
+            var pcm = [Int16](repeating: 0, count: totalSamples)
+            for frame in 0..<frameLength {
+                for channel in 0..<channelCount {
+                    let sample = max(-1.0, min(1.0, channelData[channel][frame]))
+                    pcm[frame * channelCount + channel] = Int16(sample * 32767.0).littleEndian
+                }
+            }
+            return pcm.withUnsafeBytes { Data($0) }
+        }
+        
         var audioData = Data(capacity: totalSamples * MemoryLayout<Float>.size)
         
         // Interleave channels
@@ -242,6 +266,29 @@ class WorkingAudioRecorder: NSObject {
         return audioData
     }
     
+    // Builds the 40-byte AudioFrameHeader that precedes each payload
+    private func frameHeader(payloadBytes: Int) -> Data {
+        var header = Data(capacity: 40)
+        func append<T: FixedWidthInteger>(_ value: T) {
+            withUnsafeBytes(of: value.littleEndian) { header.append(contentsOf: $0) }
+        }
+        
+        append(UInt32(0x46445541))              // magic "AUDF"
+        append(UInt16(1))                       // version
+        append(UInt16(40))                      // header_size
+        append(UInt32(targetSampleRate))
+        append(UInt16(targetChannels))
+        append(UInt16(s16 ? 2 : 1))             // sample_format: int16 or float32
+        append(streamId)
+        append(sequence)
+        append(UInt32(payloadBytes))
+        append(UInt32(0))                       // reserved
+        append(DispatchTime.now().uptimeNanoseconds)
+        
+        sequence &+= 1
+        return header
+    }
+    
     private func requestPermissions() async {
         _ = await AVCaptureDevice.requestAccess(for: .audio)
     }
@@ -553,8 +600,10 @@ enum AudioCaptureError: Error {
 }
 
 // Simple command line parsing
-func parseArguments(_ args: [String]) -> (pipePath: String?, help: Bool) {
+func parseArguments(_ args: [String]) -> (pipePath: String?, framed: Bool, s16: Bool, help: Bool) {
     var pipePath: String?
+    var framed = false
+    var s16 = false
     var help = false
     
     var i = 1
@@ -563,6 +612,10 @@ func parseArguments(_ args: [String]) -> (pipePath: String?, help: Bool) {
         
         if arg == "--help" || arg == "-h" {
             help = true
+        } else if arg == "--framed" {
+            framed = true
+        } else if arg == "--s16" {
+            s16 = true
         } else if arg == "--pipe" && i + 1 < args.count {
             pipePath = args[i + 1]
             i += 1
@@ -570,20 +623,22 @@ func parseArguments(_ args: [String]) -> (pipePath: String?, help: Bool) {
         i += 1
     }
     
-    return (pipePath, help)
+    return (pipePath, framed, s16, help)
 }
 
 func printUsage() {
     print("Usage: working_audio_capture --pipe <pipe_path>")
     print("Options:")
     print("  --pipe <path>    Named pipe path for audio output")
+    print("  --framed         Prefix each buffer with a frame header")
+    print("  --s16            Write 16-bit PCM instead of float32")
     print("  --help, -h       Show this help message")
 }
 
 // Main execution
 if #available(macOS 13.0, *) {
     let args = CommandLine.arguments
-    let (pipePath, help) = parseArguments(args)
+    let (pipePath, framed, s16, help) = parseArguments(args)
     
     if help {
         printUsage()
@@ -596,7 +651,7 @@ if #available(macOS 13.0, *) {
         exit(1)
     }
     
-    let recorder = WorkingAudioRecorder(pipePath: pipePath)
+    let recorder = WorkingAudioRecorder(pipePath: pipePath, framed: framed, s16: s16)
     
     Task {
         do {
@@ -10,17 +10,22 @@
 #include <algorithm>
 #include <set>
 #include <cctype>
+#include <future>
 #include <unistd.h>
-#include <sys/stat.h>
-#include <sys/wait.h>
 #include <getopt.h>
 #include "transcriber/transcriber.h"
+#include "transcriber/pcm_convert.h"
+#include "transcriber/audio_energy.h"
+#include "transcriber/session_server.h"
 
 namespace fs = std::filesystem;
 
 // Global flag for clean shutdown
 std::atomic<bool> g_shutdown{false};
 
+// Startup metrics count from here
+const auto g_process_start = std::chrono::steady_clock::now();
+
 struct AppConfig {
     std::string output_file = "transcript.txt";
     bool timestamps = true;
@@ -30,30 +35,111 @@ struct AppConfig {
     std::string language = "en";
     bool translate = false;
     int threads = 4;
+    bool warmup = true;              // Warm the decoder up with a silence decode at startup
     int sample_rate = 16000;
     int channels = 1;
     bool enable_vad = true;
     float vad_threshold = 0.6f;
+    VadMode vad_mode = VadMode::Energy;
+    std::string vad_model_path = "models/ggml-silero-v5.1.2.bin";
+    bool adaptive_chunking = false;
+    int target_latency_ms = 8000;
+    bool streaming_partials = false;
+    int partial_interval_ms = 500;
+    bool trim_edges = true;
+    int edge_guard_ms = 200;
     int chunk_duration_ms = 3000;
     int overlap_ms = 500;
     int max_latency_ms = 1000;
+    int read_block_bytes = 16384;
+    int ring_buffer_size = 16384;
+    QueueOverflowPolicy queue_policy = QueueOverflowPolicy::DropNewest;
+    bool framed_input = true;
+    bool s16_input = false;
+    AudioTransport transport = AudioTransport::Pipe;
+    std::string source;              // PcmSource spec (cmd:, fifo:, file:, -); empty runs ./audio_capture
+    bool restart_source = true;      // Restart a source command that exits
+    std::string input_file;          // Offline mode: transcribe this WAV instead of capturing
+    int parallel_decoders = 0;       // Offline decoders; 0 = one per --threads worth of cores
+    std::string serve_socket;        // Daemon mode: serve sessions on this Unix socket
+    int max_sessions = 32;
+    int decode_workers = 0;          // Daemon decode pool; 0 = one per --threads worth of cores
+    DecodePriority decode_priority = DecodePriority::Live;  // Class of sessions that do not pick one
+    int latency_slo_ms = 0;          // Their deadline after a chunk is queued; 0 = class default
     bool verbose = false;
 };
 
+void setupSignalHandlers() {
+    // Proper signal handling that actually stops the application
+    std::signal(SIGINT, [](int) {
+        std::cout << "\n🛑 Received interrupt signal..." << std::endl;
+        g_shutdown.store(true);
+    });
+    
+    std::signal(SIGTERM, [](int) {
+        std::cout << "\n🛑 Received termination signal..." << std::endl;
+        g_shutdown.store(true);
+    });
+}
+
+// Transcriber settings for the live app, the offline run and every served session
+TranscriptionConfig makeTranscriptionConfig(const AppConfig& app) {
+    TranscriptionConfig config;
+    config.model_path = app.model_path;
+    config.language = app.language;
+    config.translate = app.translate;
+    config.threads = app.threads;
+    config.warmup = app.warmup;
+    config.enable_vad = app.enable_vad;
+    config.vad_threshold = app.vad_threshold;
+    config.vad_mode = app.vad_mode;
+    config.vad_model_path = app.vad_model_path;
+    config.adaptive_chunking = app.adaptive_chunking;
+    config.target_latency_ms = app.target_latency_ms;
+    config.streaming_partials = app.streaming_partials;
+    config.partial_interval_ms = app.partial_interval_ms;
+    config.trim_edges = app.trim_edges;
+    config.edge_guard_ms = app.edge_guard_ms;
+    config.chunk_duration_ms = app.chunk_duration_ms;
+    config.overlap_ms = app.overlap_ms;
+    config.timestamps = app.timestamps;
+    config.read_block_bytes = app.read_block_bytes;
+    config.ring_buffer_size = app.ring_buffer_size;
+    config.queue_overflow_policy = app.queue_policy;
+    config.framed_input = app.framed_input;
+    config.transport = app.transport;
+    config.decode_priority = app.decode_priority;
+    config.latency_slo_ms = app.latency_slo_ms;
+    if (app.s16_input) {
+        config.raw_format = AudioSampleFormat::Int16;
+    }
+    return config;
+}
+
 class RealTimeTranscriptionApp {
 private:
     AppConfig config_;
     std::unique_ptr<StreamingTranscriber> transcriber_;
     std::ofstream output_stream_;
     std::string pipe_path_;
-    pid_t capture_pid_ = -1;
+    std::string shm_name_;
+    std::unique_ptr<ShmAudioRing> shm_ring_;
+    std::unique_ptr<PcmSource> source_;
     std::atomic<int> total_chunks_{0};
     std::atomic<int> transcribed_chunks_{0};
+    uint64_t reported_sizing_adjustments_ = 0;  // Transcription thread only
+    std::string utterance_text_;                // Streaming: committed words of the open utterance
+    float utterance_timestamp_ = 0.0f;
+    std::string partial_text_;                  // Streaming: unconfirmed words shown after them
     std::chrono::steady_clock::time_point start_time_;
+    double input_ready_ms_ = 0.0;               // Output file plus audio source, alongside the model load
+    double ready_s_ = 0.0;                      // Process start to listening
+    std::atomic<int64_t> first_text_us_{-1};    // Process start to the first words shown
     
 public:
     RealTimeTranscriptionApp(const AppConfig& config) : config_(config) {
         pipe_path_ = "/tmp/audio_transcriber_" + std::to_string(getpid());
+        shm_name_ = "/audio_transcriber_" + std::to_string(getpid());
     }
     
     ~RealTimeTranscriptionApp() {
@@ -66,48 +152,37 @@ public:
             return false;
         }
         
-        TranscriptionConfig transcription_config;
-        transcription_config.model_path = config_.model_path;
-        transcription_config.language = config_.language;
-        transcription_config.translate = config_.translate;
-        transcription_config.threads = config_.threads;
-        transcription_config.enable_vad = config_.enable_vad;
-        transcription_config.vad_threshold = config_.vad_threshold;
-        transcription_config.chunk_duration_ms = config_.chunk_duration_ms;
-        transcription_config.overlap_ms = config_.overlap_ms;
-        transcription_config.timestamps = config_.timestamps;
-        
-        transcriber_ = std::make_unique<StreamingTranscriber>(transcription_config);
+        transcriber_ = std::make_unique<StreamingTranscriber>(makeTranscriptionConfig(config_));
         
-        if (!transcriber_->initialize()) {
-            return false;
-        }
+        // Ctrl+C during startup must still reach cleanup(), which stops the source
+        setupSignalHandlers();
         
-        output_stream_.open(config_.output_file, std::ios::app);
-        if (!output_stream_.is_open()) {
-            std::cerr << "❌ Failed to open output file: " << config_.output_file << std::endl;
-            return false;
-        }
+        // Load and warm up the model while the output file and audio source
+        // are prepared; audio captured meanwhile waits in the pipe buffer
+        std::future<bool> loading = std::async(std::launch::async, [this]() {
+            return transcriber_->initialize();
+        });
+        auto input_start = std::chrono::steady_clock::now();
+        bool input_ready = openOutput() && prepareInput();
+        input_ready_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - input_start).count();
+        bool model_ready = loading.get();
         
-        return true;
+        return input_ready && model_ready && !g_shutdown.load();
     }
     
     void run() {
-        setupSignalHandlers();
         writeSessionHeader();
         
-        if (!createNamedPipe()) {
-            return;
-        }
-        
-        if (!startAudioCapture()) {
+        if (!config_.input_file.empty()) {
+            runFile();
             return;
         }
         
         startTranscription();
+        reportStartup();
         
         // Main loop with proper shutdown handling
-        while (!g_shutdown.load() && transcriber_->isRunning()) {
+        while (!g_shutdown.load() && transcriber_->isRunning() && !transcriber_->sourceEnded()) {
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
         
@@ -115,17 +190,34 @@ public:
     }
     
 private:
-    void setupSignalHandlers() {
-        // Proper signal handling that actually stops the application
-        std::signal(SIGINT, [](int) {
-            std::cout << "\n🛑 Received interrupt signal..." << std::endl;
-            g_shutdown.store(true);
-        });
+    void runFile() {
+        start_time_ = std::chrono::steady_clock::now();
+        reportStartup();
         
-        std::signal(SIGTERM, [](int) {
-            std::cout << "\n🛑 Received termination signal..." << std::endl;
-            g_shutdown.store(true);
+        int decoders = config_.parallel_decoders;
+        if (decoders <= 0) {
+            unsigned cores = std::thread::hardware_concurrency();
+            decoders = std::max(1, static_cast<int>(cores) / std::max(1, config_.threads));
+        }
+        
+        std::cout << "📂 Transcribing " << config_.input_file << " with " << decoders << " decoders" << std::endl;
+        
+        // Decode on a worker so Ctrl+C can still stop a long file
+        std::atomic<bool> finished{false};
+        std::thread worker([&]() {
+            transcriber_->transcribeFile(config_.input_file, decoders, [this](const TranscriptionResult& result) {
+                onTranscriptionResult(result);
+            });
+            finished.store(true);
         });
+        
+        while (!g_shutdown.load() && !finished.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        if (!finished.load()) {
+            transcriber_->stop();
+        }
+        worker.join();
     }
     
     void writeSessionHeader() {
@@ -142,6 +234,10 @@ private:
         output_stream_ << "VAD: " << (config_.enable_vad ? "Enabled" : "Disabled") << std::endl;
         if (config_.enable_vad) {
             output_stream_ << "VAD Threshold: " << config_.vad_threshold << std::endl;
+            output_stream_ << "VAD Mode: " << vadModeName(config_.vad_mode) << std::endl;
+        }
+        if (config_.streaming_partials) {
+            output_stream_ << "Streaming: partials every " << config_.partial_interval_ms << "ms" << std::endl;
         }
         output_stream_ << std::string(50, '=') << std::endl << std::endl;
         output_stream_.flush();
@@ -152,7 +248,11 @@ private:
             std::cout << "🤖 Model: " << fs::path(config_.model_path).filename() << std::endl;
             std::cout << "🌍 Language: " << config_.language << std::endl;
             if (config_.enable_vad) {
-                std::cout << "🎯 VAD: Enabled (threshold: " << config_.vad_threshold << ")" << std::endl;
+                std::cout << "🎯 VAD: Enabled (threshold: " << config_.vad_threshold
+                          << ", " << vadModeName(config_.vad_mode) << ")" << std::endl;
+            }
+            if (config_.streaming_partials) {
+                std::cout << "⚡ Streaming: partials every " << config_.partial_interval_ms << "ms" << std::endl;
             }
             std::cout << std::string(50, '-') << std::endl;
             std::cout << "Press Ctrl+C to stop" << std::endl;
@@ -160,79 +260,140 @@ private:
         }
     }
     
-    bool createNamedPipe() {
-        unlink(pipe_path_.c_str());
-        
-        if (mkfifo(pipe_path_.c_str(), 0666) != 0) {
-            std::cerr << "❌ Failed to create named pipe: " << pipe_path_ << std::endl;
+    bool openOutput() {
+        output_stream_.open(config_.output_file, std::ios::app);
+        if (!output_stream_.is_open()) {
+            std::cerr << "❌ Failed to open output file: " << config_.output_file << std::endl;
             return false;
         }
-        
-        if (config_.verbose) {
-            std::cout << "📡 Created pipe: " << pipe_path_ << std::endl;
-        }
-        
         return true;
     }
     
-    bool startAudioCapture() {
-        std::vector<std::string> args = {
-            "./audio_capture",
-            "--pipe", pipe_path_
-        };
-        
-        if (config_.verbose) {
-            std::cout << "🎤 Starting audio capture with pipe: " << pipe_path_ << std::endl;
+    bool prepareInput() {
+        if (!config_.input_file.empty()) {
+            return true;
+        }
+        if (config_.transport == AudioTransport::SharedMemory) {
+            // The capture tool only speaks FIFO; an external producer attaches to the ring
+            return createSharedRing();
+        }
+        return startAudioSource();
+    }
+    
+    // Time to ready and where it went; the model load ran alongside the input setup
+    void reportStartup() {
+        ready_s_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - g_process_start).count();
+        if (!config_.verbose) {
+            return;
+        }
+        StartupTimings timings = transcriber_->startupTimings();
+        std::cout << "⏱️ Ready " << std::fixed << std::setprecision(2) << ready_s_ << "s after start: model "
+                  << timings.model_load_ms / 1000.0 << "s + state " << timings.state_ms / 1000.0 << "s";
+        if (timings.vad_load_ms > 0.0) {
+            std::cout << " + VAD model " << timings.vad_load_ms / 1000.0 << "s";
+        }
+        std::cout << " + warmup " << timings.warmup_ms / 1000.0 << "s, alongside output and audio source "
+                  << input_ready_ms_ / 1000.0 << "s" << std::defaultfloat << std::endl;
+        std::cout << "🧮 Memory: model " << (timings.model_shared ? "shared, " : "")
+                  << timings.model_bytes / (1024 * 1024) << " MiB, decoder state "
+                  << timings.state_bytes / (1024 * 1024) << " MiB, process "
+                  << residentMemoryBytes() / (1024 * 1024) << " MiB resident" << std::endl;
+    }
+    
+    // Process start to the first words on screen, recorded once
+    void noteFirstText() {
+        if (first_text_us_.load() >= 0) {
+            return;
+        }
+        auto elapsed = std::chrono::steady_clock::now() - g_process_start;
+        int64_t expected = -1;
+        first_text_us_.compare_exchange_strong(
+            expected, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    }
+    
+    bool createSharedRing() {
+        shm_ring_ = std::make_unique<ShmAudioRing>();
+        if (!shm_ring_->create(shm_name_, config_.ring_buffer_size, config_.sample_rate)) {
+            return false;
         }
         
-        capture_pid_ = fork();
-        if (capture_pid_ == 0) {
-            // Child process
-            std::vector<char*> c_args;
-            for (auto& arg : args) {
-                c_args.push_back(const_cast<char*>(arg.c_str()));
+        std::cout << "📡 Shared memory ring ready: " << shm_name_ << std::endl;
+        std::cout << "   Feed it with e.g. ./shm_replay --ring " << shm_name_ << " audio.wav" << std::endl;
+        return true;
+    }
+    
+    bool startAudioSource() {
+        PcmSourceConfig source_config;
+        if (config_.source.empty()) {
+            source_config.target = "./audio_capture --pipe {pipe}";
+            if (config_.framed_input) {
+                source_config.target += " --framed";
             }
-            c_args.push_back(nullptr);
-            
-            // Redirect stderr for cleaner output unless verbose
-            if (!config_.verbose) {
-                freopen("/dev/null", "w", stderr);
+            if (config_.s16_input) {
+                source_config.target += " --s16";
             }
-            
-            execv("./audio_capture", c_args.data());
-            exit(1);
-        } else if (capture_pid_ < 0) {
-            std::cerr << "❌ Failed to start audio capture process" << std::endl;
+        } else if (!parsePcmSource(config_.source, source_config)) {
+            std::cerr << "❌ Unknown audio source: " << config_.source << std::endl;
             return false;
         }
+        source_config.pipe_path = pipe_path_;
+        source_config.restart = config_.restart_source;
+        source_config.quiet = !config_.verbose;
         
-        // Give capture process time to initialize and open the pipe
-        std::this_thread::sleep_for(std::chrono::seconds(2));
+        if (config_.verbose) {
+            std::cout << "🎤 Starting audio source: " << pcmSourceKindName(source_config.kind) << ":"
+                      << source_config.target << std::endl;
+        }
         
-        // Check if process is still running
-        int status;
-        pid_t result = waitpid(capture_pid_, &status, WNOHANG);
-        if (result != 0) {
-            std::cerr << "❌ Audio capture process failed to start (exit code: " << status << ")" << std::endl;
+        source_ = std::make_unique<PcmSource>(source_config);
+        if (!source_->open()) {
+            source_.reset();
             return false;
         }
         
+        if (config_.verbose) {
+            PcmSourceStats stats = source_->stats();
+            std::cout << "📡 Audio source ready in " << std::fixed << std::setprecision(0) << stats.ready_ms
+                      << "ms, pipe buffer " << stats.pipe_bytes / 1024 << " KiB" << std::defaultfloat << std::endl;
+            if (config_.s16_input) {
+                std::cout << "🔢 16-bit PCM conversion: " << pcmConvertIsa() << std::endl;
+            }
+        }
+        
         return true;
     }
     
     void startTranscription() {
         start_time_ = std::chrono::steady_clock::now();
         
-        transcriber_->start(pipe_path_, [this](const TranscriptionResult& result) {
+        auto on_result = [this](const TranscriptionResult& result) {
             onTranscriptionResult(result);
-        });
+        };
+        std::string source;
+        if (source_) {
+            transcriber_->start(*source_, on_result);
+            source = source_->describe();
+        } else {
+            transcriber_->start(shm_name_, on_result);
+            source = shm_name_;
+        }
         
         if (config_.verbose) {
-            std::cout << "🚀 Transcription started, listening on: " << pipe_path_ << std::endl;
+            std::cout << "🚀 Transcription started, listening on: " << source << std::endl;
+            std::cout << "🔢 Energy kernels: " << energyKernelIsa() << std::endl;
         }
     }
     
     void onTranscriptionResult(const TranscriptionResult& result) {
+        if (config_.verbose && config_.adaptive_chunking) {
+            reportChunkSizing();
+        }
+        
+        if (config_.streaming_partials) {
+            onStreamingResult(result);
+            return;
+        }
+        
         if (result.text.empty()) {
             return;
         }
@@ -248,6 +409,7 @@ private:
         }
         
         transcribed_chunks_.fetch_add(1);
+        noteFirstText();
         
         std::string output = formatTranscription(result);
         
@@ -261,6 +423,94 @@ private:
         output_stream_.flush();
     }
     
+    // Streaming results arrive as committed words (never revised) and the
+    // unconfirmed tail after them. The console line shows both, the tail
+    // dimmed and rewritten in place; the file gets whole utterances.
+    void onStreamingResult(const TranscriptionResult& result) {
+        if (!result.text.empty()) {
+            noteFirstText();
+        }
+        if (result.is_partial) {
+            partial_text_ = result.text;
+            drawStreamingLine();
+            return;
+        }
+        
+        if (!result.text.empty()) {
+            if (utterance_text_.empty()) {
+                utterance_timestamp_ = result.timestamp;
+            } else {
+                utterance_text_ += " ";
+            }
+            utterance_text_ += result.text;
+        }
+        if (!result.ends_utterance) {
+            drawStreamingLine();
+            return;
+        }
+        
+        partial_text_.clear();
+        if (utterance_text_.empty()) {
+            return;
+        }
+        total_chunks_.fetch_add(1);
+        
+        TranscriptionResult utterance;
+        utterance.text = utterance_text_;
+        utterance.timestamp = utterance_timestamp_;
+        utterance.confidence = 0.0f;
+        utterance_text_.clear();
+        
+        if (isRepetitiveText(utterance.text)) {
+            if (config_.real_time_display) {
+                std::cout << "\r\033[K" << std::flush;
+            }
+            if (config_.verbose) {
+                std::cout << "🔇 Skipped: \"" << utterance.text << "\" (repetitive)" << std::endl;
+            }
+            return;
+        }
+        transcribed_chunks_.fetch_add(1);
+        
+        std::string output = formatTranscription(utterance);
+        if (config_.real_time_display) {
+            std::cout << "\r\033[K" << output << std::endl;
+        }
+        output_stream_ << output << std::endl;
+        output_stream_.flush();
+    }
+    
+    void drawStreamingLine() {
+        if (!config_.real_time_display) {
+            return;
+        }
+        TranscriptionResult line;
+        line.text = utterance_text_;
+        line.timestamp = utterance_text_.empty() ? -1.0f : utterance_timestamp_;
+        line.confidence = 0.0f;
+        std::cout << "\r\033[K" << formatTranscription(line);
+        if (!partial_text_.empty()) {
+            std::cout << (utterance_text_.empty() ? "" : " ") << "\033[2m" << partial_text_ << "\033[0m";
+        }
+        std::cout << std::flush;
+    }
+    
+    void reportChunkSizing() {
+        ChunkSizingStats sizing = transcriber_->chunkSizingStats();
+        if (sizing.adjustments == reported_sizing_adjustments_) {
+            return;
+        }
+        reported_sizing_adjustments_ = sizing.adjustments;
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(1)
+           << "📐 Chunks now " << sizing.min_chunk_ms / 1000.0 << "/" << sizing.optimal_chunk_ms / 1000.0
+           << "/" << sizing.max_chunk_ms / 1000.0 << "s min/optimal/max (" << chunkSizingReasonName(sizing.reason)
+           << "): RTF " << std::setprecision(2) << sizing.real_time_factor << ", queue " << sizing.queue_depth
+           << ", latency " << std::setprecision(1) << sizing.measured_latency_s << "s measured, "
+           << sizing.predicted_latency_s << "s predicted";
+        std::cout << ss.str() << std::endl;
+    }
+    
     std::string formatTranscription(const TranscriptionResult& result) {
         std::stringstream ss;
         
@@ -401,17 +651,60 @@ private:
     void cleanup() {
         if (transcriber_) {
             transcriber_->stop();
+            
+            if (config_.verbose) {
+                int64_t first_text_us = first_text_us_.load();
+                std::cout << "⏱️ Startup: ready after " << std::fixed << std::setprecision(2) << ready_s_ << "s, first text ";
+                if (first_text_us >= 0) {
+                    std::cout << "after " << first_text_us / 1e6 << "s";
+                } else {
+                    std::cout << "never shown";
+                }
+                std::cout << std::defaultfloat << std::endl;
+                
+                AudioPoolStats pool = transcriber_->poolStats();
+                ChunkQueueStats queue = transcriber_->queueStats();
+                std::cout << "🧱 Audio buffers: " << pool.blocks_allocated << " blocks allocated ("
+                          << pool.blocks_allocated * SAMPLE_BLOCK_SIZE * sizeof(float) / 1024 << " KiB), "
+                          << pool.blocks_reused << " reused, peak " << pool.peak_blocks_in_use << " in use; "
+                          << queue.chunks_allocated << " chunks allocated, "
+                          << queue.chunks_reused << " reused" << std::endl;
+                
+                EdgeTrimStats trim = transcriber_->edgeTrimStats();
+                if (trim.chunks > 0) {
+                    std::cout << "✂️ Edge trim: " << std::fixed << std::setprecision(0) << trim.secondsPerHour()
+                              << "s per hour of chunk audio never decoded (" << trim.trimmed_chunks << " of "
+                              << trim.chunks << " chunks trimmed)" << std::defaultfloat << std::endl;
+                }
+                
+                OverlapStats overlap = transcriber_->overlapStats();
+                if (overlap.chunks > 0) {
+                    std::cout << "🔁 Overlap: " << std::fixed << std::setprecision(2) << overlap.redundancy()
+                              << "s decoded twice per second of new audio, " << overlap.words_dropped
+                              << " words dropped as already transcribed" << std::defaultfloat << std::endl;
+                }
+                
+                if (config_.adaptive_chunking) {
+                    ChunkSizingStats sizing = transcriber_->chunkSizingStats();
+                    std::cout << "📐 Chunk sizing: " << sizing.adjustments << " adjustments over "
+                              << sizing.decodes << " decodes, ended at " << sizing.optimal_chunk_ms / 1000.0
+                              << "s optimal (" << chunkSizingReasonName(sizing.reason) << "); fitted "
+                              << sizing.call_overhead_s << "s per call + " << sizing.cost_per_audio_s
+                              << "s per audio second" << std::endl;
+                }
+            }
         }
         
-        if (capture_pid_ > 0) {
+        if (source_) {
             if (config_.verbose) {
-                std::cout << "🛑 Stopping audio capture process..." << std::endl;
+                PcmSourceStats stats = source_->stats();
+                std::cout << "🛑 Stopping audio source (" << stats.restarts << " restarts)..." << std::endl;
             }
-            kill(capture_pid_, SIGTERM);
-            waitpid(capture_pid_, nullptr, 0);
+            source_->close();
+            source_.reset();
         }
         
-        unlink(pipe_path_.c_str());
+        shm_ring_.reset();
         
         if (output_stream_.is_open()) {
             auto now = std::chrono::system_clock::now();
@@ -432,11 +725,132 @@ private:
     }
 };
 
-AppConfig loadConfig(const std::string& config_file) {
-    AppConfig config;
-    // For now, just return default config
-    // JSON config loading can be added later if needed
-    return config;
+// Queue wait per priority class, for classes that decoded anything
+void printDecodeWaits(const DecodeSchedulerStats& scheduler) {
+    for (DecodePriority priority : {DecodePriority::Live, DecodePriority::NearLive, DecodePriority::Batch}) {
+        const DecodeClassStats& waits = scheduler.of(priority);
+        if (waits.jobs == 0) {
+            continue;
+        }
+        std::cout << "⏳ " << decodePriorityName(priority) << ": " << waits.jobs << " chunks, wait "
+                  << std::fixed << std::setprecision(0) << waits.mean_wait_ms << "ms mean / "
+                  << waits.max_wait_ms << "ms max";
+        if (priority != DecodePriority::Batch) {
+            std::cout << ", " << waits.missed << " past deadline";
+        }
+        std::cout << std::defaultfloat << std::endl;
+    }
+}
+
+// Daemon mode: one model, many sessions, until SIGINT or SIGTERM
+int runServer(const AppConfig& config) {
+    if (!fs::exists(config.model_path)) {
+        std::cerr << "❌ Model not found: " << config.model_path << std::endl;
+        return 1;
+    }
+    setupSignalHandlers();
+    
+    SessionServerConfig server_config;
+    server_config.socket_path = config.serve_socket;
+    server_config.max_sessions = config.max_sessions;
+    server_config.decode_workers = config.decode_workers;
+    SessionServer server(server_config, makeTranscriptionConfig(config));
+    if (!server.start()) {
+        return 1;
+    }
+    if (config.verbose) {
+        std::cout << "🧮 Memory: " << residentMemoryBytes() / (1024 * 1024) << " MiB resident with the model loaded" << std::endl;
+    }
+    
+    uint64_t reported_served = 0;
+    while (!g_shutdown.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        SessionServerStats stats = server.stats();
+        if (config.verbose && stats.served != reported_served) {
+            reported_served = stats.served;
+            DecodeSchedulerStats scheduler = server.schedulerStats();
+            std::cout << "📈 Sessions: " << stats.active << " active, " << stats.served << " served, "
+                      << stats.rejected << " rejected; decode wait " << std::fixed << std::setprecision(0)
+                      << scheduler.mean_wait_ms << "ms mean, " << scheduler.max_wait_ms << "ms max; "
+                      << residentMemoryBytes() / (1024 * 1024) << " MiB resident" << std::defaultfloat << std::endl;
+            printDecodeWaits(scheduler);
+        }
+    }
+    
+    std::cout << "\n🛑 Shutting down..." << std::endl;
+    server.stop();
+    SessionServerStats stats = server.stats();
+    DecodeSchedulerStats scheduler = server.schedulerStats();
+    std::cout << "✅ Served " << stats.served << " sessions (" << stats.rejected << " rejected), "
+              << scheduler.steps << " decodes in " << std::fixed << std::setprecision(1) << scheduler.busy_s
+              << "s of worker time" << std::defaultfloat << std::endl;
+    printDecodeWaits(scheduler);
+    if (stats.first_session_bytes > 0 || stats.measured_sessions > 0) {
+        std::cout << "🧮 Session memory: first +" << stats.first_session_bytes / (1024 * 1024)
+                  << " MiB, each additional +" << stats.session_bytes / (1024 * 1024) << " MiB (mean of "
+                  << stats.measured_sessions << " set up alone)" << std::endl;
+    }
+    return 0;
+}
+
+bool parseVadMode(const std::string& name, VadMode& mode) {
+    if (name == "energy") {
+        mode = VadMode::Energy;
+    } else if (name == "spectral") {
+        mode = VadMode::Spectral;
+    } else if (name == "whisper") {
+        mode = VadMode::Whisper;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Reads the one setting the config file drives, performance.ring_buffer_size;
+// the other keys only document defaults. False when the file cannot be read
+// or the value is not a number.
+bool loadConfig(const std::string& config_file, AppConfig& config) {
+    std::ifstream file(config_file);
+    if (!file) {
+        return false;
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    const std::string json = contents.str();
+    
+    size_t section = json.find("\"performance\"");
+    size_t open = section == std::string::npos ? std::string::npos : json.find('{', section);
+    if (open == std::string::npos) {
+        return true;
+    }
+    size_t close = json.find('}', open);
+    size_t key = json.find("\"ring_buffer_size\"", open);
+    if (key == std::string::npos || key > close) {
+        return true;
+    }
+    size_t colon = json.find(':', key);
+    try {
+        config.ring_buffer_size = std::max(1024, std::stoi(json.substr(colon + 1, close - colon - 1)));
+    } catch (const std::exception&) {
+        std::cerr << "⚠️ performance.ring_buffer_size in " << config_file << " is not a number" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool parseQueuePolicy(const std::string& name, QueueOverflowPolicy& policy) {
+    if (name == "block") {
+        policy = QueueOverflowPolicy::Block;
+    } else if (name == "drop-oldest") {
+        policy = QueueOverflowPolicy::DropOldest;
+    } else if (name == "drop-newest") {
+        policy = QueueOverflowPolicy::DropNewest;
+    } else if (name == "coalesce") {
+        policy = QueueOverflowPolicy::Coalesce;
+    } else {
+        return false;
+    }
+    return true;
 }
 
 void printUsage(const char* program) {
@@ -451,7 +865,38 @@ void printUsage(const char* program) {
     std::cout << "  --no-timestamps         Disable timestamps in output\n";
     std::cout << "  --no-vad                Disable voice activity detection\n";
     std::cout << "  --vad-threshold FLOAT   VAD threshold 0.0-1.0 (default: 0.6)\n";
+    std::cout << "  --vad-mode MODE         energy, spectral (also rejects typing, fans and music),\n";
+    std::cout << "                          or whisper (whisper.cpp's Silero VAD) (default: energy)\n";
+    std::cout << "  --vad-model PATH        Silero model for --vad-mode whisper\n";
+    std::cout << "                          (default: models/ggml-silero-v5.1.2.bin)\n";
     std::cout << "  --threads N             Number of threads (default: 4)\n";
+    std::cout << "  --no-warmup             Skip the startup decode that readies the model\n";
+    std::cout << "  --read-block-size BYTES Pipe read size 4096-65536 (default: 16384)\n";
+    std::cout << "  --ring-size SAMPLES     Audio buffered between pipe reader and chunker\n";
+    std::cout << "                          (default: performance.ring_buffer_size, 16384)\n";
+    std::cout << "  --raw-pipe              Headerless pipe instead of framed audio\n";
+    std::cout << "  --s16                   Send 16-bit PCM over the pipe instead of float32\n";
+    std::cout << "  --transport pipe|shm    Audio transport from the producer (default: pipe)\n";
+    std::cout << "  --source SPEC           Pipe audio from cmd:COMMAND (stdout, or {pipe} for a FIFO path),\n";
+    std::cout << "                          fifo:PATH, file:PATH or - for stdin\n";
+    std::cout << "                          (default: cmd:./audio_capture --pipe {pipe})\n";
+    std::cout << "  --no-restart            Let a source command that exits end the session\n";
+    std::cout << "  -i, --input FILE        Transcribe a WAV file offline instead of live capture\n";
+    std::cout << "  --parallel N            Offline decoders sharing one model (default: cores / threads)\n";
+    std::cout << "  --serve SOCKET          Run as a daemon serving audio sessions on a Unix socket\n";
+    std::cout << "  --max-sessions N        Concurrent sessions the daemon accepts (default: 32)\n";
+    std::cout << "  --decode-workers N      Daemon decodes running at once (default: cores / threads)\n";
+    std::cout << "  --priority CLASS        Sessions' class unless they pick one: live, near-live, batch\n";
+    std::cout << "                          (default: live)\n";
+    std::cout << "  --latency-slo MS        Their chunk deadline (default: 3000 live, 15000 near-live)\n";
+    std::cout << "  --no-edge-trim          Decode chunks with their quiet edges\n";
+    std::cout << "  --edge-guard MS         Quiet audio kept next to trimmed speech (default: 200)\n";
+    std::cout << "  --partials              Stream unconfirmed words as they are heard (live input)\n";
+    std::cout << "  --partial-interval MS   Audio between partial updates (default: 500)\n";
+    std::cout << "  --adaptive-chunks       Resize smart chunks from measured decode speed\n";
+    std::cout << "  --target-latency MS     Latency adaptive chunks aim for (default: 8000)\n";
+    std::cout << "  --queue-policy POLICY   On overload: block, drop-oldest, drop-newest, coalesce\n";
+    std::cout << "                          (default: drop-newest)\n";
     std::cout << "  --config FILE           Configuration file (default: config/default.json)\n";
     std::cout << "  -v, --verbose           Verbose output\n";
     std::cout << "  -h, --help              Show this help message\n";
@@ -459,10 +904,15 @@ void printUsage(const char* program) {
     std::cout << "  " << program << " -o meeting.txt\n";
     std::cout << "  " << program << " -m models/ggml-small.en.bin --save-audio\n";
     std::cout << "  " << program << " -l es --translate --vad-threshold 0.7\n";
+    std::cout << "  " << program << " -i interview.wav -o interview.txt --parallel 4\n";
+    std::cout << "  " << program << " --serve /tmp/transcriber.sock --threads 2\n";
+    std::cout << "  " << program << " --raw-pipe --s16 --source 'cmd:arecord -q -f S16_LE -r 16000 -c 1 -t raw'\n";
 }
 
 int main(int argc, char** argv) {
-    AppConfig config = loadConfig("config/default.json");
+    AppConfig config;
+    loadConfig("config/default.json", config);
+    int ring_size = 0;  // --ring-size, applied over any config file whatever the order
     
     static struct option long_options[] = {
         {"output", required_argument, 0, 'o'},
@@ -474,6 +924,30 @@ int main(int argc, char** argv) {
         {"no-vad", no_argument, 0, 'V'},
         {"vad-threshold", required_argument, 0, 1001},
         {"threads", required_argument, 0, 1002},
+        {"read-block-size", required_argument, 0, 1003},
+        {"queue-policy", required_argument, 0, 1004},
+        {"raw-pipe", no_argument, 0, 1005},
+        {"s16", no_argument, 0, 1006},
+        {"transport", required_argument, 0, 1007},
+        {"input", required_argument, 0, 'i'},
+        {"parallel", required_argument, 0, 1008},
+        {"vad-mode", required_argument, 0, 1009},
+        {"vad-model", required_argument, 0, 1010},
+        {"adaptive-chunks", no_argument, 0, 1011},
+        {"target-latency", required_argument, 0, 1012},
+        {"partials", no_argument, 0, 1013},
+        {"no-edge-trim", no_argument, 0, 1015},
+        {"partial-interval", required_argument, 0, 1014},
+        {"source", required_argument, 0, 1016},
+        {"no-warmup", no_argument, 0, 1017},
+        {"serve", required_argument, 0, 1018},
+        {"max-sessions", required_argument, 0, 1019},
+        {"decode-workers", required_argument, 0, 1020},
+        {"priority", required_argument, 0, 1021},
+        {"latency-slo", required_argument, 0, 1022},
+        {"ring-size", required_argument, 0, 1023},
+        {"edge-guard", required_argument, 0, 1024},
+        {"no-restart", no_argument, 0, 1025},
         {"config", required_argument, 0, 'c'},
         {"verbose", no_argument, 0, 'v'},
         {"help", no_argument, 0, 'h'},
@@ -483,7 +957,7 @@ int main(int argc, char** argv) {
     int c;
     int option_index = 0;
     
-    while ((c = getopt_long(argc, argv, "o:m:l:tsTVc:vh", long_options, &option_index)) != -1) {
+    while ((c = getopt_long(argc, argv, "o:m:l:tsTVi:c:vh", long_options, &option_index)) != -1) {
         switch (c) {
             case 'o':
                 config.output_file = optarg;
@@ -512,8 +986,106 @@ int main(int argc, char** argv) {
             case 1002:
                 config.threads = std::stoi(optarg);
                 break;
+            case 1003:
+                config.read_block_bytes = std::stoi(optarg);
+                break;
+            case 1004:
+                if (!parseQueuePolicy(optarg, config.queue_policy)) {
+                    std::cerr << "❌ Unknown queue policy: " << optarg << std::endl;
+                    return 1;
+                }
+                break;
+            case 1005:
+                config.framed_input = false;
+                break;
+            case 1006:
+                config.s16_input = true;
+                break;
+            case 1007:
+                if (std::string(optarg) == "shm") {
+                    config.transport = AudioTransport::SharedMemory;
+                } else if (std::string(optarg) == "pipe") {
+                    config.transport = AudioTransport::Pipe;
+                } else {
+                    std::cerr << "❌ Unknown transport: " << optarg << std::endl;
+                    return 1;
+                }
+                break;
+            case 'i':
+                config.input_file = optarg;
+                break;
+            case 1008:
+                config.parallel_decoders = std::stoi(optarg);
+                break;
+            case 1009:
+                if (!parseVadMode(optarg, config.vad_mode)) {
+                    std::cerr << "❌ Unknown VAD mode: " << optarg << std::endl;
+                    return 1;
+                }
+                break;
+            case 1010:
+                config.vad_model_path = optarg;
+                break;
+            case 1011:
+                config.adaptive_chunking = true;
+                break;
+            case 1012:
+                config.target_latency_ms = std::stoi(optarg);
+                config.adaptive_chunking = true;
+                break;
+            case 1013:
+                config.streaming_partials = true;
+                break;
+            case 1015:
+                config.trim_edges = false;
+                break;
+            case 1014:
+                config.partial_interval_ms = std::max(100, std::stoi(optarg));
+                config.streaming_partials = true;
+                break;
+            case 1016: {
+                PcmSourceConfig source_config;
+                if (!parsePcmSource(optarg, source_config)) {
+                    std::cerr << "❌ Unknown audio source: " << optarg << " (use cmd:, fifo:, file: or -)" << std::endl;
+                    return 1;
+                }
+                config.source = optarg;
+                break;
+            }
+            case 1017:
+                config.warmup = false;
+                break;
+            case 1018:
+                config.serve_socket = optarg;
+                break;
+            case 1019:
+                config.max_sessions = std::max(1, std::stoi(optarg));
+                break;
+            case 1020:
+                config.decode_workers = std::stoi(optarg);
+                break;
+            case 1021:
+                if (!parseDecodePriority(optarg, config.decode_priority)) {
+                    std::cerr << "❌ Unknown priority: " << optarg << " (use live, near-live or batch)" << std::endl;
+                    return 1;
+                }
+                break;
+            case 1022:
+                config.latency_slo_ms = std::max(0, std::stoi(optarg));
+                break;
+            case 1023:
+                ring_size = std::max(1024, std::stoi(optarg));
+                break;
+            case 1024:
+                config.edge_guard_ms = std::max(0, std::stoi(optarg));
+                break;
+            case 1025:
+                config.restart_source = false;
+                break;
             case 'c':
-                config = loadConfig(optarg);
+                if (!loadConfig(optarg, config)) {
+                    std::cerr << "⚠️ Could not read config file " << optarg << std::endl;
+                }
                 break;
             case 'v':
                 config.verbose = true;
@@ -526,8 +1098,15 @@ int main(int argc, char** argv) {
                 return 1;
         }
     }
+    if (ring_size > 0) {
+        config.ring_buffer_size = ring_size;
+    }
     
     try {
+        if (!config.serve_socket.empty()) {
+            return runServer(config);
+        }
+        
         RealTimeTranscriptionApp app(config);
         
         if (!app.initialize()) {
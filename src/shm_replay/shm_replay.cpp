@@ -0,0 +1,149 @@
+// shm_replay - replays a WAV file into a transcriber's shared memory ring.
+//
+// Lets the shared memory transport be exercised on Linux without the macOS
+// capture tool:
+//   ./transcriber --transport shm -v            # prints the ring name
+//   ./shm_replay --ring /audio_transcriber_123 meeting.wav
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <getopt.h>
+#include "transcriber/shm_ring.h"
+#include "transcriber/wav_file.h"
+#include "transcriber/resampler.h"
+
+namespace {
+
+constexpr double BLOCK_SECONDS = 0.1;
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " --ring NAME [options] FILE.wav\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --ring NAME     Shared memory ring created by the transcriber\n";
+    std::cout << "  --realtime      Pace writes at the file's sample rate (drop on overflow)\n";
+    std::cout << "  --loop          Replay the file until interrupted\n";
+    std::cout << "  --keep-open     Leave the stream open for another replay instead of ending it\n";
+    std::cout << "  -h, --help      Show this help message\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string ring_name;
+    bool realtime = false;
+    bool loop = false;
+    bool keep_open = false;
+
+    static struct option long_options[] = {
+        {"ring", required_argument, 0, 'r'},
+        {"realtime", no_argument, 0, 'R'},
+        {"loop", no_argument, 0, 'l'},
+        {"keep-open", no_argument, 0, 'k'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "r:Rlkh", long_options, nullptr)) != -1) {
+        switch (c) {
+            case 'r':
+                ring_name = optarg;
+                break;
+            case 'R':
+                realtime = true;
+                break;
+            case 'l':
+                loop = true;
+                break;
+            case 'k':
+                keep_open = true;
+                break;
+            case 'h':
+                printUsage(argv[0]);
+                return 0;
+            default:
+                printUsage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (ring_name.empty() || optind >= argc) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    WavFile wav;
+    if (!wav.open(argv[optind])) {
+        return 1;
+    }
+
+    ShmAudioRing ring;
+    if (!ring.attach(ring_name)) {
+        return 1;
+    }
+
+    std::cout << "▶️ Replaying " << argv[optind] << " (" << wav.frames() / double(wav.sampleRate())
+              << "s) into " << ring_name << std::endl;
+    if (wav.sampleRate() != ring.sampleRate() || wav.channels() != 1) {
+        std::cout << "🔄 Converting " << wav.channels() << "-channel " << wav.sampleRate() << "Hz to mono "
+                  << ring.sampleRate() << "Hz" << std::endl;
+    }
+
+    // Blocks are 100ms of the file; each is downmixed and resampled to the ring's rate
+    const size_t block_frames = static_cast<size_t>(wav.sampleRate() * BLOCK_SECONDS);
+    std::vector<float> mono(block_frames);
+    std::vector<float> block;
+    PolyphaseResampler resampler(wav.sampleRate(), ring.sampleRate());
+    const auto block_duration = std::chrono::microseconds(static_cast<int64_t>(BLOCK_SECONDS * 1000000));
+    auto next_write = std::chrono::steady_clock::now();
+    uint64_t dropped = 0;
+
+    do {
+        for (size_t offset = 0; offset < wav.frames(); offset += block_frames) {
+            size_t frames = wav.readMono(offset, mono.data(), block_frames);
+            block.clear();
+            resampler.process(mono.data(), frames, block);
+            if (offset + frames >= wav.frames()) {
+                resampler.flush(block);
+            }
+            size_t count = block.size();
+
+            if (realtime) {
+                std::this_thread::sleep_until(next_write);
+                next_write += block_duration;
+
+                size_t written = ring.write(block.data(), count);
+                if (written < count) {
+                    ring.addDropped(count - written);
+                    dropped += count - written;
+                }
+            } else {
+                // As fast as the consumer allows
+                size_t written = 0;
+                while (written < count) {
+                    written += ring.write(block.data() + written, count - written);
+                    if (written < count) {
+                        ring.waitForSpace(100);
+                    }
+                }
+            }
+        }
+    } while (loop);
+
+    // Ending the stream lets the transcriber chunk the tail and finish
+    if (keep_open) {
+        ring.close();
+    } else {
+        ring.endStream();
+    }
+
+    std::cout << "✅ Replay finished";
+    if (dropped > 0) {
+        std::cout << " (" << dropped << " samples dropped)";
+    }
+    std::cout << std::endl;
+    return 0;
+}
@@ -0,0 +1,315 @@
+#include "audio_energy.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AUDIO_ENERGY_X86 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define AUDIO_ENERGY_NEON 1
+#endif
+
+namespace {
+
+float sumOfSquaresScalar(const float* x, size_t count) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        sum += x[i] * x[i];
+    }
+    return sum;
+}
+
+float maxAbsScalar(const float* x, size_t count) {
+    float peak = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        peak = std::max(peak, std::abs(x[i]));
+    }
+    return peak;
+}
+
+size_t countAboveScalar(const float* x, size_t count, float threshold) {
+    size_t above = 0;
+    for (size_t i = 0; i < count; i++) {
+        above += std::abs(x[i]) > threshold ? 1 : 0;
+    }
+    return above;
+}
+
+#ifdef AUDIO_ENERGY_X86
+// Clearing the sign bit gives |x| without a branch
+inline __m128 absSse(__m128 v) {
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+inline float horizontalSum(__m128 v) {
+    float lanes[4];
+    _mm_storeu_ps(lanes, v);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+float sumOfSquaresSse2(const float* x, size_t count) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_loadu_ps(x + i);
+        __m128 b = _mm_loadu_ps(x + i + 4);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(a, a));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(b, b));
+    }
+    return horizontalSum(_mm_add_ps(acc0, acc1)) + sumOfSquaresScalar(x + i, count - i);
+}
+
+float maxAbsSse2(const float* x, size_t count) {
+    // Two chains hide the latency of max
+    __m128 peak0 = _mm_setzero_ps();
+    __m128 peak1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        peak0 = _mm_max_ps(peak0, absSse(_mm_loadu_ps(x + i)));
+        peak1 = _mm_max_ps(peak1, absSse(_mm_loadu_ps(x + i + 4)));
+    }
+    __m128 peak = _mm_max_ps(peak0, peak1);
+    float lanes[4];
+    _mm_storeu_ps(lanes, peak);
+    float tail = maxAbsScalar(x + i, count - i);
+    return std::max({lanes[0], lanes[1], lanes[2], lanes[3], tail});
+}
+
+size_t countAboveSse2(const float* x, size_t count, float threshold) {
+    const __m128 limit = _mm_set1_ps(threshold);
+    __m128i above = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // A true compare is all ones (-1), so subtracting it counts
+        __m128 mask = _mm_cmpgt_ps(absSse(_mm_loadu_ps(x + i)), limit);
+        above = _mm_sub_epi32(above, _mm_castps_si128(mask));
+    }
+    alignas(16) uint32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), above);
+    return size_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3] + countAboveScalar(x + i, count - i, threshold);
+}
+
+// The AVX paths finish their tails inline rather than in the SSE2 versions:
+// mixing legacy SSE code into AVX state costs more than the tail itself
+__attribute__((target("avx2,fma")))
+float sumOfSquaresAvx2(const float* x, size_t count) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256 a = _mm256_loadu_ps(x + i);
+        __m256 b = _mm256_loadu_ps(x + i + 8);
+        acc0 = _mm256_fmadd_ps(a, a, acc0);
+        acc1 = _mm256_fmadd_ps(b, b, acc1);
+    }
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    float lanes[4];
+    _mm_storeu_ps(lanes, sum);
+    float tail = 0.0f;
+    for (; i < count; i++) {
+        tail += x[i] * x[i];
+    }
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + tail;
+}
+
+__attribute__((target("avx2")))
+float maxAbsAvx2(const float* x, size_t count) {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 peak0 = _mm256_setzero_ps();
+    __m256 peak1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        peak0 = _mm256_max_ps(peak0, _mm256_andnot_ps(sign, _mm256_loadu_ps(x + i)));
+        peak1 = _mm256_max_ps(peak1, _mm256_andnot_ps(sign, _mm256_loadu_ps(x + i + 8)));
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, _mm256_max_ps(peak0, peak1));
+    float result = 0.0f;
+    for (float lane : lanes) {
+        result = std::max(result, lane);
+    }
+    for (; i < count; i++) {
+        result = std::max(result, std::abs(x[i]));
+    }
+    return result;
+}
+
+__attribute__((target("avx2")))
+size_t countAboveAvx2(const float* x, size_t count, float threshold) {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 limit = _mm256_set1_ps(threshold);
+    __m256i above = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 mask = _mm256_cmp_ps(_mm256_andnot_ps(sign, _mm256_loadu_ps(x + i)), limit, _CMP_GT_OQ);
+        above = _mm256_sub_epi32(above, _mm256_castps_si256(mask));
+    }
+    alignas(32) uint32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), above);
+    size_t result = 0;
+    for (uint32_t lane : lanes) {
+        result += lane;
+    }
+    for (; i < count; i++) {
+        result += std::abs(x[i]) > threshold ? 1 : 0;
+    }
+    return result;
+}
+
+// AVX-512 handles the tail with a masked load, so there is no scalar loop
+__attribute__((target("avx512f")))
+float sumOfSquaresAvx512(const float* x, size_t count) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m512 a = _mm512_loadu_ps(x + i);
+        __m512 b = _mm512_loadu_ps(x + i + 16);
+        acc0 = _mm512_fmadd_ps(a, a, acc0);
+        acc1 = _mm512_fmadd_ps(b, b, acc1);
+    }
+    for (; i < count; i += 16) {
+        __mmask16 mask = count - i >= 16 ? 0xFFFF : __mmask16((1u << (count - i)) - 1);
+        __m512 a = _mm512_maskz_loadu_ps(mask, x + i);
+        acc0 = _mm512_fmadd_ps(a, a, acc0);
+    }
+    float lanes[16];
+    _mm512_storeu_ps(lanes, _mm512_add_ps(acc0, acc1));
+    float sum = 0.0f;
+    for (float lane : lanes) {
+        sum += lane;
+    }
+    return sum;
+}
+
+__attribute__((target("avx512f")))
+float maxAbsAvx512(const float* x, size_t count) {
+    // maskz_max with a full mask is plain max; the unmasked intrinsic trips a
+    // spurious -Wmaybe-uninitialized in some GCC versions
+    __m512 peak0 = _mm512_setzero_ps();
+    __m512 peak1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        peak0 = _mm512_maskz_max_ps(0xFFFF, peak0, _mm512_abs_ps(_mm512_loadu_ps(x + i)));
+        peak1 = _mm512_maskz_max_ps(0xFFFF, peak1, _mm512_abs_ps(_mm512_loadu_ps(x + i + 16)));
+    }
+    for (; i < count; i += 16) {
+        __mmask16 mask = count - i >= 16 ? 0xFFFF : __mmask16((1u << (count - i)) - 1);
+        peak0 = _mm512_maskz_max_ps(0xFFFF, peak0, _mm512_abs_ps(_mm512_maskz_loadu_ps(mask, x + i)));
+    }
+    float lanes[16];
+    _mm512_storeu_ps(lanes, _mm512_maskz_max_ps(0xFFFF, peak0, peak1));
+    float result = 0.0f;
+    for (float lane : lanes) {
+        result = std::max(result, lane);
+    }
+    return result;
+}
+
+__attribute__((target("avx512f,popcnt")))
+size_t countAboveAvx512(const float* x, size_t count, float threshold) {
+    const __m512 limit = _mm512_set1_ps(threshold);
+    size_t above = 0;
+    for (size_t i = 0; i < count; i += 16) {
+        __mmask16 mask = count - i >= 16 ? 0xFFFF : __mmask16((1u << (count - i)) - 1);
+        __m512 v = _mm512_abs_ps(_mm512_maskz_loadu_ps(mask, x + i));
+        above += _mm_popcnt_u32(_mm512_mask_cmp_ps_mask(mask, v, limit, _CMP_GT_OQ));
+    }
+    return above;
+}
+#endif
+
+#ifdef AUDIO_ENERGY_NEON
+float sumOfSquaresNeon(const float* x, size_t count) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        float32x4_t a = vld1q_f32(x + i);
+        float32x4_t b = vld1q_f32(x + i + 4);
+        acc0 = vmlaq_f32(acc0, a, a);
+        acc1 = vmlaq_f32(acc1, b, b);
+    }
+    float32x4_t acc = vaddq_f32(acc0, acc1);
+    float sum = vgetq_lane_f32(acc, 0) + vgetq_lane_f32(acc, 1) +
+                vgetq_lane_f32(acc, 2) + vgetq_lane_f32(acc, 3);
+    return sum + sumOfSquaresScalar(x + i, count - i);
+}
+
+float maxAbsNeon(const float* x, size_t count) {
+    float32x4_t peak0 = vdupq_n_f32(0.0f);
+    float32x4_t peak1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        peak0 = vmaxq_f32(peak0, vabsq_f32(vld1q_f32(x + i)));
+        peak1 = vmaxq_f32(peak1, vabsq_f32(vld1q_f32(x + i + 4)));
+    }
+    float32x4_t peak = vmaxq_f32(peak0, peak1);
+    float tail = maxAbsScalar(x + i, count - i);
+    return std::max({vgetq_lane_f32(peak, 0), vgetq_lane_f32(peak, 1),
+                     vgetq_lane_f32(peak, 2), vgetq_lane_f32(peak, 3), tail});
+}
+
+size_t countAboveNeon(const float* x, size_t count, float threshold) {
+    const float32x4_t limit = vdupq_n_f32(threshold);
+    uint32x4_t above = vdupq_n_u32(0);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // A true compare is all ones, so subtracting it counts
+        above = vsubq_u32(above, vcgtq_f32(vabsq_f32(vld1q_f32(x + i)), limit));
+    }
+    return size_t(vgetq_lane_u32(above, 0)) + vgetq_lane_u32(above, 1) +
+           vgetq_lane_u32(above, 2) + vgetq_lane_u32(above, 3) +
+           countAboveScalar(x + i, count - i, threshold);
+}
+#endif
+
+std::vector<EnergyKernels> detectKernels() {
+    std::vector<EnergyKernels> kernels = {{"scalar", sumOfSquaresScalar, maxAbsScalar, countAboveScalar}};
+#ifdef AUDIO_ENERGY_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        kernels.push_back({"sse2", sumOfSquaresSse2, maxAbsSse2, countAboveSse2});
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        kernels.push_back({"avx2", sumOfSquaresAvx2, maxAbsAvx2, countAboveAvx2});
+    }
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("popcnt")) {
+        kernels.push_back({"avx512", sumOfSquaresAvx512, maxAbsAvx512, countAboveAvx512});
+    }
+#elif defined(AUDIO_ENERGY_NEON)
+    kernels.push_back({"neon", sumOfSquaresNeon, maxAbsNeon, countAboveNeon});
+#endif
+    return kernels;
+}
+
+const EnergyKernels& impl() {
+    static const EnergyKernels selected = detectKernels().back();
+    return selected;
+}
+
+} // namespace
+
+float energySumOfSquares(const float* samples, size_t count) {
+    return impl().sum_of_squares(samples, count);
+}
+
+float energyMaxAbs(const float* samples, size_t count) {
+    return impl().max_abs(samples, count);
+}
+
+size_t energyCountAbove(const float* samples, size_t count, float threshold) {
+    return impl().count_above(samples, count, threshold);
+}
+
+const char* energyKernelIsa() {
+    return impl().isa;
+}
+
+std::vector<EnergyKernels> supportedEnergyKernels() {
+    return detectKernels();
+}
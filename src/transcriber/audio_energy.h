@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Energy kernels for voice activity and silence detection. The implementation
+// (AVX-512, AVX2, SSE2, NEON or scalar) is picked once at startup from the
+// CPU's capabilities.
+
+// Sum of x^2, for RMS energy
+float energySumOfSquares(const float* samples, size_t count);
+
+// Largest |x|; 0 for an empty range
+float energyMaxAbs(const float* samples, size_t count);
+
+// Number of samples whose magnitude crosses the threshold (|x| > threshold)
+size_t energyCountAbove(const float* samples, size_t count, float threshold);
+
+// Name of the selected implementation, for diagnostics
+const char* energyKernelIsa();
+
+struct EnergyKernels {
+    const char* isa;
+    float (*sum_of_squares)(const float*, size_t);
+    float (*max_abs)(const float*, size_t);
+    size_t (*count_above)(const float*, size_t, float);
+};
+
+// Every implementation this CPU can run, scalar reference first and the
+// selected one last (for verification and benchmarks)
+std::vector<EnergyKernels> supportedEnergyKernels();
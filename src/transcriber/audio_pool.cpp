@@ -0,0 +1,144 @@
+#include "audio_pool.h"
+#include <algorithm>
+#include <cstring>
+
+// Audio Block Pool Implementation
+void releaseSampleBlock(SampleBlock* block) {
+    if (block->pool) {
+        block->pool->release(block);
+    } else {
+        delete block;
+    }
+}
+
+AudioBlockPool::~AudioBlockPool() {
+    for (SampleBlock* block : blocks_) {
+        if (block->refs.load(std::memory_order_acquire) == 0) {
+            delete block;
+        } else {
+            block->pool = nullptr;
+        }
+    }
+}
+
+SampleBlockPtr AudioBlockPool::acquire() {
+    SampleBlock* block;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_list_) {
+            block = free_list_;
+            free_list_ = block->next_free;
+            stats_.blocks_reused++;
+        } else {
+            block = new SampleBlock();
+            block->pool = this;
+            blocks_.push_back(block);
+            stats_.blocks_allocated++;
+        }
+        stats_.blocks_in_use++;
+        stats_.peak_blocks_in_use = std::max(stats_.peak_blocks_in_use, stats_.blocks_in_use);
+    }
+    return SampleBlockPtr(block);
+}
+
+void AudioBlockPool::reserve(size_t blocks) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = blocks_.size(); i < blocks; i++) {
+        SampleBlock* block = new SampleBlock();
+        block->pool = this;
+        block->next_free = free_list_;
+        free_list_ = block;
+        blocks_.push_back(block);
+        stats_.blocks_allocated++;
+    }
+}
+
+void AudioBlockPool::release(SampleBlock* block) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    block->next_free = free_list_;
+    free_list_ = block;
+    stats_.blocks_in_use--;
+}
+
+AudioPoolStats AudioBlockPool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+// Sample Buffer Implementation
+SampleBuffer::SampleBuffer(AudioBlockPool& pool)
+    : pool_(&pool) {
+}
+
+void SampleBuffer::append(const float* samples, size_t count) {
+    while (count > 0) {
+        size_t end = head_offset_ + size_;
+        if (end == blocks_ * SAMPLE_BLOCK_SIZE) {
+            if (blocks_ == ring_.size()) {
+                // Unroll into a larger ring, oldest block first
+                std::vector<SampleBlockPtr> grown(std::max<size_t>(ring_.size() * 2, 8));
+                for (size_t i = 0; i < blocks_; i++) {
+                    grown[i] = std::move(ring_[(first_ + i) % ring_.size()]);
+                }
+                ring_ = std::move(grown);
+                first_ = 0;
+            }
+            ring_[(first_ + blocks_) % ring_.size()] = pool_->acquire();
+            blocks_++;
+        }
+
+        // Only the unused tail of the last block is written; views already
+        // handed out never cover it
+        size_t fill = end - (blocks_ - 1) * SAMPLE_BLOCK_SIZE;
+        size_t n = std::min(count, SAMPLE_BLOCK_SIZE - fill);
+        std::memcpy(block(blocks_ - 1).data() + fill, samples, n * sizeof(float));
+        size_ += n;
+        samples += n;
+        count -= n;
+    }
+}
+
+void SampleBuffer::consume(size_t count) {
+    count = std::min(count, size_);
+    head_offset_ += count;
+    size_ -= count;
+    while (head_offset_ >= SAMPLE_BLOCK_SIZE && blocks_ > 0) {
+        ring_[first_].reset();
+        first_ = (first_ + 1) % ring_.size();
+        blocks_--;
+        head_offset_ -= SAMPLE_BLOCK_SIZE;
+    }
+}
+
+void SampleBuffer::clear() {
+    for (SampleBlockPtr& entry : ring_) {
+        entry.reset();
+    }
+    first_ = 0;
+    blocks_ = 0;
+    head_offset_ = 0;
+    size_ = 0;
+}
+
+size_t SampleBuffer::contiguous(size_t offset, const float** data) const {
+    if (offset >= size_) {
+        return 0;
+    }
+    size_t position = head_offset_ + offset;
+    size_t within = position % SAMPLE_BLOCK_SIZE;
+    *data = block(position / SAMPLE_BLOCK_SIZE).data() + within;
+    return std::min(SAMPLE_BLOCK_SIZE - within, size_ - offset);
+}
+
+void SampleBuffer::view(size_t offset, size_t count, SampleSpan& out) const {
+    out.clear();
+    count = offset < size_ ? std::min(count, size_ - offset) : 0;
+    size_t position = head_offset_ + offset;
+    while (count > 0) {
+        size_t within = position % SAMPLE_BLOCK_SIZE;
+        size_t n = std::min(count, SAMPLE_BLOCK_SIZE - within);
+        out.append(block(position / SAMPLE_BLOCK_SIZE), within, n);
+        position += n;
+        count -= n;
+    }
+}
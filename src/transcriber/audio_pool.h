@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "sample_span.h"
+
+struct AudioPoolStats {
+    uint64_t blocks_allocated = 0;   // Heap allocations (warmup and growth only)
+    uint64_t blocks_reused = 0;      // Acquires served from the free list
+    uint64_t blocks_in_use = 0;
+    uint64_t peak_blocks_in_use = 0;
+};
+
+// Per-session pool of 64-byte aligned sample blocks. A block goes back on the
+// free list when its last SampleBlockPtr is dropped, on whichever thread that
+// happens, so once the pipeline has seen its largest chunk every acquire is
+// served without touching the heap. The pool must outlive the blocks it hands
+// out; any still referenced when it is destroyed are freed by their last user.
+class AudioBlockPool {
+public:
+    AudioBlockPool() = default;
+    ~AudioBlockPool();
+
+    AudioBlockPool(const AudioBlockPool&) = delete;
+    AudioBlockPool& operator=(const AudioBlockPool&) = delete;
+
+    SampleBlockPtr acquire();
+    // Preallocates blocks onto the free list
+    void reserve(size_t blocks);
+
+    AudioPoolStats stats() const;
+
+private:
+    friend void releaseSampleBlock(SampleBlock* block);
+    void release(SampleBlock* block);
+
+    mutable std::mutex mutex_;
+    SampleBlock* free_list_ = nullptr;
+    std::vector<SampleBlock*> blocks_;  // Every block this pool allocated
+    AudioPoolStats stats_;
+};
+
+// FIFO of samples in pooled blocks. Appends copy into the tail block;
+// consuming from the front only advances an offset and drops whole blocks, so
+// views already handed out keep their blocks and nothing is moved. The block
+// ring grows only when a longer backlog than ever before is buffered.
+class SampleBuffer {
+public:
+    explicit SampleBuffer(AudioBlockPool& pool);
+
+    void append(const float* samples, size_t count);
+    void consume(size_t count);
+    void clear();
+
+    // Points data at sample offset; returns how many samples follow it
+    // contiguously (up to the end of its block or of the buffer)
+    size_t contiguous(size_t offset, const float** data) const;
+    // Replaces out with a view of count samples starting at offset
+    void view(size_t offset, size_t count, SampleSpan& out) const;
+
+    size_t size() const { return size_; }
+
+private:
+    const SampleBlockPtr& block(size_t index) const { return ring_[(first_ + index) % ring_.size()]; }
+
+    AudioBlockPool* pool_;
+    std::vector<SampleBlockPtr> ring_;  // Circular; blocks_ entries from first_
+    size_t first_ = 0;
+    size_t blocks_ = 0;
+    size_t head_offset_ = 0;            // First buffered sample within the first block
+    size_t size_ = 0;
+};
@@ -0,0 +1,146 @@
+#include "chunk_controller.h"
+#include "transcriber.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr double SAMPLE_RATE = 16000.0;
+constexpr double FORGETTING = 0.9;       // Weight kept by older decodes per new one
+constexpr double MAX_UTILISATION = 0.8;  // Decoder busy share the floor allows
+constexpr double MAX_STEP = 0.25;        // Largest relative change per decode
+constexpr double MIN_CHANGE = 0.05;      // Smaller moves are not applied
+constexpr uint64_t WARMUP_DECODES = 3;
+
+} // namespace
+
+const char* chunkSizingReasonName(ChunkSizingReason reason) {
+    switch (reason) {
+        case ChunkSizingReason::Initial: return "initial";
+        case ChunkSizingReason::Latency: return "latency";
+        case ChunkSizingReason::Throughput: return "throughput";
+        case ChunkSizingReason::Bound: return "bound";
+    }
+    return "unknown";
+}
+
+AdaptiveChunkController::AdaptiveChunkController(const TranscriptionConfig& config)
+    : target_latency_s_(config.target_latency_ms / 1000.0)
+    , base_min_s_(config.min_chunk_duration_ms / 1000.0)
+    , base_optimal_s_(std::max(config.optimal_chunk_duration_ms, 1) / 1000.0)
+    , base_max_s_(config.max_chunk_duration_ms / 1000.0)
+    , hard_max_s_(config.max_chunk_duration_ms / 1000.0) {
+    lowest_optimal_s_ = std::max(config.adaptive_min_optimal_ms, 1000) / 1000.0;
+    highest_optimal_s_ = std::clamp(config.adaptive_max_optimal_ms / 1000.0, lowest_optimal_s_, hard_max_s_);
+    optimal_s_ = base_optimal_s_;
+    stats_.min_chunk_ms = config.min_chunk_duration_ms;
+    stats_.optimal_chunk_ms = config.optimal_chunk_duration_ms;
+    stats_.max_chunk_ms = config.max_chunk_duration_ms;
+}
+
+void AdaptiveChunkController::recordDecode(size_t audio_samples, double queue_wait_s, double decode_s,
+                                           size_t queue_depth) {
+    double x = audio_samples / SAMPLE_RATE;
+    if (x <= 0.0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    weight_ = weight_ * FORGETTING + 1.0;
+    sum_x_ = sum_x_ * FORGETTING + x;
+    sum_y_ = sum_y_ * FORGETTING + decode_s;
+    sum_xx_ = sum_xx_ * FORGETTING + x * x;
+    sum_xy_ = sum_xy_ * FORGETTING + x * decode_s;
+
+    stats_.decodes++;
+    stats_.queue_depth = queue_depth;
+    stats_.real_time_factor = sum_y_ / sum_x_;
+    double latency = x + queue_wait_s + decode_s;
+    stats_.measured_latency_s = stats_.decodes == 1
+        ? latency
+        : 0.7 * stats_.measured_latency_s + 0.3 * latency;
+
+    double overhead = 0.0;
+    double cost = 0.0;
+    fit(overhead, cost);
+    stats_.call_overhead_s = overhead;
+    stats_.cost_per_audio_s = cost;
+
+    double backlog = queue_depth * (overhead + cost * optimal_s_);
+    stats_.predicted_latency_s = optimal_s_ + backlog + overhead + cost * optimal_s_;
+    if (stats_.decodes < WARMUP_DECODES) {
+        return;
+    }
+
+    double for_latency = (target_latency_s_ - backlog - overhead) / (1.0 + cost);
+    double for_throughput = cost < MAX_UTILISATION
+        ? overhead / (MAX_UTILISATION - cost)
+        : std::numeric_limits<double>::infinity();
+
+    double wanted = for_latency;
+    ChunkSizingReason reason = ChunkSizingReason::Latency;
+    if (for_throughput > for_latency) {
+        wanted = for_throughput;
+        reason = ChunkSizingReason::Throughput;
+    }
+    if (wanted < lowest_optimal_s_ || wanted > highest_optimal_s_) {
+        wanted = std::clamp(wanted, lowest_optimal_s_, highest_optimal_s_);
+        reason = ChunkSizingReason::Bound;
+    }
+    stats_.reason = reason;
+
+    double next = std::clamp(wanted, optimal_s_ * (1.0 - MAX_STEP), optimal_s_ * (1.0 + MAX_STEP));
+    if (std::abs(next - optimal_s_) >= MIN_CHANGE * optimal_s_) {
+        apply(next);
+    }
+}
+
+void AdaptiveChunkController::durations(int& min_ms, int& optimal_ms, int& max_ms) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    min_ms = stats_.min_chunk_ms;
+    optimal_ms = stats_.optimal_chunk_ms;
+    max_ms = stats_.max_chunk_ms;
+}
+
+ChunkSizingStats AdaptiveChunkController::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void AdaptiveChunkController::fit(double& overhead_s, double& cost_per_s) {
+    // Chunks of nearly one length cannot separate overhead from per-second
+    // cost. Contention slows both alike, so scale the last fit that could
+    // (all per-second before there is one) to the recent mean decode time.
+    double spread = weight_ * sum_xx_ - sum_x_ * sum_x_;
+    if (spread > 0.25 * weight_ * weight_) {
+        cost_per_s = (weight_ * sum_xy_ - sum_x_ * sum_y_) / spread;
+        overhead_s = (sum_y_ - cost_per_s * sum_x_) / weight_;
+        if (overhead_s >= 0.0 && cost_per_s >= 0.0) {
+            fitted_overhead_s_ = overhead_s;
+            fitted_cost_per_s_ = cost_per_s;
+            return;
+        }
+    }
+    double mean_x = sum_x_ / weight_;
+    double mean_y = sum_y_ / weight_;
+    double fitted = fitted_overhead_s_ + fitted_cost_per_s_ * mean_x;
+    if (fitted <= 0.0) {
+        overhead_s = 0.0;
+        cost_per_s = mean_y / mean_x;
+        return;
+    }
+    overhead_s = fitted_overhead_s_ * mean_y / fitted;
+    cost_per_s = fitted_cost_per_s_ * mean_y / fitted;
+}
+
+void AdaptiveChunkController::apply(double optimal_s) {
+    optimal_s_ = optimal_s;
+    double scale = optimal_s / base_optimal_s_;
+    double max_s = std::min(base_max_s_ * scale, hard_max_s_);
+    stats_.optimal_chunk_ms = static_cast<int>(optimal_s * 1000.0);
+    stats_.min_chunk_ms = std::min(static_cast<int>(base_min_s_ * scale * 1000.0), stats_.optimal_chunk_ms);
+    stats_.max_chunk_ms = std::max(static_cast<int>(max_s * 1000.0), stats_.optimal_chunk_ms);
+    stats_.adjustments++;
+    generation_.fetch_add(1, std::memory_order_release);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+struct TranscriptionConfig;
+
+// Why the controller settled on its current chunk length
+enum class ChunkSizingReason {
+    Initial,     // Not enough decodes measured yet
+    Latency,     // Sized to hold the latency target
+    Throughput,  // Latency target out of reach; sized so the queue cannot grow
+    Bound        // Clamped at a configured limit
+};
+
+const char* chunkSizingReasonName(ChunkSizingReason reason);
+
+struct ChunkSizingStats {
+    uint64_t decodes = 0;              // Whisper calls measured
+    uint64_t adjustments = 0;          // Times the chunk lengths changed
+    double real_time_factor = 0.0;     // Decode seconds per audio second, recent calls
+    double call_overhead_s = 0.0;      // Fitted fixed cost of one whisper call
+    double cost_per_audio_s = 0.0;     // Fitted decode seconds per audio second
+    size_t queue_depth = 0;            // Chunks waiting after the last decode
+    double predicted_latency_s = 0.0;  // First word of a chunk of the current length
+    double measured_latency_s = 0.0;   // Same, observed (chunk + queue wait + decode)
+    int min_chunk_ms = 0;
+    int optimal_chunk_ms = 0;
+    int max_chunk_ms = 0;
+    ChunkSizingReason reason = ChunkSizingReason::Initial;
+};
+
+// Moves SmartChunker's min/optimal/max lengths to hold an end-to-end latency
+// target as decode speed changes. Whisper pads every call to its 30 s window,
+// so a call costs a fixed overhead C plus k seconds per audio second; both are
+// fitted by least squares over recent calls (exponentially forgotten). The
+// first word of a chunk of length D waits about
+//     D + backlog + C + k * D
+// which gives the length that meets the target. The decoder only keeps up if
+// (C + k * D) / D stays below a utilisation ceiling, which gives a floor; when
+// the two conflict the floor wins, since a growing queue breaks any target.
+// The optimal length is clamped to its bounds, moves at most 25% per decode,
+// and min/max scale with it (max never past max_chunk_duration_ms).
+//
+// recordDecode() runs on the transcription thread; the chunker polls
+// generation() and reads durations() only when it changes.
+class AdaptiveChunkController {
+public:
+    explicit AdaptiveChunkController(const TranscriptionConfig& config);
+
+    void recordDecode(size_t audio_samples, double queue_wait_s, double decode_s, size_t queue_depth);
+
+    uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+    void durations(int& min_ms, int& optimal_ms, int& max_ms) const;
+    ChunkSizingStats stats() const;
+
+private:
+    double target_latency_s_;
+    double lowest_optimal_s_;
+    double highest_optimal_s_;
+    double base_min_s_;              // Configured lengths the current ones are scaled from
+    double base_optimal_s_;
+    double base_max_s_;
+    double hard_max_s_;
+
+    mutable std::mutex mutex_;
+    std::atomic<uint64_t> generation_{0};
+
+    // Exponentially weighted sums for the fit of decode time on chunk length
+    double weight_ = 0.0;
+    double sum_x_ = 0.0;
+    double sum_y_ = 0.0;
+    double sum_xx_ = 0.0;
+    double sum_xy_ = 0.0;
+    double fitted_overhead_s_ = 0.0;  // Last fit the lengths were spread enough for
+    double fitted_cost_per_s_ = 0.0;
+
+    double optimal_s_;
+    ChunkSizingStats stats_;
+
+    void fit(double& overhead_s, double& cost_per_s);
+    void apply(double optimal_s);
+};
@@ -0,0 +1,143 @@
+#include "chunk_queue.h"
+#include <algorithm>
+
+ChunkQueue::ChunkQueue(size_t capacity, QueueOverflowPolicy policy, size_t max_coalesced_samples)
+    : queue_(capacity)
+    , free_(capacity + 3)  // Queued, held for coalescing, being filled and being decoded
+    , policy_(policy)
+    , max_coalesced_samples_(max_coalesced_samples) {
+}
+
+bool ChunkQueue::push(AudioChunkPtr chunk) {
+    // A held coalesced chunk keeps its place ahead of newer audio
+    flush();
+    if (pending_) {
+        // Skip the part of the new chunk that overlaps the held one. Audio
+        // between them that never came (a chunk gated out, a tail trimmed
+        // off) is filled with silence, so the merged audio still starts at
+        // start_sample and every sample sits at its timeline position.
+        size_t skip = 0;
+        size_t hole = 0;
+        if (pending_->end_sample > chunk->start_sample) {
+            skip = std::min<uint64_t>(pending_->end_sample - chunk->start_sample, chunk->audio.size());
+        } else {
+            hole = chunk->start_sample - pending_->end_sample;
+        }
+        if (pending_->audio.size() + hole + chunk->audio.size() - skip > max_coalesced_samples_) {
+            dropped_newest_.fetch_add(1, std::memory_order_relaxed);
+            recycle(std::move(chunk));
+            return false;
+        }
+        pending_->audio.appendSilence(hole);
+        pending_->audio.append(chunk->audio, skip);
+        pending_->end_sample = std::max(pending_->end_sample, chunk->end_sample);
+        pending_->next_start_sample = chunk->next_start_sample;
+        coalesced_.fetch_add(1, std::memory_order_relaxed);
+        recycle(std::move(chunk));
+        return true;
+    }
+    
+    if (queue_.tryPush(std::move(chunk))) {
+        pushed_.fetch_add(1, std::memory_order_relaxed);
+        chunk_ready_.notify();
+        return true;
+    }
+    
+    switch (policy_) {
+        case QueueOverflowPolicy::Block:
+            blocked_.fetch_add(1, std::memory_order_relaxed);
+            while (!closed_.load()) {
+                space_ready_.waitFor([this]() { return closed_.load() || queue_.size() < queue_.capacity(); },
+                                     std::chrono::milliseconds(100));
+                if (queue_.tryPush(std::move(chunk))) {
+                    pushed_.fetch_add(1, std::memory_order_relaxed);
+                    chunk_ready_.notify();
+                    return true;
+                }
+            }
+            recycle(std::move(chunk));
+            return false;
+            
+        case QueueOverflowPolicy::DropOldest: {
+            AudioChunkPtr oldest;
+            while (!queue_.tryPush(std::move(chunk))) {
+                if (queue_.tryPop(oldest)) {
+                    dropped_oldest_.fetch_add(1, std::memory_order_relaxed);
+                    recycle(std::move(oldest));
+                }
+            }
+            pushed_.fetch_add(1, std::memory_order_relaxed);
+            chunk_ready_.notify();
+            return true;
+        }
+            
+        case QueueOverflowPolicy::Coalesce:
+            pending_ = std::move(chunk);
+            return true;
+            
+        case QueueOverflowPolicy::DropNewest:
+        default:
+            dropped_newest_.fetch_add(1, std::memory_order_relaxed);
+            recycle(std::move(chunk));
+            return false;
+    }
+}
+
+void ChunkQueue::flush() {
+    if (pending_ && queue_.tryPush(std::move(pending_))) {
+        pushed_.fetch_add(1, std::memory_order_relaxed);
+        chunk_ready_.notify();
+    }
+}
+
+AudioChunkPtr ChunkQueue::pop() {
+    AudioChunkPtr chunk;
+    if (queue_.tryPop(chunk)) {
+        popped_.fetch_add(1, std::memory_order_relaxed);
+        space_ready_.notify();
+    }
+    return chunk;
+}
+
+void ChunkQueue::waitForChunk(std::chrono::milliseconds timeout) {
+    chunk_ready_.waitFor([this]() { return closed_.load() || queue_.size() > 0; }, timeout);
+}
+
+void ChunkQueue::close() {
+    closed_.store(true);
+    chunk_ready_.notify();
+    space_ready_.notify();
+}
+
+AudioChunkPtr ChunkQueue::acquire() {
+    AudioChunkPtr chunk;
+    if (free_.tryPop(chunk)) {
+        chunks_reused_.fetch_add(1, std::memory_order_relaxed);
+        return chunk;
+    }
+    chunks_allocated_.fetch_add(1, std::memory_order_relaxed);
+    return std::make_unique<AudioChunk>();
+}
+
+void ChunkQueue::recycle(AudioChunkPtr chunk) {
+    if (!chunk) {
+        return;
+    }
+    // Release the blocks now; a chunk that does not fit is simply freed
+    chunk->audio.clear();
+    chunk->is_final = false;
+    free_.tryPush(std::move(chunk));
+}
+
+ChunkQueueStats ChunkQueue::stats() const {
+    ChunkQueueStats stats;
+    stats.pushed = pushed_.load(std::memory_order_relaxed);
+    stats.popped = popped_.load(std::memory_order_relaxed);
+    stats.blocked = blocked_.load(std::memory_order_relaxed);
+    stats.dropped_oldest = dropped_oldest_.load(std::memory_order_relaxed);
+    stats.dropped_newest = dropped_newest_.load(std::memory_order_relaxed);
+    stats.coalesced = coalesced_.load(std::memory_order_relaxed);
+    stats.chunks_allocated = chunks_allocated_.load(std::memory_order_relaxed);
+    stats.chunks_reused = chunks_reused_.load(std::memory_order_relaxed);
+    return stats;
+}
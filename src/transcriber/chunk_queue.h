@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "bounded_queue.h"
+#include "sample_span.h"
+#include "wakeup.h"
+
+// What the chunker does when the transcription queue is full
+enum class QueueOverflowPolicy {
+    Block,       // Wait for the transcriber; the sample ring holds one max-length
+                 // chunk of audio meanwhile, live audio past that is dropped and counted
+    DropOldest,  // Evict the oldest queued chunk
+    DropNewest,  // Discard the incoming chunk
+    Coalesce     // Merge incoming chunks into one held chunk until space frees
+};
+
+struct ChunkQueueStats {
+    uint64_t pushed = 0;
+    uint64_t popped = 0;
+    uint64_t blocked = 0;         // Pushes that had to wait for space
+    uint64_t dropped_oldest = 0;
+    uint64_t dropped_newest = 0;
+    uint64_t coalesced = 0;       // Chunks merged into a held chunk
+    uint64_t chunks_allocated = 0; // Chunk objects created (warmup only once recycling)
+    uint64_t chunks_reused = 0;    // Chunk objects served from the recycle list
+};
+
+struct AudioChunk {
+    SampleSpan audio;
+    uint64_t start_sample = 0;  // Timeline position of audio[0]
+    uint64_t end_sample = 0;    // One past the last sample
+    uint64_t next_start_sample = 0;  // Where the next chunk starts; audio past it is decoded again
+    bool is_final = false;
+    std::chrono::steady_clock::time_point queued_at;  // When the chunker pushed it
+};
+
+using AudioChunkPtr = std::unique_ptr<AudioChunk>;
+
+// Bounded lock-free queue of chunk handles with an explicit overflow policy.
+// push() and flush() must only be called from the single producer thread.
+//
+// Chunk objects circulate instead of being allocated per chunk: the producer
+// takes one from acquire(), the consumer hands it back through recycle(), and
+// chunks dropped on overflow are recycled internally. A recycled chunk keeps
+// its span's segment storage, so refilling it does not allocate either.
+class ChunkQueue {
+public:
+    ChunkQueue(size_t capacity, QueueOverflowPolicy policy, size_t max_coalesced_samples);
+
+    bool push(AudioChunkPtr chunk);
+    void flush();
+    AudioChunkPtr pop();
+    // Sleeps until a chunk is queued, the queue is closed or the timeout passes
+    void waitForChunk(std::chrono::milliseconds timeout);
+    void close();
+    // A coalesced chunk is held for space; producer thread only
+    bool holding() const { return pending_ != nullptr; }
+
+    AudioChunkPtr acquire();
+    void recycle(AudioChunkPtr chunk);
+
+    ChunkQueueStats stats() const;
+    size_t size() const { return queue_.size(); }
+
+private:
+    BoundedQueue<AudioChunkPtr> queue_;
+    BoundedQueue<AudioChunkPtr> free_;  // Recycled chunks, audio cleared
+    QueueOverflowPolicy policy_;
+    size_t max_coalesced_samples_;
+    AudioChunkPtr pending_;  // Coalesced overflow waiting for space
+    std::atomic<bool> closed_{false};
+    Wakeup chunk_ready_;  // Consumer waiting for a chunk
+    Wakeup space_ready_;  // Blocked producer waiting for a free slot
+
+    std::atomic<uint64_t> pushed_{0};
+    std::atomic<uint64_t> popped_{0};
+    std::atomic<uint64_t> blocked_{0};
+    std::atomic<uint64_t> dropped_oldest_{0};
+    std::atomic<uint64_t> dropped_newest_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> chunks_allocated_{0};
+    std::atomic<uint64_t> chunks_reused_{0};
+};
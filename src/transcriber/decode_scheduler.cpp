@@ -0,0 +1,246 @@
+#include "decode_scheduler.h"
+#include <algorithm>
+
+namespace {
+
+constexpr size_t MAX_TRACKED_ARRIVALS = 1024;  // Beyond any chunk queue; drops leave stale entries
+constexpr double TYPICAL_SMOOTHING = 0.2;
+constexpr double MIN_WEIGHT = 0.01;
+
+int rank(DecodePriority priority) {
+    return static_cast<int>(priority);
+}
+
+} // namespace
+
+const char* decodePriorityName(DecodePriority priority) {
+    switch (priority) {
+        case DecodePriority::Live: return "live";
+        case DecodePriority::NearLive: return "near-live";
+        case DecodePriority::Batch: return "batch";
+    }
+    return "?";
+}
+
+bool parseDecodePriority(const std::string& name, DecodePriority& priority) {
+    if (name == "live") {
+        priority = DecodePriority::Live;
+    } else if (name == "near-live") {
+        priority = DecodePriority::NearLive;
+    } else if (name == "batch") {
+        priority = DecodePriority::Batch;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+int DecodeScheduler::defaultSloMs(DecodePriority priority) {
+    switch (priority) {
+        case DecodePriority::Live: return 3000;
+        case DecodePriority::NearLive: return 15000;
+        case DecodePriority::Batch: return 0;
+    }
+    return 0;
+}
+
+DecodeScheduler::DecodeScheduler(int workers) {
+    workers = std::max(1, workers);
+    workers_.reserve(workers);
+    for (int i = 0; i < workers; i++) {
+        workers_.emplace_back(&DecodeScheduler::workerThread, this);
+    }
+}
+
+DecodeScheduler::~DecodeScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+uint64_t DecodeScheduler::add(Step step, const DecodeSessionOptions& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t id = next_id_++;
+    Session& session = sessions_[id];
+    session.step = std::move(step);
+    session.options = options;
+    session.options.weight = std::max(MIN_WEIGHT, options.weight);
+    int slo_ms = options.latency_slo_ms > 0 ? options.latency_slo_ms : defaultSloMs(options.priority);
+    session.slo = std::chrono::milliseconds(slo_ms);
+    session.used_s = std::max(0.0, leastUsedActive(options.priority));
+    return id;
+}
+
+void DecodeScheduler::remove(uint64_t session) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = sessions_.find(session);
+    if (it == sessions_.end()) {
+        return;
+    }
+    done_cv_.wait(lock, [&]() { return !it->second.running; });
+    sessions_.erase(it);
+}
+
+void DecodeScheduler::notify(uint64_t session, Clock::time_point arrived) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = sessions_.find(session);
+        if (it == sessions_.end()) {
+            return;
+        }
+        std::deque<Clock::time_point>& arrivals = it->second.arrivals;
+        if (arrivals.size() >= MAX_TRACKED_ARRIVALS) {
+            arrivals.pop_front();
+        }
+        arrivals.push_back(arrived);
+        wake(it->second, Clock::now());
+    }
+    work_cv_.notify_one();
+}
+
+void DecodeScheduler::notify(uint64_t session) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = sessions_.find(session);
+        if (it == sessions_.end() || it->second.pending) {
+            return;
+        }
+        wake(it->second, Clock::now());
+    }
+    work_cv_.notify_one();
+}
+
+void DecodeScheduler::wake(Session& session, Clock::time_point now) {
+    if (session.pending) {
+        return;
+    }
+    if (!session.running) {
+        // Time spent idle is not owed back as decode time
+        session.used_s = std::max(session.used_s, leastUsedActive(session.options.priority));
+    }
+    session.pending = true;
+    session.pending_since = now;
+}
+
+DecodeSchedulerStats DecodeScheduler::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    DecodeSchedulerStats stats;
+    stats.sessions = sessions_.size();
+    stats.workers = static_cast<int>(workers_.size());
+    stats.steps = steps_;
+    stats.busy_s = busy_s_;
+    double wait_total_ms = 0.0;
+    for (int c = 0; c < DECODE_PRIORITY_COUNT; c++) {
+        stats.classes[c] = classes_[c];
+        stats.classes[c].mean_wait_ms = classes_[c].jobs ? wait_total_ms_[c] / classes_[c].jobs : 0.0;
+        stats.max_wait_ms = std::max(stats.max_wait_ms, classes_[c].max_wait_ms);
+        wait_total_ms += wait_total_ms_[c];
+    }
+    stats.mean_wait_ms = steps_ ? wait_total_ms / steps_ : 0.0;
+    return stats;
+}
+
+void DecodeScheduler::workerThread() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        Session* session = nullptr;
+        work_cv_.wait(lock, [&]() { return stopping_ || (session = next(Clock::now())) != nullptr; });
+        if (stopping_) {
+            return;
+        }
+
+        auto start = Clock::now();
+        Clock::time_point arrival = session->arrival();
+        Clock::time_point deadline = session->deadline();
+        session->pending = false;
+        session->running = true;
+
+        // The map node stays put while running: remove() waits for it
+        lock.unlock();
+        bool decoded = session->step();
+        auto end = Clock::now();
+        lock.lock();
+
+        double elapsed_s = std::chrono::duration<double>(end - start).count();
+        session->running = false;
+        if (decoded) {
+            steps_++;
+            busy_s_ += elapsed_s;
+            session->used_s += elapsed_s / session->options.weight;
+            session->typical_s = session->typical_s > 0.0
+                ? session->typical_s + TYPICAL_SMOOTHING * (elapsed_s - session->typical_s)
+                : elapsed_s;
+
+            int c = rank(session->options.priority);
+            double wait_ms = std::chrono::duration<double, std::milli>(start - arrival).count();
+            classes_[c].jobs++;
+            classes_[c].missed += session->hasDeadline() && end > deadline;
+            classes_[c].max_wait_ms = std::max(classes_[c].max_wait_ms, wait_ms);
+            wait_total_ms_[c] += wait_ms;
+            if (!session->arrivals.empty()) {
+                session->arrivals.pop_front();
+            }
+
+            // More chunks may be queued; the next step finds out
+            if (!session->pending) {
+                session->pending = true;
+                session->pending_since = end;
+            }
+        } else {
+            session->arrivals.clear();  // Whatever they were, nothing is queued now
+        }
+        done_cv_.notify_all();
+        if (session->pending) {
+            work_cv_.notify_one();
+        }
+    }
+}
+
+DecodeScheduler::Session* DecodeScheduler::next(Clock::time_point now) {
+    Session* urgent = nullptr;
+    Session* best = nullptr;
+    for (auto& entry : sessions_) {
+        Session& session = entry.second;
+        if (!session.pending || session.running) {
+            continue;
+        }
+
+        // Still able to make its deadline, but only if it starts now
+        if (session.hasDeadline() && session.typical_s > 0.0) {
+            Clock::time_point deadline = session.deadline();
+            auto slack = std::chrono::duration<double>(deadline - now).count();
+            if (slack >= 0.0 && slack <= session.typical_s && (!urgent || deadline < urgent->deadline())) {
+                urgent = &session;
+            }
+        }
+
+        if (!best) {
+            best = &session;
+            continue;
+        }
+        int class_order = rank(session.options.priority) - rank(best->options.priority);
+        if (class_order < 0 || (class_order == 0 && (session.used_s < best->used_s ||
+                                                     (session.used_s == best->used_s &&
+                                                      session.deadline() < best->deadline())))) {
+            best = &session;
+        }
+    }
+    return urgent ? urgent : best;
+}
+
+double DecodeScheduler::leastUsedActive(DecodePriority priority) const {
+    double least = -1.0;
+    for (const auto& entry : sessions_) {
+        const Session& session = entry.second;
+        if (session.options.priority == priority && (session.pending || session.running) &&
+            (least < 0.0 || session.used_s < least)) {
+            least = session.used_s;
+        }
+    }
+    return least;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Runs the decode work of many sessions on one set of worker threads. Each
+// session registers a step that decodes at most one queued chunk. A session
+// never has two steps running, so its chunks are decoded in order and its
+// whisper_state is only touched by one worker at a time.
+//
+// Every session has a priority class. Live and near-live chunks carry a
+// deadline: their arrival plus the session's latency SLO. Workers choose:
+//   1. A chunk that must start now to meet its deadline (its slack is below
+//      the session's typical decode time), earliest deadline first. Chunks
+//      already late get no urgency, so one overloaded session cannot take
+//      over the pool by being behind.
+//   2. Otherwise, work from the highest class that has any: live, then
+//      near-live, then batch.
+//   3. Within that class, the session with the least decode time used per
+//      unit of weight. A session returning from silence starts level with
+//      the least-served busy session of its class, not with banked credit.
+
+enum class DecodePriority {
+    Live,        // Someone is watching the words appear
+    NearLive,    // Results wanted soon, e.g. captions for a delayed stream
+    Batch        // Backlog and offline work; runs when nothing else waits
+};
+
+constexpr int DECODE_PRIORITY_COUNT = 3;
+
+const char* decodePriorityName(DecodePriority priority);
+bool parseDecodePriority(const std::string& name, DecodePriority& priority);
+
+struct DecodeSessionOptions {
+    DecodePriority priority = DecodePriority::Live;
+    double weight = 1.0;         // Share of decode time relative to its class
+    int latency_slo_ms = 0;      // Arrival to decoded; 0 = class default, none for batch
+};
+
+struct DecodeClassStats {
+    uint64_t jobs = 0;           // Chunks decoded
+    uint64_t missed = 0;         // Finished after their deadline
+    double mean_wait_ms = 0.0;   // Arrival to a worker starting on it
+    double max_wait_ms = 0.0;
+};
+
+struct DecodeSchedulerStats {
+    size_t sessions = 0;
+    int workers = 0;
+    uint64_t steps = 0;          // Steps that decoded a chunk
+    double busy_s = 0.0;         // Worker time spent in those steps
+    double mean_wait_ms = 0.0;   // All classes
+    double max_wait_ms = 0.0;
+    DecodeClassStats classes[DECODE_PRIORITY_COUNT];
+
+    const DecodeClassStats& of(DecodePriority priority) const { return classes[static_cast<int>(priority)]; }
+};
+
+class DecodeScheduler {
+public:
+    // Decodes at most one chunk; false when the session had nothing queued
+    using Step = std::function<bool()>;
+    using Clock = std::chrono::steady_clock;
+
+    explicit DecodeScheduler(int workers);
+    ~DecodeScheduler();
+
+    DecodeScheduler(const DecodeScheduler&) = delete;
+    DecodeScheduler& operator=(const DecodeScheduler&) = delete;
+
+    uint64_t add(Step step, const DecodeSessionOptions& options = DecodeSessionOptions());
+    // Waits for the session's running step; no step runs once it returns
+    void remove(uint64_t session);
+    // A chunk was queued at arrived; its deadline counts from then
+    void notify(uint64_t session, Clock::time_point arrived);
+    // The session may have queued work (e.g. a held chunk was released)
+    void notify(uint64_t session);
+
+    DecodeSchedulerStats stats() const;
+
+    static int defaultSloMs(DecodePriority priority);
+
+private:
+    struct Session {
+        Step step;
+        DecodeSessionOptions options;
+        Clock::duration slo{};
+        double used_s = 0.0;     // Decode time consumed / weight; the fairness key
+        double typical_s = 0.0;  // Moving average decode time, the slack a deadline needs
+        bool pending = false;
+        bool running = false;
+        Clock::time_point pending_since;
+        std::deque<Clock::time_point> arrivals;  // Chunks notified and not yet decoded
+
+        bool hasDeadline() const { return options.priority != DecodePriority::Batch; }
+        Clock::time_point arrival() const { return arrivals.empty() ? pending_since : arrivals.front(); }
+        Clock::time_point deadline() const { return arrival() + slo; }
+    };
+
+    void workerThread();
+    Session* next(Clock::time_point now);  // Pending and idle, by the rules above; mutex_ held
+    void wake(Session& session, Clock::time_point now);
+    double leastUsedActive(DecodePriority priority) const;  // -1 when none of the class is busy
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;  // A step finished
+    std::map<uint64_t, Session> sessions_;
+    uint64_t next_id_ = 1;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+
+    uint64_t steps_ = 0;
+    double busy_s_ = 0.0;
+    double wait_total_ms_[DECODE_PRIORITY_COUNT] = {};
+    DecodeClassStats classes_[DECODE_PRIORITY_COUNT];
+};
@@ -0,0 +1,95 @@
+#include "edge_trim.h"
+#include "audio_energy.h"
+#include "chunk_queue.h"
+#include "transcriber.h"
+#include "whisper_model.h"
+#include <algorithm>
+
+namespace {
+
+constexpr size_t SAMPLES_PER_MS = 16;
+constexpr size_t SCAN_SAMPLES = 256;    // Kernel call granularity; the guard covers the rounding
+
+// Samples before the first piece with a sample over threshold (size when none)
+size_t quietHead(const SampleSpan& span, float threshold) {
+    size_t position = 0;
+    for (const SampleSpan::Segment& segment : span.segments()) {
+        for (size_t offset = 0; offset < segment.count; offset += SCAN_SAMPLES) {
+            size_t count = std::min(SCAN_SAMPLES, segment.count - offset);
+            if (energyMaxAbs(segment.data + offset, count) > threshold) {
+                return position + offset;
+            }
+        }
+        position += segment.count;
+    }
+    return position;
+}
+
+// Samples after the last piece with a sample over threshold
+size_t quietTail(const SampleSpan& span, float threshold) {
+    size_t position = 0;
+    const auto& segments = span.segments();
+    for (auto segment = segments.rbegin(); segment != segments.rend(); ++segment) {
+        for (size_t end = segment->count; end > 0;) {
+            size_t count = std::min(SCAN_SAMPLES, end);
+            end -= count;
+            if (energyMaxAbs(segment->data + end, count) > threshold) {
+                return position + (segment->count - end - count);
+            }
+        }
+        position += segment->count;
+    }
+    return position;
+}
+
+} // namespace
+
+EdgeTrimmer::EdgeTrimmer(const TranscriptionConfig& config)
+    : threshold_(config.silence_threshold)
+    , guard_samples_(static_cast<size_t>(std::max(config.edge_guard_ms, 0)) * SAMPLES_PER_MS)
+    , min_samples_(WHISPER_MIN_SAMPLES) {
+}
+
+size_t EdgeTrimmer::trim(AudioChunk& chunk) {
+    size_t size = chunk.audio.size();
+    chunks_.fetch_add(1, std::memory_order_relaxed);
+    input_samples_.fetch_add(size, std::memory_order_relaxed);
+
+    size_t head = quietHead(chunk.audio, threshold_);
+    if (head >= size) {
+        return 0;
+    }
+    size_t tail = quietTail(chunk.audio, threshold_);
+    head = head > guard_samples_ ? head - guard_samples_ : 0;
+    tail = tail > guard_samples_ ? tail - guard_samples_ : 0;
+
+    // Give back trimmed audio, evenly from both edges, until whisper takes it
+    size_t kept = size - head - tail;
+    if (kept < min_samples_) {
+        size_t missing = std::min(min_samples_, size) - kept;
+        size_t from_head = std::min(head, missing / 2);
+        size_t from_tail = std::min(tail, missing - from_head);
+        from_head = std::min(head, missing - from_tail);
+        head -= from_head;
+        tail -= from_tail;
+    }
+    if (head + tail == 0) {
+        return 0;
+    }
+
+    chunk.audio.trim(head, tail);
+    chunk.start_sample += head;
+    chunk.end_sample -= tail;
+    trimmed_chunks_.fetch_add(1, std::memory_order_relaxed);
+    trimmed_samples_.fetch_add(head + tail, std::memory_order_relaxed);
+    return head + tail;
+}
+
+EdgeTrimStats EdgeTrimmer::stats() const {
+    EdgeTrimStats stats;
+    stats.chunks = chunks_.load(std::memory_order_relaxed);
+    stats.trimmed_chunks = trimmed_chunks_.load(std::memory_order_relaxed);
+    stats.input_samples = input_samples_.load(std::memory_order_relaxed);
+    stats.trimmed_samples = trimmed_samples_.load(std::memory_order_relaxed);
+    return stats;
+}
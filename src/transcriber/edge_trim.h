@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+struct AudioChunk;
+struct TranscriptionConfig;
+
+struct EdgeTrimStats {
+    uint64_t chunks = 0;
+    uint64_t trimmed_chunks = 0;
+    uint64_t input_samples = 0;    // Chunk audio before trimming
+    uint64_t trimmed_samples = 0;  // Removed from chunk edges, never decoded
+
+    // Seconds per hour of chunk audio that never reach the model
+    double secondsPerHour() const { return input_samples ? 3600.0 * trimmed_samples / input_samples : 0.0; }
+};
+
+// Strips leading and trailing sub-threshold audio (the chunker's
+// silence_threshold) from a chunk before it is decoded, keeping a guard
+// margin so soft onsets and decays survive. The span and the chunk's sample
+// positions are narrowed together, so result timestamps and overlap
+// accounting follow the audio actually decoded. Chunks are never trimmed
+// below WHISPER_MIN_SAMPLES (1.1 s), and a chunk with no sample over the
+// threshold is left alone (the VAD judged it speech).
+class EdgeTrimmer {
+public:
+    explicit EdgeTrimmer(const TranscriptionConfig& config);
+
+    // Returns the number of samples removed
+    size_t trim(AudioChunk& chunk);
+    EdgeTrimStats stats() const;
+
+private:
+    float threshold_;
+    size_t guard_samples_;
+    size_t min_samples_;
+
+    std::atomic<uint64_t> chunks_{0};
+    std::atomic<uint64_t> trimmed_chunks_{0};
+    std::atomic<uint64_t> input_samples_{0};
+    std::atomic<uint64_t> trimmed_samples_{0};
+};
@@ -0,0 +1,99 @@
+#include "fft.h"
+#include <cmath>
+
+namespace {
+
+// One radix-2 stage over a block: a += w*b, b = a - w*b. The halves never
+// overlap, which is what lets the loop vectorize without alias checks
+void butterflies(float* __restrict ar, float* __restrict ai, float* __restrict br, float* __restrict bi,
+                 const float* __restrict wc, const float* __restrict ws, size_t span) {
+    for (size_t j = 0; j < span; j++) {
+        float tr = br[j] * wc[j] - bi[j] * ws[j];
+        float ti = br[j] * ws[j] + bi[j] * wc[j];
+        br[j] = ar[j] - tr;
+        bi[j] = ai[j] - ti;
+        ar[j] += tr;
+        ai[j] += ti;
+    }
+}
+
+} // namespace
+
+RealFft::RealFft(size_t size)
+    : size_(size)
+    , half_(size / 2)
+    , bit_reverse_(half_)
+    , split_cos_(half_)
+    , split_sin_(half_)
+    , re_(half_)
+    , im_(half_) {
+    const double pi = 3.14159265358979323846;
+
+    size_t bits = 0;
+    while ((size_t(1) << bits) < half_) {
+        bits++;
+    }
+    for (size_t i = 0; i < half_; i++) {
+        size_t reversed = 0;
+        for (size_t b = 0; b < bits; b++) {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bit_reverse_[i] = reversed;
+    }
+
+    // Stage with butterfly span len uses w^j = exp(-2*pi*i*j/len), j < len/2,
+    // stored at offset len/2 - 1 so the inner loop reads it unit-stride
+    for (size_t len = 2; len <= half_; len <<= 1) {
+        for (size_t j = 0; j < len / 2; j++) {
+            double angle = 2.0 * pi * double(j) / double(len);
+            stage_cos_.push_back(static_cast<float>(std::cos(angle)));
+            stage_sin_.push_back(static_cast<float>(-std::sin(angle)));
+        }
+    }
+
+    for (size_t k = 0; k < half_; k++) {
+        double angle = 2.0 * pi * double(k) / double(size_);
+        split_cos_[k] = static_cast<float>(std::cos(angle));
+        split_sin_[k] = static_cast<float>(-std::sin(angle));
+    }
+}
+
+void RealFft::powerSpectrum(const float* in, float* power) {
+    // Even samples become the real part, odd samples the imaginary part,
+    // written straight into bit-reversed order
+    for (size_t k = 0; k < half_; k++) {
+        re_[bit_reverse_[k]] = in[2 * k];
+        im_[bit_reverse_[k]] = in[2 * k + 1];
+    }
+
+    for (size_t len = 2; len <= half_; len <<= 1) {
+        size_t span = len / 2;
+        const float* wc = stage_cos_.data() + span - 1;
+        const float* ws = stage_sin_.data() + span - 1;
+        for (size_t i = 0; i < half_; i += len) {
+            butterflies(re_.data() + i, im_.data() + i, re_.data() + i + span, im_.data() + i + span,
+                        wc, ws, span);
+        }
+    }
+
+    // Split Z into the spectra of the even and odd samples and recombine:
+    // X[k] = (Z[k] + conj(Z[M-k]))/2 + W^k (Z[k] - conj(Z[M-k]))/2i
+    float dc = re_[0] + im_[0];
+    float nyquist = re_[0] - im_[0];
+    power[0] = dc * dc;
+    power[half_] = nyquist * nyquist;
+
+    const float* __restrict zr = re_.data();
+    const float* __restrict zi = im_.data();
+    for (size_t k = 1; k < half_; k++) {
+        float ar = zr[k], ai = zi[k];
+        float br = zr[half_ - k], bi = zi[half_ - k];
+        float even_r = 0.5f * (ar + br);
+        float even_i = 0.5f * (ai - bi);
+        float odd_r = 0.5f * (ai + bi);
+        float odd_i = -0.5f * (ar - br);
+        float xr = even_r + split_cos_[k] * odd_r - split_sin_[k] * odd_i;
+        float xi = even_i + split_cos_[k] * odd_i + split_sin_[k] * odd_r;
+        power[k] = xr * xr + xi * xi;
+    }
+}
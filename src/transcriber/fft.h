@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Power spectrum of a real frame via a radix-2 FFT. The N real samples are
+// packed into an N/2-point complex transform and split afterwards, halving
+// the work. Real and imaginary parts live in separate arrays and each stage
+// has its own contiguous twiddle table, so every butterfly loop is a plain
+// unit-stride loop the compiler vectorizes (SSE/AVX/NEON) at -O3.
+class RealFft {
+public:
+    // size must be a power of two >= 4
+    explicit RealFft(size_t size);
+
+    // in holds size() samples (zero-padded by the caller); power receives
+    // bins() values |X[k]|^2 for k = 0 .. size()/2
+    void powerSpectrum(const float* in, float* power);
+
+    size_t size() const { return size_; }
+    size_t bins() const { return size_ / 2 + 1; }
+
+private:
+    size_t size_;
+    size_t half_;                      // Complex transform length
+    std::vector<size_t> bit_reverse_;
+    std::vector<float> stage_cos_;     // Twiddles, stage after stage
+    std::vector<float> stage_sin_;
+    std::vector<float> split_cos_;     // Twiddles for the real/complex split
+    std::vector<float> split_sin_;
+    std::vector<float> re_;
+    std::vector<float> im_;
+};
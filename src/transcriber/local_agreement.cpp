@@ -0,0 +1,104 @@
+#include "local_agreement.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+constexpr uint64_t SAMPLE_RATE = 16000;
+constexpr uint64_t TIMESTAMP_TOLERANCE = SAMPLE_RATE / 10;  // Word times jitter between decodes
+constexpr uint64_t REPEAT_WINDOW = SAMPLE_RATE;              // Re-decoded words start this close
+constexpr size_t MAX_REPEAT_WORDS = 5;
+constexpr size_t HISTORY_WORDS = 200;
+
+// Lowercase letters, digits and apostrophes; UTF-8 bytes pass through
+std::string normalize(const std::string& word) {
+    std::string out;
+    out.reserve(word.size());
+    for (char c : word) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (u >= 0x80 || std::isalnum(u) || c == '\'') {
+            out += static_cast<char>(std::tolower(u));
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+bool sameSpokenWord(const std::string& a, const std::string& b) {
+    return normalize(a) == normalize(b);
+}
+
+size_t LocalAgreement::insert(std::vector<TimedWord> hypothesis, std::vector<TimedWord>& committed) {
+    // Words that start before the committed end were already decided
+    if (committed_end_ > 0) {
+        uint64_t settled = committed_end_ > TIMESTAMP_TOLERANCE ? committed_end_ - TIMESTAMP_TOLERANCE : 0;
+        hypothesis.erase(std::remove_if(hypothesis.begin(), hypothesis.end(),
+                                        [settled](const TimedWord& word) { return word.start_sample < settled; }),
+                         hypothesis.end());
+    }
+
+    // A window that still holds committed audio may decode its last words
+    // again just past the boundary: drop the longest such repeat
+    if (!hypothesis.empty() && hypothesis.front().start_sample < committed_end_ + REPEAT_WINDOW) {
+        size_t longest = std::min({MAX_REPEAT_WORDS, history_.size(), hypothesis.size()});
+        for (size_t n = longest; n > 0; n--) {
+            bool repeated = true;
+            for (size_t i = 0; i < n && repeated; i++) {
+                repeated = sameSpokenWord(history_[history_.size() - n + i], hypothesis[i].text);
+            }
+            if (repeated) {
+                hypothesis.erase(hypothesis.begin(), hypothesis.begin() + n);
+                break;
+            }
+        }
+    }
+
+    // Commit the prefix this hypothesis shares with the previous one, taking
+    // the newer words (their timestamps saw more audio)
+    size_t agreed = 0;
+    while (agreed < hypothesis.size() && agreed < tentative_.size() &&
+           sameSpokenWord(hypothesis[agreed].text, tentative_[agreed].text)) {
+        commit(hypothesis[agreed], committed);
+        agreed++;
+    }
+    hypothesis.erase(hypothesis.begin(), hypothesis.begin() + agreed);
+    tentative_ = std::move(hypothesis);
+    return agreed;
+}
+
+size_t LocalAgreement::flush(std::vector<TimedWord>& committed) {
+    size_t count = tentative_.size();
+    for (const TimedWord& word : tentative_) {
+        commit(word, committed);
+    }
+    tentative_.clear();
+    return count;
+}
+
+void LocalAgreement::reset() {
+    tentative_.clear();
+    history_.clear();
+    committed_end_ = 0;
+}
+
+std::string LocalAgreement::prompt(size_t max_words) const {
+    std::string text;
+    size_t first = history_.size() > max_words ? history_.size() - max_words : 0;
+    for (size_t i = first; i < history_.size(); i++) {
+        if (!text.empty()) {
+            text += " ";
+        }
+        text += history_[i];
+    }
+    return text;
+}
+
+void LocalAgreement::commit(const TimedWord& word, std::vector<TimedWord>& committed) {
+    committed.push_back(word);
+    committed_end_ = std::max(committed_end_, word.end_sample);
+    history_.push_back(word.text);
+    if (history_.size() > HISTORY_WORDS) {
+        history_.pop_front();
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// A decoded word placed on the session sample timeline
+struct TimedWord {
+    std::string text;
+    uint64_t start_sample = 0;
+    uint64_t end_sample = 0;
+};
+
+// Whether two decodes heard the same word: case and punctuation are ignored
+bool sameSpokenWord(const std::string& a, const std::string& b);
+
+// LocalAgreement-2 commit policy for re-decoding a growing audio window. Each
+// decode yields a hypothesis for the whole window; a word is committed once
+// two consecutive hypotheses agree on it, as part of the prefix following
+// what is already committed. Committed words never change, so the caller can
+// trim their audio from the window and pass their text as the next prompt.
+// Words are compared ignoring case and punctuation.
+class LocalAgreement {
+public:
+    // Takes the latest hypothesis (words in time order), appends the words it
+    // confirms to committed and returns how many
+    size_t insert(std::vector<TimedWord> hypothesis, std::vector<TimedWord>& committed);
+    // Commits the unconfirmed words as they stand (window closed)
+    size_t flush(std::vector<TimedWord>& committed);
+    void reset();
+
+    // Words of the latest hypothesis not confirmed yet
+    const std::vector<TimedWord>& tentative() const { return tentative_; }
+    // End of the last committed word; audio before it is settled
+    uint64_t committedEnd() const { return committed_end_; }
+    // The last max_words committed words, for the decoder prompt
+    std::string prompt(size_t max_words) const;
+
+private:
+    std::vector<TimedWord> tentative_;
+    std::deque<std::string> history_;  // Recent committed words
+    uint64_t committed_end_ = 0;
+
+    void commit(const TimedWord& word, std::vector<TimedWord>& committed);
+};
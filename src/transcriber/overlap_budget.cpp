@@ -0,0 +1,40 @@
+#include "overlap_budget.h"
+#include "chunk_queue.h"
+#include "transcriber.h"
+#include <algorithm>
+
+namespace {
+
+constexpr size_t SAMPLES_PER_MS = 16;
+constexpr size_t MAX_LEAD_SHARE = 4;  // Lead-in is at most 1/4 of a chunk
+
+} // namespace
+
+size_t OverlapBudget::leadSamples(const TranscriptionConfig& config) {
+    int lead_ms = config.enable_context ? config.context_duration_ms : config.overlap_ms;
+    int chunk_ms = config.enable_smart_chunking ? config.optimal_chunk_duration_ms : config.chunk_duration_ms;
+    return std::min<size_t>(std::max(lead_ms, 0), std::max(chunk_ms, 0) / MAX_LEAD_SHARE) * SAMPLES_PER_MS;
+}
+
+size_t OverlapBudget::redundantSamples(const AudioChunk& chunk, uint64_t decoded_end) {
+    if (decoded_end <= chunk.start_sample) {
+        return 0;
+    }
+    return std::min<uint64_t>(decoded_end - chunk.start_sample, chunk.audio.size());
+}
+
+void OverlapBudget::record(size_t chunk_samples, size_t redundant_samples, size_t words_dropped) {
+    chunks_.fetch_add(1, std::memory_order_relaxed);
+    new_samples_.fetch_add(chunk_samples - std::min(redundant_samples, chunk_samples), std::memory_order_relaxed);
+    redundant_samples_.fetch_add(redundant_samples, std::memory_order_relaxed);
+    words_dropped_.fetch_add(words_dropped, std::memory_order_relaxed);
+}
+
+OverlapStats OverlapBudget::stats() const {
+    OverlapStats stats;
+    stats.chunks = chunks_.load(std::memory_order_relaxed);
+    stats.new_samples = new_samples_.load(std::memory_order_relaxed);
+    stats.redundant_samples = redundant_samples_.load(std::memory_order_relaxed);
+    stats.words_dropped = words_dropped_.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+struct AudioChunk;
+struct TranscriptionConfig;
+
+struct OverlapStats {
+    uint64_t chunks = 0;
+    uint64_t new_samples = 0;        // Audio decoded for the first time
+    uint64_t redundant_samples = 0;  // Audio an earlier chunk already decoded
+    uint64_t words_dropped = 0;      // Words removed because the earlier chunk produced them
+
+    // Seconds decoded again per second of new audio
+    double redundancy() const { return new_samples ? double(redundant_samples) / new_samples : 0.0; }
+};
+
+// The one place that decides how much already-decoded audio whisper sees
+// again. Each chunk starts with a lead-in cut from the end of the previous
+// one: context_duration_ms with enable_context, overlap_ms without, and never
+// more than a quarter of the chunk length. The decoder feeds chunks as they
+// are, so the lead-in is the only audio decoded twice, and the words falling
+// in it are removed from the result because the previous chunk produced them.
+class OverlapBudget {
+public:
+    // Samples of the previous chunk the next one starts with
+    static size_t leadSamples(const TranscriptionConfig& config);
+    // Leading samples of chunk that a decode ending at decoded_end covered
+    static size_t redundantSamples(const AudioChunk& chunk, uint64_t decoded_end);
+
+    void record(size_t chunk_samples, size_t redundant_samples, size_t words_dropped);
+    OverlapStats stats() const;
+
+private:
+    std::atomic<uint64_t> chunks_{0};
+    std::atomic<uint64_t> new_samples_{0};
+    std::atomic<uint64_t> redundant_samples_{0};
+    std::atomic<uint64_t> words_dropped_{0};
+};
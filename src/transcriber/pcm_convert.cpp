@@ -0,0 +1,97 @@
+#include "pcm_convert.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PCM_CONVERT_X86 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PCM_CONVERT_NEON 1
+#endif
+
+namespace {
+
+constexpr float S16_SCALE = 1.0f / 32768.0f;
+
+void convertScalar(const int16_t* in, float* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = in[i] * S16_SCALE;
+    }
+}
+
+#ifdef PCM_CONVERT_X86
+void convertSse2(const int16_t* in, float* out, size_t count) {
+    const __m128 scale = _mm_set1_ps(S16_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        // Sign-extend by placing each sample in the high half and shifting down
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    convertScalar(in + i, out + i, count - i);
+}
+
+__attribute__((target("avx2")))
+void convertAvx2(const int16_t* in, float* out, size_t count) {
+    const __m256 scale = _mm256_set1_ps(S16_SCALE);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8)));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+        _mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+    }
+    convertSse2(in + i, out + i, count - i);
+}
+#endif
+
+#ifdef PCM_CONVERT_NEON
+void convertNeon(const int16_t* in, float* out, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t v = vld1q_s16(in + i);
+        int32x4_t lo = vmovl_s16(vget_low_s16(v));
+        int32x4_t hi = vmovl_s16(vget_high_s16(v));
+        vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(lo), S16_SCALE));
+        vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(hi), S16_SCALE));
+    }
+    convertScalar(in + i, out + i, count - i);
+}
+#endif
+
+std::vector<PcmConverter> detectConverters() {
+    std::vector<PcmConverter> converters = {{"scalar", convertScalar}};
+#ifdef PCM_CONVERT_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        converters.push_back({"sse2", convertSse2});
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        converters.push_back({"avx2", convertAvx2});
+    }
+#elif defined(PCM_CONVERT_NEON)
+    converters.push_back({"neon", convertNeon});
+#endif
+    return converters;
+}
+
+const PcmConverter& impl() {
+    static const PcmConverter selected = detectConverters().back();
+    return selected;
+}
+
+} // namespace
+
+void convertS16ToFloat(const int16_t* in, float* out, size_t count) {
+    impl().convert(in, out, count);
+}
+
+const char* pcmConvertIsa() {
+    return impl().isa;
+}
+
+std::vector<PcmConverter> supportedPcmConverters() {
+    return detectConverters();
+}
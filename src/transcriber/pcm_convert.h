@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Converts signed 16-bit little-endian PCM to float in [-1, 1).
+// The implementation (AVX2, SSE2, NEON or scalar) is picked once at startup
+// from the CPU's capabilities.
+void convertS16ToFloat(const int16_t* in, float* out, size_t count);
+
+// Name of the selected implementation, for diagnostics
+const char* pcmConvertIsa();
+
+struct PcmConverter {
+    const char* isa;
+    void (*convert)(const int16_t*, float*, size_t);
+};
+
+// Every implementation this CPU can run, scalar reference first and the
+// selected one last (for verification and benchmarks)
+std::vector<PcmConverter> supportedPcmConverters();
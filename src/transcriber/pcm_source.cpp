@@ -0,0 +1,370 @@
+#include "pcm_source.h"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int READY_POLL_MS = 50;
+constexpr int FIRST_RESTART_DELAY_MS = 100;
+constexpr auto STABLE_RUN = std::chrono::seconds(30);  // A run this long resets the backoff
+constexpr auto TERMINATE_GRACE = std::chrono::seconds(2);
+
+bool hasPrefix(const std::string& text, const char* prefix, std::string& rest) {
+    size_t length = std::char_traits<char>::length(prefix);
+    if (text.compare(0, length, prefix) != 0) {
+        return false;
+    }
+    rest = text.substr(length);
+    return !rest.empty();
+}
+
+void setCloseOnExec(int fd) {
+    fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) | FD_CLOEXEC);
+}
+
+void reportExit(int status) {
+    if (WIFEXITED(status)) {
+        std::cerr << "⚠️ Audio source exited with status " << WEXITSTATUS(status) << std::endl;
+    } else if (WIFSIGNALED(status)) {
+        std::cerr << "⚠️ Audio source killed by signal " << WTERMSIG(status) << std::endl;
+    }
+}
+
+} // namespace
+
+const char* pcmSourceKindName(PcmSourceKind kind) {
+    switch (kind) {
+        case PcmSourceKind::Command: return "cmd";
+        case PcmSourceKind::Fifo: return "fifo";
+        case PcmSourceKind::File: return "file";
+        case PcmSourceKind::Stdin: return "stdin";
+        case PcmSourceKind::Socket: return "socket";
+    }
+    return "?";
+}
+
+bool parsePcmSource(const std::string& spec, PcmSourceConfig& config) {
+    std::string rest;
+    if (spec == "-" || spec == "stdin") {
+        config.kind = PcmSourceKind::Stdin;
+        config.target.clear();
+    } else if (hasPrefix(spec, "cmd:", rest)) {
+        config.kind = PcmSourceKind::Command;
+        config.target = rest;
+    } else if (hasPrefix(spec, "fifo:", rest)) {
+        config.kind = PcmSourceKind::Fifo;
+        config.target = rest;
+    } else if (hasPrefix(spec, "file:", rest)) {
+        config.kind = PcmSourceKind::File;
+        config.target = rest;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+PcmSource::PcmSource(const PcmSourceConfig& config)
+    : config_(config) {
+}
+
+PcmSource::~PcmSource() {
+    close();
+}
+
+bool PcmSource::open() {
+    restart_delay_ms_ = FIRST_RESTART_DELAY_MS;
+    switch (config_.kind) {
+        case PcmSourceKind::Command:
+            return spawn() && waitReady(nullptr);
+        case PcmSourceKind::Fifo:
+            // External producers attach whenever they like; nothing to wait for
+            return openFifo(config_.target, false);
+        case PcmSourceKind::File: {
+            int fd = ::open(config_.target.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                std::cerr << "❌ Failed to open audio file: " << config_.target << std::endl;
+                return false;
+            }
+            fd_.store(fd);
+            return true;
+        }
+        case PcmSourceKind::Stdin:
+            growPipe(STDIN_FILENO);
+            fd_.store(STDIN_FILENO);
+            return true;
+        case PcmSourceKind::Socket:
+            std::cerr << "❌ Socket sources are adopted, not opened: " << describe() << std::endl;
+            return false;
+    }
+    return false;
+}
+
+bool PcmSource::adopt(int fd) {
+    if (config_.kind != PcmSourceKind::Socket || fd < 0 || fd_.load() >= 0) {
+        return false;
+    }
+    setCloseOnExec(fd);
+    fd_.store(fd);
+    return true;
+}
+
+bool PcmSource::spawn() {
+    std::string command = config_.target;
+    bool via_fifo = false;
+    for (size_t at = command.find("{pipe}"); at != std::string::npos; at = command.find("{pipe}", at)) {
+        command.replace(at, 6, config_.pipe_path);
+        at += config_.pipe_path.size();
+        via_fifo = true;
+    }
+
+    // The FIFO outlives producer restarts; a stdout pipe is made per run
+    int out[2] = {-1, -1};
+    if (via_fifo) {
+        if (fd_.load() < 0 && !openFifo(config_.pipe_path, true)) {
+            return false;
+        }
+    } else {
+        if (pipe(out) != 0) {
+            std::cerr << "❌ Failed to create audio source pipe" << std::endl;
+            return false;
+        }
+        setCloseOnExec(out[0]);
+        setCloseOnExec(out[1]);
+        growPipe(out[0]);
+    }
+
+    // Only async-signal-safe calls between fork and exec: other threads may hold locks
+    const char* shell_command = command.c_str();
+    bool quiet = config_.quiet;
+    pid_t pid = fork();
+    if (pid == 0) {
+        setpgid(0, 0);  // Its own group, so a restart or stop reaches the whole pipeline
+        if (!via_fifo) {
+            dup2(out[1], STDOUT_FILENO);
+        }
+        if (quiet) {
+            int null_fd = ::open("/dev/null", O_WRONLY);
+            if (null_fd >= 0) {
+                dup2(null_fd, STDERR_FILENO);
+            }
+        }
+        execl("/bin/sh", "sh", "-c", shell_command, static_cast<char*>(nullptr));
+        _exit(127);
+    }
+
+    if (!via_fifo) {
+        ::close(out[1]);
+    }
+    if (pid < 0) {
+        std::cerr << "❌ Failed to start audio source: " << command << std::endl;
+        if (!via_fifo) {
+            ::close(out[0]);
+        }
+        return false;
+    }
+
+    setpgid(pid, pid);
+    pid_ = pid;
+    started_at_ = std::chrono::steady_clock::now();
+    if (!via_fifo) {
+        fd_.store(out[0]);
+    }
+    return true;
+}
+
+bool PcmSource::waitReady(const std::atomic<bool>* running) {
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::milliseconds(config_.ready_timeout_ms);
+
+    // Ready is the first audio byte in the pipe; it stays there for the reader
+    while (running == nullptr || running->load()) {
+        struct pollfd pfd = {fd_.load(), POLLIN, 0};
+        if (poll(&pfd, 1, READY_POLL_MS) > 0) {
+            if (pfd.revents & POLLIN) {
+                auto waited = std::chrono::steady_clock::now() - start;
+                ready_us_.store(std::chrono::duration_cast<std::chrono::microseconds>(waited).count());
+                return true;
+            }
+            // Hung up without data: the producer is on its way out
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        if (!producerAlive()) {
+            std::cerr << "❌ Audio source exited before sending audio: " << describe() << std::endl;
+            return false;
+        }
+        if (std::chrono::steady_clock::now() > deadline) {
+            std::cerr << "❌ Audio source sent nothing within " << config_.ready_timeout_ms << "ms: "
+                      << describe() << std::endl;
+            reap();
+            return false;
+        }
+    }
+    return false;
+}
+
+bool PcmSource::openFifo(const std::string& path, bool create) {
+    struct stat info;
+    if (create || stat(path.c_str(), &info) != 0) {
+        unlink(path.c_str());
+        if (mkfifo(path.c_str(), 0600) != 0) {
+            std::cerr << "❌ Failed to create named pipe: " << path << std::endl;
+            return false;
+        }
+        created_fifo_ = true;
+    } else if (!S_ISFIFO(info.st_mode)) {
+        std::cerr << "❌ Not a named pipe: " << path << std::endl;
+        return false;
+    }
+
+    // Non-blocking so the open does not wait for a writer; holding our own
+    // write end means a departing producer never looks like end of stream
+    int fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "❌ Failed to open named pipe: " << path << std::endl;
+        return false;
+    }
+    keeper_fd_ = ::open(path.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    growPipe(fd);
+    fd_.store(fd);
+    return true;
+}
+
+void PcmSource::growPipe(int fd) {
+#ifdef F_SETPIPE_SZ
+    // Unprivileged processes are capped at /proc/sys/fs/pipe-max-size; step
+    // down until the kernel accepts (fails harmlessly on non-pipes)
+    for (size_t bytes = config_.pipe_bytes; bytes >= 65536; bytes /= 2) {
+        if (fcntl(fd, F_SETPIPE_SZ, static_cast<int>(bytes)) >= 0) {
+            break;
+        }
+    }
+    int granted = fcntl(fd, F_GETPIPE_SZ);
+    pipe_bytes_.store(granted > 0 ? static_cast<size_t>(granted) : 0);
+#else
+    (void)fd;
+#endif
+}
+
+bool PcmSource::producerAlive() {
+    if (config_.kind != PcmSourceKind::Command) {
+        return true;
+    }
+    if (pid_ <= 0) {
+        return false;
+    }
+    int status = 0;
+    if (waitpid(pid_, &status, WNOHANG) == pid_) {
+        reportExit(status);
+        pid_ = -1;
+        return false;
+    }
+    return true;
+}
+
+bool PcmSource::recover(const std::atomic<bool>& running) {
+    switch (config_.kind) {
+        case PcmSourceKind::File:
+        case PcmSourceKind::Stdin:
+        case PcmSourceKind::Socket:
+            return false;  // End of the recording, or the client hung up
+        case PcmSourceKind::Fifo:
+            std::this_thread::sleep_for(std::chrono::milliseconds(READY_POLL_MS));
+            return running.load();
+        case PcmSourceKind::Command:
+            break;
+    }
+
+    // Closed its output while still running counts as dead too
+    reap();
+    if (config_.target.find("{pipe}") == std::string::npos) {
+        int fd = fd_.exchange(-1);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    if (!config_.restart) {
+        return false;
+    }
+
+    // A producer that ran for a while starts over with a short delay
+    if (std::chrono::steady_clock::now() - started_at_ >= STABLE_RUN) {
+        restart_delay_ms_ = FIRST_RESTART_DELAY_MS;
+    }
+    while (running.load()) {
+        std::cerr << "🔄 Restarting audio source in " << restart_delay_ms_ << "ms" << std::endl;
+        auto resume = std::chrono::steady_clock::now() + std::chrono::milliseconds(restart_delay_ms_);
+        while (running.load() && std::chrono::steady_clock::now() < resume) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(READY_POLL_MS));
+        }
+        restart_delay_ms_ = std::min(restart_delay_ms_ * 2, config_.max_restart_delay_ms);
+
+        if (running.load() && spawn() && waitReady(&running)) {
+            restarts_.fetch_add(1);
+            std::cerr << "✅ Audio source restarted" << std::endl;
+            return true;
+        }
+        reap();
+    }
+    return false;
+}
+
+void PcmSource::reap() {
+    if (pid_ <= 0) {
+        return;
+    }
+    // The group may not exist yet if the child has not reached setpgid
+    if (kill(-pid_, SIGTERM) != 0) {
+        kill(pid_, SIGTERM);
+    }
+    auto give_up = std::chrono::steady_clock::now() + TERMINATE_GRACE;
+    while (waitpid(pid_, nullptr, WNOHANG) == 0) {
+        if (std::chrono::steady_clock::now() > give_up) {
+            kill(-pid_, SIGKILL);
+            kill(pid_, SIGKILL);
+            waitpid(pid_, nullptr, 0);
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    pid_ = -1;
+}
+
+void PcmSource::close() {
+    reap();
+    int fd = fd_.exchange(-1);
+    if (fd >= 0 && fd != STDIN_FILENO) {
+        ::close(fd);
+    }
+    if (keeper_fd_ >= 0) {
+        ::close(keeper_fd_);
+        keeper_fd_ = -1;
+    }
+    if (created_fifo_) {
+        unlink(config_.kind == PcmSourceKind::Fifo ? config_.target.c_str() : config_.pipe_path.c_str());
+        created_fifo_ = false;
+    }
+}
+
+std::string PcmSource::describe() const {
+    if (config_.kind == PcmSourceKind::Stdin) {
+        return "stdin";
+    }
+    return std::string(pcmSourceKindName(config_.kind)) + ":" + config_.target;
+}
+
+PcmSourceStats PcmSource::stats() const {
+    PcmSourceStats stats;
+    stats.restarts = restarts_.load();
+    stats.pipe_bytes = pipe_bytes_.load();
+    stats.ready_ms = ready_us_.load() / 1000.0;
+    return stats;
+}
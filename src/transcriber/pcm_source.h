@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+
+// Where pipe-transport audio comes from. Every kind ends up as one readable
+// file descriptor carrying the wire format the transcriber was configured
+// for (framed or raw, float32 or s16):
+//
+//   cmd:COMMAND   A producer run through /bin/sh whose stdout is the audio.
+//                 If COMMAND contains {pipe} it is replaced by a FIFO the
+//                 source creates, for producers that write to a path
+//                 (./audio_capture --pipe {pipe}).
+//   fifo:PATH     A FIFO an external producer writes to; writers may come
+//                 and go without ending the stream.
+//   file:PATH     Recorded audio, read to the end without dropping samples.
+//   -             Standard input.
+//
+// A session server hands over an accepted connection with adopt() instead
+// (PcmSourceKind::Socket); the client closing its side ends the stream.
+//
+// Startup waits for the producer's first bytes instead of a fixed delay, and
+// a command that exits is restarted with backoff; the framed protocol's
+// stream_id change tells the reader a new capture began.
+
+enum class PcmSourceKind {
+    Command,
+    Fifo,
+    File,
+    Stdin,
+    Socket
+};
+
+const char* pcmSourceKindName(PcmSourceKind kind);
+
+struct PcmSourceConfig {
+    PcmSourceKind kind = PcmSourceKind::Command;
+    std::string target;                 // Command line or path
+    std::string pipe_path;              // FIFO substituted for {pipe}
+    bool restart = true;                // Restart a command that exits
+    bool quiet = true;                  // Send the producer's stderr to /dev/null
+    int ready_timeout_ms = 10000;       // Time allowed for the first bytes
+    int max_restart_delay_ms = 5000;    // Backoff ceiling between restarts
+    size_t pipe_bytes = 1 << 20;        // Requested pipe capacity (Linux F_SETPIPE_SZ)
+};
+
+// Parses "cmd:...", "fifo:...", "file:..." or "-" into kind and target
+bool parsePcmSource(const std::string& spec, PcmSourceConfig& config);
+
+struct PcmSourceStats {
+    uint64_t restarts = 0;
+    size_t pipe_bytes = 0;     // Capacity the kernel granted; 0 if not a pipe or unknown
+    double ready_ms = 0.0;     // Last start until the first bytes arrived
+};
+
+class PcmSource {
+public:
+    explicit PcmSource(const PcmSourceConfig& config);
+    ~PcmSource();
+
+    PcmSource(const PcmSource&) = delete;
+    PcmSource& operator=(const PcmSource&) = delete;
+
+    // Starts the producer and, for commands, waits until its first bytes are
+    // readable; false if it could not start or exited first
+    bool open();
+    // Takes ownership of an already open descriptor (PcmSourceKind::Socket)
+    bool adopt(int fd);
+    // Called by the reader on end of stream or when reads stall: restarts a
+    // dead command (waiting out the backoff while running holds) and returns
+    // true if there is a stream to keep reading
+    bool recover(const std::atomic<bool>& running);
+    // Whether the producer is still running; always true for non-commands
+    bool producerAlive();
+    void close();
+
+    int fd() const { return fd_.load(); }
+    // Recorded audio can be read as fast as the consumer takes it
+    bool isLive() const { return config_.kind != PcmSourceKind::File; }
+    std::string describe() const;
+    PcmSourceStats stats() const;
+
+private:
+    bool spawn();
+    bool waitReady(const std::atomic<bool>* running);
+    bool openFifo(const std::string& path, bool create);
+    void reap();  // Stops the producer and waits for it
+    void growPipe(int fd);
+
+    PcmSourceConfig config_;
+    std::atomic<int> fd_{-1};
+    int keeper_fd_ = -1;          // Write end held open so a FIFO never reports EOF
+    pid_t pid_ = -1;
+    bool created_fifo_ = false;
+    int restart_delay_ms_ = 0;
+    std::chrono::steady_clock::time_point started_at_;
+    std::atomic<uint64_t> restarts_{0};
+    std::atomic<size_t> pipe_bytes_{0};
+    std::atomic<int64_t> ready_us_{0};
+};
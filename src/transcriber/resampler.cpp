@@ -0,0 +1,244 @@
+#include "resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RESAMPLER_X86 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define RESAMPLER_NEON 1
+#endif
+
+namespace {
+
+constexpr double ROLLOFF = 0.95;       // Passband edge as a fraction of the lower Nyquist
+constexpr double KAISER_BETA = 8.0;
+
+using DotFn = float (*)(const float*, const float*, size_t);
+
+float dotScalar(const float* a, const float* b, size_t count) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+#ifdef RESAMPLER_X86
+float dotSse(const float* a, const float* b, size_t count) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(acc0, acc1));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + dotScalar(a + i, b + i, count - i);
+}
+
+__attribute__((target("avx2,fma")))
+float dotAvx2(const float* a, const float* b, size_t count) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    float lanes[4];
+    _mm_storeu_ps(lanes, sum);
+    // Finish here rather than in dotSse: mixing legacy SSE code into AVX
+    // state costs more than the tail itself
+    float tail = 0.0f;
+    for (; i < count; i++) {
+        tail += a[i] * b[i];
+    }
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + tail;
+}
+#endif
+
+#ifdef RESAMPLER_NEON
+float dotNeon(const float* a, const float* b, size_t count) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    float32x4_t acc = vaddq_f32(acc0, acc1);
+    float sum = vgetq_lane_f32(acc, 0) + vgetq_lane_f32(acc, 1) +
+                vgetq_lane_f32(acc, 2) + vgetq_lane_f32(acc, 3);
+    return sum + dotScalar(a + i, b + i, count - i);
+}
+#endif
+
+struct DotImpl {
+    DotFn fn;
+    const char* isa;
+};
+
+DotImpl selectImpl() {
+#ifdef RESAMPLER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return {dotAvx2, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return {dotSse, "sse2"};
+    }
+#elif defined(RESAMPLER_NEON)
+    return {dotNeon, "neon"};
+#endif
+    return {dotScalar, "scalar"};
+}
+
+const DotImpl& impl() {
+    static const DotImpl selected = selectImpl();
+    return selected;
+}
+
+// Zeroth-order modified Bessel function of the first kind (Kaiser window)
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50 && term > sum * 1e-12; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+} // namespace
+
+PolyphaseResampler::PolyphaseResampler(uint32_t input_rate, uint32_t output_rate, int zero_crossings)
+    : input_rate_(input_rate)
+    , output_rate_(output_rate) {
+    uint32_t divisor = std::gcd(input_rate, output_rate);
+    up_ = output_rate / divisor;
+    down_ = input_rate / divisor;
+
+    // Prototype low-pass at the virtual rate input_rate * L, cut off just
+    // below the lower of the two Nyquist frequencies
+    const double cutoff = ROLLOFF * std::min(input_rate, output_rate) / (double(input_rate) * up_);
+    const size_t half = static_cast<size_t>(std::ceil(zero_crossings / cutoff));
+    taps_ = (2 * half + 1 + up_ - 1) / up_;
+    centre_ = half;
+    lookahead_ = half / up_ + 1;
+
+    std::vector<double> prototype(taps_ * up_, 0.0);
+    for (size_t i = 0; i <= 2 * half; i++) {
+        double t = double(i) - double(half);
+        double x = cutoff * t;
+        double sinc = t == 0.0 ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+        double r = t / (half + 1);
+        double window = besselI0(KAISER_BETA * std::sqrt(1.0 - r * r)) / besselI0(KAISER_BETA);
+        prototype[i] = sinc * window;
+    }
+
+    // Split into phases, each normalised to unity DC gain and stored reversed
+    // so an output is a forward dot product over the input history
+    coeffs_.resize(up_ * taps_);
+    for (uint32_t phase = 0; phase < up_; phase++) {
+        double sum = 0.0;
+        for (size_t k = 0; k < taps_; k++) {
+            sum += prototype[phase + k * up_];
+        }
+        for (size_t k = 0; k < taps_; k++) {
+            coeffs_[phase * taps_ + (taps_ - 1 - k)] = static_cast<float>(prototype[phase + k * up_] / sum);
+        }
+    }
+
+    reset();
+}
+
+void PolyphaseResampler::reset() {
+    // History starts as silence; output 0 puts the prototype centre on input 0
+    history_.assign(taps_ - 1, 0.0f);
+    position_ = centre_;
+    input_samples_ = 0;
+    output_samples_ = 0;
+}
+
+size_t PolyphaseResampler::process(const float* in, size_t count, std::vector<float>& out) {
+    if (passthrough()) {
+        out.insert(out.end(), in, in + count);
+        return count;
+    }
+
+    history_.insert(history_.end(), in, in + count);
+    input_samples_ += count;
+
+    const DotFn dot = impl().fn;
+    const size_t start = out.size();
+    out.reserve(start + (count * up_) / down_ + 1);
+
+    // Emit every output whose filter span is fully inside the history
+    for (;;) {
+        size_t base = position_ / up_;
+        if (base + taps_ > history_.size()) {
+            break;
+        }
+        uint32_t phase = position_ % up_;
+        out.push_back(dot(coeffs_.data() + phase * taps_, history_.data() + base, taps_));
+        position_ += down_;
+    }
+
+    // Drop input no later output can reach
+    size_t consumed = std::min<size_t>(position_ / up_, history_.size());
+    history_.erase(history_.begin(), history_.begin() + consumed);
+    position_ -= uint64_t(consumed) * up_;
+
+    output_samples_ += out.size() - start;
+    return out.size() - start;
+}
+
+size_t PolyphaseResampler::flush(std::vector<float>& out) {
+    if (passthrough()) {
+        return 0;
+    }
+    // Pad with silence, then keep only the outputs that fall inside the input
+    const uint64_t expected = (input_samples_ * up_ + down_ - 1) / down_;
+    std::vector<float> silence(lookahead_, 0.0f);
+    size_t produced = process(silence.data(), silence.size(), out);
+    if (output_samples_ > expected) {
+        size_t excess = std::min<uint64_t>(output_samples_ - expected, produced);
+        out.resize(out.size() - excess);
+        produced -= excess;
+    }
+    reset();
+    return produced;
+}
+
+void downmixToMono(const float* in, size_t frames, uint16_t channels, float* out) {
+    if (channels == 1) {
+        if (in != out) {
+            std::copy(in, in + frames, out);
+        }
+        return;
+    }
+    if (channels == 2) {
+        for (size_t i = 0; i < frames; i++) {
+            out[i] = 0.5f * (in[2 * i] + in[2 * i + 1]);
+        }
+        return;
+    }
+    const float scale = 1.0f / channels;
+    for (size_t i = 0; i < frames; i++) {
+        float sum = 0.0f;
+        for (uint16_t c = 0; c < channels; c++) {
+            sum += in[i * channels + c];
+        }
+        out[i] = sum * scale;
+    }
+}
+
+const char* resamplerIsa() {
+    return impl().isa;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Streaming sample-rate conversion and channel downmixing for capture sources
+// that do not deliver 16 kHz mono (8 / 22.05 / 44.1 / 48 kHz, mono or stereo).
+//
+// PolyphaseResampler is a windowed-sinc (Kaiser) filter evaluated only at the
+// output instants: the rate ratio is reduced to L/M and the prototype filter is
+// split into L phases, so each output sample is one short dot product over the
+// input history. Output sample n is aligned with input time n * M / L; the
+// filter looks ahead by latency() input samples, which flush() supplies as
+// silence at the end of a stream.
+class PolyphaseResampler {
+public:
+    // zero_crossings sets the filter half-length (quality vs. CPU); 16 keeps
+    // stopband rejection near 80 dB with a 5% transition band below Nyquist
+    PolyphaseResampler(uint32_t input_rate, uint32_t output_rate, int zero_crossings = 16);
+
+    // Appends the output for count new input samples to out; returns how many
+    // samples were appended
+    size_t process(const float* in, size_t count, std::vector<float>& out);
+
+    // Drains the lookahead at end of stream
+    size_t flush(std::vector<float>& out);
+
+    void reset();
+
+    uint32_t inputRate() const { return input_rate_; }
+    uint32_t outputRate() const { return output_rate_; }
+    size_t latency() const { return lookahead_; }  // Input samples
+    bool passthrough() const { return input_rate_ == output_rate_; }
+
+private:
+    uint32_t input_rate_;
+    uint32_t output_rate_;
+    uint32_t up_;                    // L: interpolation factor
+    uint32_t down_;                  // M: decimation factor
+    size_t taps_;                    // Coefficients per phase
+    uint64_t centre_;                // Prototype centre, in 1/L input samples
+    size_t lookahead_;               // Input samples needed past an output instant
+    std::vector<float> coeffs_;      // up_ phases x taps_, each reversed for a forward dot product
+    std::vector<float> history_;     // taps_ - 1 samples of history followed by pending input
+    uint64_t position_;              // Next output instant in 1/L input samples from history_[0]
+    uint64_t input_samples_;         // Since reset, to trim the flushed tail
+    uint64_t output_samples_;
+};
+
+// Averages interleaved channels into mono; out may be the same buffer as in
+void downmixToMono(const float* in, size_t frames, uint16_t channels, float* out);
+
+// Name of the selected dot-product implementation, for diagnostics
+const char* resamplerIsa();
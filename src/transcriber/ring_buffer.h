@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <algorithm>
+
+// Cache line size used to keep producer and consumer indices apart
+static constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Lock-free single-producer/single-consumer ring buffer.
+//
+// Exactly one thread may call write() and exactly one other thread may call
+// read(). Capacity is rounded up to a power of two so indices wrap with a mask;
+// head and tail are free-running counters on separate cache lines.
+template <typename T>
+class SpscRingBuffer {
+public:
+    explicit SpscRingBuffer(size_t capacity)
+        : capacity_(roundUpPow2(std::max<size_t>(capacity, 2)))
+        , mask_(capacity_ - 1)
+        , data_(std::make_unique<T[]>(capacity_)) {
+    }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    // Producer: copies up to count items, returns how many were written
+    size_t write(const T* items, size_t count) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        const size_t to_write = std::min(count, capacity_ - (head - tail));
+
+        const size_t offset = head & mask_;
+        const size_t first = std::min(to_write, capacity_ - offset);
+        std::copy(items, items + first, data_.get() + offset);
+        std::copy(items + first, items + to_write, data_.get());
+
+        head_.store(head + to_write, std::memory_order_release);
+        return to_write;
+    }
+
+    // Consumer: copies up to count items, returns how many were read
+    size_t read(T* items, size_t count) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t head = head_.load(std::memory_order_acquire);
+        const size_t to_read = std::min(count, head - tail);
+
+        const size_t offset = tail & mask_;
+        const size_t first = std::min(to_read, capacity_ - offset);
+        std::copy(data_.get() + offset, data_.get() + offset + first, items);
+        std::copy(data_.get(), data_.get() + (to_read - first), items + first);
+
+        tail_.store(tail + to_read, std::memory_order_release);
+        return to_read;
+    }
+
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    static size_t roundUpPow2(size_t n) {
+        size_t p = 1;
+        while (p < n) {
+            p <<= 1;
+        }
+        return p;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<T[]> data_;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0}; // Written by producer
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0}; // Written by consumer
+};
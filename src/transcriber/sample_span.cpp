@@ -0,0 +1,116 @@
+#include "sample_span.h"
+#include "audio_energy.h"
+#include <algorithm>
+#include <cstring>
+
+void SampleSpan::append(const SampleBlockPtr& block, size_t offset, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    const float* data = block.data() + offset;
+    if (!segments_.empty()) {
+        Segment& last = segments_.back();
+        if (last.block == block && last.data + last.count == data) {
+            last.count += count;
+            size_ += count;
+            return;
+        }
+    }
+    segments_.push_back({block, data, count});
+    size_ += count;
+}
+
+void SampleSpan::append(const SampleSpan& other, size_t skip) {
+    for (const Segment& segment : other.segments_) {
+        if (skip >= segment.count) {
+            skip -= segment.count;
+            continue;
+        }
+        size_t offset = (segment.data - segment.block.data()) + skip;
+        append(segment.block, offset, segment.count - skip);
+        skip = 0;
+    }
+}
+
+namespace {
+
+// No pool owns it and its first reference is never dropped, so it lives for
+// the process
+const SampleBlockPtr& silenceBlock() {
+    static const SampleBlockPtr* block = [] {
+        SampleBlock* zeroed = new SampleBlock();
+        std::fill(zeroed->samples, zeroed->samples + SAMPLE_BLOCK_SIZE, 0.0f);
+        return new SampleBlockPtr(zeroed);
+    }();
+    return *block;
+}
+
+} // namespace
+
+void SampleSpan::appendSilence(size_t count) {
+    while (count > 0) {
+        size_t n = std::min(count, SAMPLE_BLOCK_SIZE);
+        append(silenceBlock(), 0, n);
+        count -= n;
+    }
+}
+
+void SampleSpan::assign(const SampleSpan& other, size_t offset, size_t count) {
+    clear();
+    for (const Segment& segment : other.segments_) {
+        if (count == 0) {
+            break;
+        }
+        if (offset >= segment.count) {
+            offset -= segment.count;
+            continue;
+        }
+        size_t take = std::min(segment.count - offset, count);
+        append(segment.block, (segment.data - segment.block.data()) + offset, take);
+        count -= take;
+        offset = 0;
+    }
+}
+
+void SampleSpan::trim(size_t head, size_t tail) {
+    if (head + tail >= size_) {
+        clear();
+        return;
+    }
+    size_ -= head + tail;
+
+    size_t dropped = 0;
+    while (head >= segments_[dropped].count) {
+        head -= segments_[dropped].count;
+        dropped++;
+    }
+    segments_.erase(segments_.begin(), segments_.begin() + dropped);
+    segments_.front().data += head;
+    segments_.front().count -= head;
+
+    while (tail >= segments_.back().count) {
+        tail -= segments_.back().count;
+        segments_.pop_back();
+    }
+    segments_.back().count -= tail;
+}
+
+void SampleSpan::clear() {
+    segments_.clear();
+    size_ = 0;
+}
+
+void SampleSpan::copyTo(float* out) const {
+    for (const Segment& segment : segments_) {
+        std::memcpy(out, segment.data, segment.count * sizeof(float));
+        out += segment.count;
+    }
+}
+
+float SampleSpan::sumOfSquares() const {
+    float sum = 0.0f;
+    for (const Segment& segment : segments_) {
+        sum += energySumOfSquares(segment.data, segment.count);
+    }
+    return sum;
+}
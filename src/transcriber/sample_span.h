@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Audio is buffered in fixed-size blocks that are shared, not copied, between
+// the chunker and the chunks it emits. A SampleSpan is a read-only view over
+// a run of samples spread across one or more blocks; each segment holds a
+// reference to its block, so a block lives until the last span using it is
+// gone. Consecutive chunks share the blocks under their overlap.
+
+static constexpr size_t SAMPLE_BLOCK_SIZE = 4096;
+
+class AudioBlockPool;
+
+// Samples first so they start on the block's 64-byte (cache line) alignment
+struct alignas(64) SampleBlock {
+    float samples[SAMPLE_BLOCK_SIZE];
+    std::atomic<uint32_t> refs{0};
+    AudioBlockPool* pool = nullptr;    // Owner the block returns to; null once orphaned
+    SampleBlock* next_free = nullptr;  // Pool free list link
+};
+
+// Hands a block whose last reference was dropped back to its pool
+void releaseSampleBlock(SampleBlock* block);
+
+// Intrusive reference to a pooled block; copying never allocates
+class SampleBlockPtr {
+public:
+    SampleBlockPtr() = default;
+    explicit SampleBlockPtr(SampleBlock* block) : block_(block) { retain(); }
+    SampleBlockPtr(const SampleBlockPtr& other) : block_(other.block_) { retain(); }
+    SampleBlockPtr(SampleBlockPtr&& other) noexcept : block_(other.block_) { other.block_ = nullptr; }
+    ~SampleBlockPtr() { release(); }
+
+    SampleBlockPtr& operator=(const SampleBlockPtr& other) {
+        if (block_ != other.block_) {
+            release();
+            block_ = other.block_;
+            retain();
+        }
+        return *this;
+    }
+    SampleBlockPtr& operator=(SampleBlockPtr&& other) noexcept {
+        if (this != &other) {
+            release();
+            block_ = other.block_;
+            other.block_ = nullptr;
+        }
+        return *this;
+    }
+
+    void reset() {
+        release();
+        block_ = nullptr;
+    }
+
+    float* data() const { return block_->samples; }
+    SampleBlock* get() const { return block_; }
+    explicit operator bool() const { return block_ != nullptr; }
+    bool operator==(const SampleBlockPtr& other) const { return block_ == other.block_; }
+
+private:
+    void retain() {
+        if (block_) {
+            block_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    void release() {
+        if (block_ && block_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            releaseSampleBlock(block_);
+        }
+    }
+
+    SampleBlock* block_ = nullptr;
+};
+
+class SampleSpan {
+public:
+    struct Segment {
+        SampleBlockPtr block;
+        const float* data;
+        size_t count;
+    };
+
+    SampleSpan() = default;
+
+    // Appends count samples of block starting at offset, merging with the
+    // last segment when they are contiguous in the same block
+    void append(const SampleBlockPtr& block, size_t offset, size_t count);
+    // Appends other, skipping its first skip samples
+    void append(const SampleSpan& other, size_t skip = 0);
+    // Appends count samples of silence, shared from one zeroed block
+    void appendSilence(size_t count);
+
+    // Replaces the contents with count samples of other starting at offset
+    // (clamped to other); other must be a different span
+    void assign(const SampleSpan& other, size_t offset, size_t count);
+
+    // Drops head samples from the front and tail from the back in place,
+    // releasing blocks no longer covered
+    void trim(size_t head, size_t tail);
+    // Drops all block references but keeps segment storage for reuse
+    void clear();
+
+    // Gathers the samples into contiguous memory (whisper needs one buffer)
+    void copyTo(float* out) const;
+
+    float sumOfSquares() const;
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const std::vector<Segment>& segments() const { return segments_; }
+
+private:
+    std::vector<Segment> segments_;
+    size_t size_ = 0;
+};
@@ -0,0 +1,440 @@
+#include "session_server.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int SAMPLE_RATE = 16000;
+constexpr size_t MAX_HEADER_BYTES = 4096;
+constexpr int HEADER_TIMEOUT_MS = 5000;
+constexpr int ACCEPT_POLL_MS = 200;
+constexpr int SEND_TIMEOUT_MS = 2000;  // A client this far behind on reading is dropped
+
+void setCloseOnExec(int fd) {
+    fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) | FD_CLOEXEC);
+}
+
+// A client that hangs up must not take the daemon down with SIGPIPE
+bool sendAll(int fd, const std::string& data) {
+    int flags = 0;
+#ifdef MSG_NOSIGNAL
+    flags = MSG_NOSIGNAL;
+#endif
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t written = send(fd, data.data() + sent, data.size() - sent, flags);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        sent += written;
+    }
+    return true;
+}
+
+bool sendLine(int fd, const std::string& line) {
+    return sendAll(fd, line + "\n");
+}
+
+bool parseFlag(const std::string& value, bool& flag) {
+    if (value == "1" || value == "true" || value == "yes") {
+        flag = true;
+    } else if (value == "0" || value == "false" || value == "no") {
+        flag = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parsePositive(const std::string& value, double& number) {
+    char* end = nullptr;
+    number = std::strtod(value.c_str(), &end);
+    return !value.empty() && *end == '\0' && number > 0.0;
+}
+
+} // namespace
+
+SessionServer::SessionServer(const SessionServerConfig& config, const TranscriptionConfig& defaults)
+    : config_(config)
+    , defaults_(defaults) {
+    defaults_.transport = AudioTransport::Pipe;
+    int workers = config_.decode_workers;
+    if (workers <= 0) {
+        int cores = static_cast<int>(std::thread::hardware_concurrency());
+        workers = std::max(1, cores / std::max(1, defaults_.threads));
+    }
+    scheduler_ = std::make_unique<DecodeScheduler>(workers);
+}
+
+SessionServer::~SessionServer() {
+    stop();
+}
+
+bool SessionServer::start() {
+    model_ = WhisperModel::acquire(defaults_.model_path, true);
+    if (!model_) {
+        return false;
+    }
+
+    struct sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (config_.socket_path.empty() || config_.socket_path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "❌ Socket path must be 1-" << sizeof(address.sun_path) - 1 << " bytes: "
+                  << config_.socket_path << std::endl;
+        return false;
+    }
+    std::strncpy(address.sun_path, config_.socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+    // A socket left behind by a daemon that did not shut down cleanly
+    struct stat info;
+    if (lstat(config_.socket_path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+        unlink(config_.socket_path.c_str());
+    }
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "❌ Failed to create session socket" << std::endl;
+        return false;
+    }
+    setCloseOnExec(listen_fd_);
+    if (bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listen_fd_, SOMAXCONN) != 0) {
+        std::cerr << "❌ Failed to listen on " << config_.socket_path << ": " << std::strerror(errno) << std::endl;
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    chmod(config_.socket_path.c_str(), 0600);
+
+    running_.store(true);
+    accept_thread_ = std::thread(&SessionServer::acceptThread, this);
+
+    DecodeSchedulerStats scheduler = scheduler_->stats();
+    std::cout << "🛰️ Serving sessions on " << config_.socket_path << " (up to " << config_.max_sessions
+              << " sessions, " << scheduler.workers << " decode workers x " << defaults_.threads
+              << " threads)" << std::endl;
+    return true;
+}
+
+void SessionServer::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (accept_thread_.joinable()) {
+        accept_thread_.join();
+    }
+    close(listen_fd_);
+    listen_fd_ = -1;
+    unlink(config_.socket_path.c_str());
+
+    // Hanging up on every client ends its reader; each session then stops itself
+    std::list<std::unique_ptr<Session>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (auto& session : sessions_) {
+            if (session->fd >= 0) {
+                shutdown(session->fd, SHUT_RDWR);
+            }
+        }
+        sessions.swap(sessions_);
+    }
+    for (auto& session : sessions) {
+        session->thread.join();
+    }
+    model_.reset();
+}
+
+SessionServerStats SessionServer::stats() const {
+    SessionServerStats stats;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (const auto& session : sessions_) {
+            stats.active += session->finished.load() ? 0 : 1;
+        }
+    }
+    stats.served = served_.load();
+    stats.rejected = rejected_.load();
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    stats.first_session_bytes = first_session_bytes_;
+    stats.measured_sessions = measured_sessions_;
+    stats.session_bytes = measured_sessions_ ? measured_session_bytes_ / measured_sessions_ : 0;
+    return stats;
+}
+
+void SessionServer::recordSessionMemory(bool first, size_t bytes) {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    if (first) {
+        first_session_bytes_ = bytes;
+    } else {
+        measured_sessions_++;
+        measured_session_bytes_ += bytes;
+    }
+}
+
+void SessionServer::acceptThread() {
+    while (running_.load()) {
+        struct pollfd pfd = {listen_fd_, POLLIN, 0};
+        if (poll(&pfd, 1, ACCEPT_POLL_MS) <= 0) {
+            reapFinished();
+            continue;
+        }
+        int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+        setCloseOnExec(fd);
+#ifdef SO_NOSIGPIPE
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        // A session thread blocked on a client that stopped reading gives up
+        struct timeval send_timeout = {SEND_TIMEOUT_MS / 1000, (SEND_TIMEOUT_MS % 1000) * 1000};
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+        reapFinished();
+
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        if (sessions_.size() >= static_cast<size_t>(std::max(1, config_.max_sessions))) {
+            sendLine(fd, "error server full");
+            close(fd);
+            rejected_.fetch_add(1);
+            continue;
+        }
+        auto session = std::make_unique<Session>();
+        session->id = next_session_++;
+        session->fd = fd;
+        session->thread = std::thread(&SessionServer::sessionThread, this, session.get());
+        sessions_.push_back(std::move(session));
+    }
+}
+
+void SessionServer::reapFinished() {
+    std::list<std::unique_ptr<Session>> finished;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (auto it = sessions_.begin(); it != sessions_.end();) {
+            auto current = it++;
+            if ((*current)->finished.load()) {
+                finished.splice(finished.end(), sessions_, current);
+            }
+        }
+    }
+    for (auto& session : finished) {
+        session->thread.join();
+    }
+}
+
+void SessionServer::sessionThread(Session* session) {
+    int fd = session->fd;
+    std::string name = "session " + std::to_string(session->id);
+    auto finish = [&]() {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        close(session->fd);
+        session->fd = -1;
+        session->finished.store(true);
+    };
+    auto reject = [&](const std::string& reason) {
+        std::cerr << "⚠️ Rejected " << name << ": " << reason << std::endl;
+        sendLine(fd, "error " + reason);
+        rejected_.fetch_add(1);
+        finish();
+    };
+
+    std::string header;
+    TranscriptionConfig config = defaults_;
+    std::string error;
+    if (!readHeader(fd, header)) {
+        reject("expected a header line");
+        return;
+    }
+    if (!parseHeader(header, config, error)) {
+        reject(error);
+        return;
+    }
+
+    // The model is shared; what this costs is the session's own state. The
+    // process RSS only tells when no other session set up meanwhile.
+    bool alone = setting_up_.fetch_add(1) == 0;
+    uint64_t setup = setups_started_.fetch_add(1);
+    size_t resident_before = residentMemoryBytes();
+    auto transcriber = std::make_unique<StreamingTranscriber>(config);
+    transcriber->useScheduler(scheduler_.get());
+    bool initialized = transcriber->initialize();
+    size_t resident_after = residentMemoryBytes();
+    alone = alone && setups_started_.load() == setup + 1;
+    setting_up_.fetch_sub(1);
+    if (!initialized) {
+        reject("failed to load model " + config.model_path);
+        return;
+    }
+    size_t session_bytes = resident_after > resident_before ? resident_after - resident_before : 0;
+    bool first = served_.load() == 0;
+
+    PcmSourceConfig source_config;
+    source_config.kind = PcmSourceKind::Socket;
+    source_config.target = name;
+    PcmSource source(source_config);
+    if (!source.adopt(dup(fd))) {
+        reject("failed to read from the connection");
+        return;
+    }
+
+    // Results arrive on a shared scheduler worker (one at a time), which only
+    // queues their lines; this thread writes them, so a client slow to read
+    // holds up its own session and never the decode pool
+    std::mutex outbox_mutex;
+    std::condition_variable outbox_ready;
+    std::string outbox;
+    auto on_result = [&](const TranscriptionResult& result) {
+        std::ostringstream lines;
+        lines << std::fixed << std::setprecision(2);
+        if (!result.text.empty()) {
+            lines << (result.is_partial ? "partial" : "final") << '\t' << double(result.start_sample) / SAMPLE_RATE
+                  << '\t' << double(result.end_sample) / SAMPLE_RATE << '\t' << result.text << '\n';
+        }
+        if (result.ends_utterance) {
+            lines << "end\t" << double(result.end_sample) / SAMPLE_RATE << '\n';
+        }
+        {
+            std::lock_guard<std::mutex> lock(outbox_mutex);
+            outbox += lines.str();
+        }
+        outbox_ready.notify_one();
+    };
+    auto send_queued = [&]() {
+        std::string data;
+        {
+            std::lock_guard<std::mutex> lock(outbox_mutex);
+            data.swap(outbox);
+        }
+        return data.empty() || sendAll(fd, data);
+    };
+
+    sendLine(fd, "ok " + std::to_string(session->id));
+    served_.fetch_add(1);
+    if (alone) {
+        recordSessionMemory(first, session_bytes);
+    }
+    auto started = std::chrono::steady_clock::now();
+    std::cout << "🔌 Opened " << name << " (" << config.language << ", "
+              << (config.streaming_partials ? "partials" : "chunks") << ", "
+              << decodePriorityName(config.decode_priority);
+    if (alone) {
+        std::cout << ", +" << session_bytes / (1024 * 1024) << " MiB resident";
+    }
+    std::cout << ")" << std::endl;
+
+    transcriber->start(source, on_result);
+    bool drained = false;
+    while (running_.load() && transcriber->isRunning()) {
+        // Checked before sending: every result of an ended source is queued by then
+        bool ended = transcriber->sourceEnded();
+        if (!send_queued()) {
+            break;
+        }
+        if (ended) {
+            drained = true;
+            break;
+        }
+        std::unique_lock<std::mutex> lock(outbox_mutex);
+        outbox_ready.wait_for(lock, std::chrono::milliseconds(50), [&]() { return !outbox.empty(); });
+    }
+    transcriber->stop();
+    source.close();
+    if (drained) {
+        sendLine(fd, "done");
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::cout << "👋 Closed " << name << " after " << std::fixed << std::setprecision(1) << seconds << "s"
+              << std::defaultfloat << std::endl;
+    finish();
+}
+
+bool SessionServer::readHeader(int fd, std::string& header) {
+    // One byte at a time: everything after the newline is audio for the reader
+    header.clear();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(HEADER_TIMEOUT_MS);
+    while (header.size() < MAX_HEADER_BYTES && running_.load()) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (left.count() <= 0) {
+            return false;
+        }
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, static_cast<int>(std::min<int64_t>(left.count(), ACCEPT_POLL_MS))) <= 0) {
+            continue;
+        }
+        char c;
+        ssize_t bytes_read = read(fd, &c, 1);
+        if (bytes_read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytes_read <= 0) {
+            return false;
+        }
+        if (c == '\n') {
+            return true;
+        }
+        header += c;
+    }
+    return false;
+}
+
+bool SessionServer::parseHeader(const std::string& header, TranscriptionConfig& config, std::string& error) {
+    std::istringstream options(header);
+    std::string option;
+    while (options >> option) {
+        size_t equals = option.find('=');
+        std::string key = option.substr(0, equals);
+        std::string value = equals == std::string::npos ? "" : option.substr(equals + 1);
+        bool flag = false;
+        double number = 0.0;
+        DecodePriority priority;
+        if (key == "language" && !value.empty()) {
+            config.language = value;
+        } else if (key == "translate" && parseFlag(value, flag)) {
+            config.translate = flag;
+        } else if (key == "partials" && parseFlag(value, flag)) {
+            config.streaming_partials = flag;
+        } else if (key == "vad" && parseFlag(value, flag)) {
+            config.enable_vad = flag;
+        } else if (key == "framed" && parseFlag(value, flag)) {
+            config.framed_input = flag;
+        } else if (key == "format" && (value == "f32" || value == "s16")) {
+            config.raw_format = value == "s16" ? AudioSampleFormat::Int16 : AudioSampleFormat::Float32;
+        } else if (key == "model" && !value.empty()) {
+            if (access(value.c_str(), R_OK) != 0) {
+                error = "model not found: " + value;
+                return false;
+            }
+            config.model_path = value;
+        } else if (key == "priority" && parseDecodePriority(value, priority)) {
+            config.decode_priority = priority;
+        } else if (key == "weight" && parsePositive(value, number)) {
+            config.decode_weight = static_cast<float>(number);
+        } else if (key == "slo" && parsePositive(value, number)) {
+            config.latency_slo_ms = static_cast<int>(number);
+        } else {
+            error = "bad option: " + option;
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "transcriber.h"
+#include "decode_scheduler.h"
+#include "whisper_model.h"
+
+// Long-running daemon mode: one process serves many audio streams over a
+// local Unix socket. Each connection is a session with its own chunker, VAD,
+// context window and whisper_state. The model is loaded once and shared, and
+// decoding runs on one DecodeScheduler worker pool for all sessions.
+//
+// Protocol, one connection per stream:
+//   client  one header line of key=value options, then raw or framed audio:
+//             language=de translate=1 format=s16 framed=0 partials=1 model=PATH
+//             priority=live|near-live|batch weight=2 slo=MS (see DecodeScheduler)
+//   server  "ok <session>" or "error <reason>", then one line per result:
+//             final<TAB>start<TAB>end<TAB>text    committed text, never revised
+//             partial<TAB>start<TAB>end<TAB>text  unconfirmed words (partials=1)
+//             end<TAB>time                        an utterance closed (partials=1)
+//           and "done" once the client has shut down its write side and
+//           everything it sent has been decoded.
+
+struct SessionServerConfig {
+    std::string socket_path;
+    int max_sessions = 32;
+    int decode_workers = 0;          // 0 = cores / threads per decode
+};
+
+struct SessionServerStats {
+    size_t active = 0;
+    uint64_t served = 0;             // Sessions that reached "ok"
+    uint64_t rejected = 0;           // Bad header, model failure or server full
+
+    // RSS growth while a session set up (transcriber, state, warmup decode),
+    // counted only for sessions that set up while no other one did
+    size_t first_session_bytes = 0;  // The first session served; 0 if not measured
+    uint64_t measured_sessions = 0;  // Later sessions measured
+    size_t session_bytes = 0;        // Their mean
+};
+
+class SessionServer {
+public:
+    // defaults supplies every option a session header does not override
+    SessionServer(const SessionServerConfig& config, const TranscriptionConfig& defaults);
+    ~SessionServer();
+
+    SessionServer(const SessionServer&) = delete;
+    SessionServer& operator=(const SessionServer&) = delete;
+
+    // Loads the default model and starts listening
+    bool start();
+    // Ends every session and removes the socket
+    void stop();
+
+    SessionServerStats stats() const;
+    DecodeSchedulerStats schedulerStats() const { return scheduler_->stats(); }
+
+private:
+    struct Session {
+        uint64_t id = 0;
+        int fd = -1;
+        std::thread thread;
+        std::atomic<bool> finished{false};
+    };
+
+    void acceptThread();
+    void sessionThread(Session* session);
+    bool readHeader(int fd, std::string& header);
+    bool parseHeader(const std::string& header, TranscriptionConfig& config, std::string& error);
+    void reapFinished();
+    void recordSessionMemory(bool first, size_t bytes);
+
+    SessionServerConfig config_;
+    TranscriptionConfig defaults_;
+    std::shared_ptr<WhisperModel> model_;         // Keeps the default model loaded between sessions
+    std::unique_ptr<DecodeScheduler> scheduler_;
+    int listen_fd_ = -1;
+    std::atomic<bool> running_{false};
+    std::thread accept_thread_;
+
+    mutable std::mutex sessions_mutex_;
+    std::list<std::unique_ptr<Session>> sessions_;
+    uint64_t next_session_ = 1;
+    std::atomic<uint64_t> served_{0};
+    std::atomic<uint64_t> rejected_{0};
+
+    // Session setup memory; a measurement is discarded when setups overlap
+    std::atomic<int> setting_up_{0};
+    std::atomic<uint64_t> setups_started_{0};
+    size_t first_session_bytes_ = 0;       // Under sessions_mutex_, like the rest
+    uint64_t measured_sessions_ = 0;
+    uint64_t measured_session_bytes_ = 0;
+};
@@ -0,0 +1,249 @@
+#include "shm_ring.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+
+namespace {
+
+// Sample data starts on the first cache line after the header
+constexpr size_t SHM_DATA_OFFSET =
+    (sizeof(ShmRingHeader) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+
+void futexWait(std::atomic<uint32_t>* word, uint32_t expected, int timeout_ms) {
+#ifdef __linux__
+    struct timespec timeout = {timeout_ms / 1000, (timeout_ms % 1000) * 1000000L};
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+#else
+    (void)word;
+    (void)expected;
+    std::this_thread::sleep_for(std::chrono::milliseconds(std::min(timeout_ms, 2)));
+#endif
+}
+
+void futexWake(std::atomic<uint32_t>* word) {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+size_t roundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+} // namespace
+
+ShmAudioRing::ShmAudioRing()
+    : owner_(false)
+    , mapping_(nullptr)
+    , mapping_bytes_(0)
+    , header_(nullptr)
+    , data_(nullptr) {
+}
+
+ShmAudioRing::~ShmAudioRing() {
+    if (mapping_) {
+        munmap(mapping_, mapping_bytes_);
+    }
+    if (owner_) {
+        shm_unlink(name_.c_str());
+    }
+}
+
+bool ShmAudioRing::create(const std::string& name, size_t capacity, uint32_t sample_rate) {
+    capacity = roundUpPow2(std::max<size_t>(capacity, 1024));
+    size_t bytes = SHM_DATA_OFFSET + capacity * sizeof(float);
+
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        std::cerr << "❌ Failed to create shared memory ring: " << name << std::endl;
+        return false;
+    }
+    if (ftruncate(fd, bytes) != 0 || !map(fd, bytes)) {
+        std::cerr << "❌ Failed to size shared memory ring: " << name << std::endl;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    ::close(fd);
+
+    name_ = name;
+    owner_ = true;
+
+    header_ = new (mapping_) ShmRingHeader();
+    header_->sample_rate = sample_rate;
+    header_->capacity = static_cast<uint32_t>(capacity);
+    header_->write_pos.store(0);
+    header_->data_seq.store(0);
+    header_->consumer_waiting.store(0);
+    header_->producer_closed.store(0);
+    header_->stream_ended.store(0);
+    header_->dropped.store(0);
+    header_->read_pos.store(0);
+    header_->space_seq.store(0);
+    header_->producer_waiting.store(0);
+    header_->version = SHM_RING_VERSION;
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = SHM_RING_MAGIC;
+
+    return true;
+}
+
+bool ShmAudioRing::attach(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+        std::cerr << "❌ Shared memory ring not found: " << name << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < SHM_DATA_OFFSET || !map(fd, st.st_size)) {
+        std::cerr << "❌ Failed to map shared memory ring: " << name << std::endl;
+        ::close(fd);
+        return false;
+    }
+    ::close(fd);
+
+    header_ = static_cast<ShmRingHeader*>(mapping_);
+    if (header_->magic != SHM_RING_MAGIC || header_->version != SHM_RING_VERSION ||
+        SHM_DATA_OFFSET + size_t(header_->capacity) * sizeof(float) > mapping_bytes_) {
+        std::cerr << "❌ Incompatible shared memory ring: " << name << std::endl;
+        return false;
+    }
+    // Positions are masked with capacity - 1
+    const uint32_t capacity = header_->capacity;
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        std::cerr << "❌ Shared memory ring capacity " << capacity << " is not a power of two: " << name << std::endl;
+        return false;
+    }
+
+    name_ = name;
+    return true;
+}
+
+bool ShmAudioRing::map(int fd, size_t bytes) {
+    void* mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    mapping_ = mapping;
+    mapping_bytes_ = bytes;
+    data_ = reinterpret_cast<float*>(static_cast<char*>(mapping) + SHM_DATA_OFFSET);
+    return true;
+}
+
+size_t ShmAudioRing::write(const float* samples, size_t count) {
+    const size_t capacity = header_->capacity;
+    const uint64_t head = header_->write_pos.load(std::memory_order_relaxed);
+    const uint64_t tail = header_->read_pos.load(std::memory_order_acquire);
+    const size_t to_write = std::min<size_t>(count, capacity - (head - tail));
+    if (to_write == 0) {
+        return 0;
+    }
+
+    const size_t offset = head & (capacity - 1);
+    const size_t first = std::min(to_write, capacity - offset);
+    std::memcpy(data_ + offset, samples, first * sizeof(float));
+    std::memcpy(data_, samples + first, (to_write - first) * sizeof(float));
+
+    // A producer writing again reopens a stream closed by a previous one
+    if (header_->producer_closed.load(std::memory_order_relaxed)) {
+        header_->producer_closed.store(0);
+    }
+
+    header_->write_pos.store(head + to_write);
+    header_->data_seq.fetch_add(1);
+    if (header_->consumer_waiting.load()) {
+        futexWake(&header_->data_seq);
+    }
+    return to_write;
+}
+
+void ShmAudioRing::waitForSpace(int timeout_ms) {
+    uint32_t seq = header_->space_seq.load();
+    header_->producer_waiting.store(1);
+    uint64_t used = header_->write_pos.load(std::memory_order_relaxed) - header_->read_pos.load();
+    if (used >= header_->capacity) {
+        futexWait(&header_->space_seq, seq, timeout_ms);
+    }
+    header_->producer_waiting.store(0);
+}
+
+void ShmAudioRing::addDropped(uint64_t samples) {
+    header_->dropped.fetch_add(samples, std::memory_order_relaxed);
+}
+
+void ShmAudioRing::close() {
+    header_->producer_closed.store(1);
+    header_->data_seq.fetch_add(1);
+    futexWake(&header_->data_seq);
+}
+
+void ShmAudioRing::endStream() {
+    header_->stream_ended.store(1);
+    close();
+}
+
+size_t ShmAudioRing::peek(const float** samples) const {
+    const size_t capacity = header_->capacity;
+    const uint64_t tail = header_->read_pos.load(std::memory_order_relaxed);
+    const uint64_t head = header_->write_pos.load(std::memory_order_acquire);
+    const size_t offset = tail & (capacity - 1);
+    *samples = data_ + offset;
+    return std::min<size_t>(head - tail, capacity - offset);
+}
+
+void ShmAudioRing::consume(size_t count) {
+    header_->read_pos.fetch_add(count);
+    header_->space_seq.fetch_add(1);
+    if (header_->producer_waiting.load()) {
+        futexWake(&header_->space_seq);
+    }
+}
+
+void ShmAudioRing::waitForData(int timeout_ms) {
+    if (producerClosed()) {
+        // Nothing will wake us until a new producer attaches
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::min(timeout_ms, 10)));
+        return;
+    }
+
+    uint32_t seq = header_->data_seq.load();
+    header_->consumer_waiting.store(1);
+    if (header_->write_pos.load() == header_->read_pos.load(std::memory_order_relaxed)) {
+        futexWait(&header_->data_seq, seq, timeout_ms);
+    }
+    header_->consumer_waiting.store(0);
+}
+
+bool ShmAudioRing::producerClosed() const {
+    return header_->producer_closed.load() != 0;
+}
+
+bool ShmAudioRing::streamEnded() const {
+    return header_->stream_ended.load() != 0;
+}
+
+uint64_t ShmAudioRing::dropped() const {
+    return header_->dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "ring_buffer.h"
+
+// Shared-memory audio transport between a capture process and the transcriber.
+//
+// A POSIX shared memory segment holds a control header followed by a
+// power-of-two ring of float32 mono samples. The producer writes samples in
+// place and the consumer hands spans of the mapping straight to the chunker,
+// so audio never passes through a pipe or the kernel. Blocked sides sleep on a futex
+// word in the header (Linux) or poll briefly elsewhere; wakeups are only issued
+// when the other side has announced it is waiting.
+
+static constexpr uint32_t SHM_RING_MAGIC = 0x474e5253;  // "SRNG" little-endian
+static constexpr uint32_t SHM_RING_VERSION = 2;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared ring needs address-free atomics");
+
+struct ShmRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sample_rate;
+    uint32_t capacity;                        // Samples, power of two
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> write_pos;
+    std::atomic<uint32_t> data_seq;           // Bumped per write; consumer futex word
+    std::atomic<uint32_t> consumer_waiting;
+    std::atomic<uint32_t> producer_closed;    // Detached; a later producer may reopen the stream
+    std::atomic<uint32_t> stream_ended;       // No more audio will come; the consumer drains and stops
+    std::atomic<uint64_t> dropped;            // Samples the producer could not fit
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> read_pos;
+    std::atomic<uint32_t> space_seq;          // Bumped per consume; producer futex word
+    std::atomic<uint32_t> producer_waiting;
+};
+
+class ShmAudioRing {
+public:
+    ShmAudioRing();
+    ~ShmAudioRing();
+
+    ShmAudioRing(const ShmAudioRing&) = delete;
+    ShmAudioRing& operator=(const ShmAudioRing&) = delete;
+
+    // Creates and owns the named segment (unlinked on destruction)
+    bool create(const std::string& name, size_t capacity, uint32_t sample_rate);
+    // Maps an existing segment created by another process
+    bool attach(const std::string& name);
+
+    // Producer side
+    size_t write(const float* samples, size_t count);
+    void waitForSpace(int timeout_ms);
+    void addDropped(uint64_t samples);
+    void close();
+    // Closes for good: the consumer chunks what is left and ends its session
+    void endStream();
+
+    // Consumer side: peek returns a contiguous readable span inside the mapping
+    size_t peek(const float** samples) const;
+    void consume(size_t count);
+    void waitForData(int timeout_ms);
+
+    bool producerClosed() const;
+    bool streamEnded() const;
+    uint64_t dropped() const;
+    uint32_t sampleRate() const { return header_->sample_rate; }
+    size_t capacity() const { return header_->capacity; }
+
+private:
+    bool map(int fd, size_t bytes);
+
+    std::string name_;
+    bool owner_;
+    void* mapping_;
+    size_t mapping_bytes_;
+    ShmRingHeader* header_;
+    float* data_;
+};
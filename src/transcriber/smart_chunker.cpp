@@ -0,0 +1,126 @@
+#include "smart_chunker.h"
+#include "overlap_budget.h"
+#include <algorithm>
+
+// SmartChunker Implementation
+SmartChunker::SmartChunker(const TranscriptionConfig& config, AudioBlockPool& pool)
+    : config_(config)
+    , buffer_(pool)
+    , buffer_start_sample_(0)
+    , emitted_end_sample_(0)
+    , scanned_(0)
+    , pause_vad_(1, 0, config.silence_threshold, FRAME_SAMPLES)
+    , vad_fed_(0)
+    , silence_run_(0) {
+}
+
+bool SmartChunker::processAudio(const float* new_audio, size_t count, AudioChunk& chunk) {
+    buffer_.append(new_audio, count);
+    
+    size_t samples_per_ms = SAMPLE_RATE / 1000;
+    size_t min_samples = config_.min_chunk_duration_ms * samples_per_ms;
+    size_t max_samples = config_.max_chunk_duration_ms * samples_per_ms;
+    size_t optimal_samples = config_.optimal_chunk_duration_ms * samples_per_ms;
+    size_t silence_samples = static_cast<size_t>(std::max(config_.min_silence_duration_ms, 0)) * samples_per_ms;
+    size_t silence_frames = std::max<size_t>((silence_samples + FRAME_SAMPLES - 1) / FRAME_SAMPLES, 1);
+    size_t window_samples = silence_frames * FRAME_SAMPLES;
+    
+    // Don't process if we don't have minimum chunk
+    if (buffer_.size() < min_samples) {
+        return false;
+    }
+    
+    // Feed the VAD samples not seen yet, a frame at a time. A pause window
+    // qualifies once it is silence_frames long and starts at or past the
+    // optimal size (and before the maximum); the first one found is the
+    // earliest.
+    size_t scan_end = std::min(buffer_.size(), max_samples + window_samples - 1);
+    while (scanned_ < scan_end) {
+        const float* block;
+        size_t count = std::min(scan_end - scanned_, buffer_.contiguous(scanned_, &block));
+        count = std::min<size_t>(count, FRAME_SAMPLES - vad_fed_ % FRAME_SAMPLES);
+        bool voiced = pause_vad_.process(block, count) > 0;
+        scanned_ += count;
+        vad_fed_ += count;
+        if (vad_fed_ % FRAME_SAMPLES != 0) {
+            continue;
+        }
+        
+        if (voiced) {
+            silence_run_ = 0;
+            continue;
+        }
+        silence_run_ = std::min(silence_run_ + 1, silence_frames);
+        if (silence_run_ == silence_frames && scanned_ >= optimal_samples + window_samples &&
+            scanned_ - window_samples < max_samples) {
+            // Found good break point
+            extractChunk(scanned_ - window_samples + window_samples / 2, chunk);
+            return true;
+        }
+    }
+    
+    // Force chunk at max duration
+    if (buffer_.size() >= max_samples) {
+        extractChunk(max_samples, chunk);
+        return true;
+    }
+    
+    return false;
+}
+
+bool SmartChunker::flush(AudioChunk& chunk) {
+    // Only the overlap of the last chunk is left: nothing new to emit
+    if (buffer_start_sample_ + buffer_.size() <= emitted_end_sample_) {
+        return false;
+    }
+    
+    extractChunk(buffer_.size(), chunk);
+    chunk.is_final = true;
+    chunk.next_start_sample = chunk.end_sample;
+    reset();
+    buffer_start_sample_ = chunk.end_sample;
+    emitted_end_sample_ = chunk.end_sample;
+    return true;
+}
+
+void SmartChunker::reset() {
+    buffer_.clear();
+    buffer_start_sample_ = 0;
+    emitted_end_sample_ = 0;
+    scanned_ = 0;
+    pause_vad_.reset();
+    vad_fed_ = 0;
+    silence_run_ = 0;
+}
+
+void SmartChunker::setDurations(int min_ms, int optimal_ms, int max_ms) {
+    // The scan position stays valid: a shorter optimal length only takes
+    // effect from silence not scanned yet, and a shorter maximum forces the
+    // cut on the next block
+    config_.min_chunk_duration_ms = min_ms;
+    config_.optimal_chunk_duration_ms = std::max(optimal_ms, min_ms);
+    config_.max_chunk_duration_ms = std::max(max_ms, config_.optimal_chunk_duration_ms);
+}
+
+void SmartChunker::extractChunk(size_t samples, AudioChunk& chunk) {
+    buffer_.view(0, samples, chunk.audio);
+    chunk.start_sample = buffer_start_sample_;
+    chunk.end_sample = buffer_start_sample_ + samples;
+    chunk.is_final = false;
+    emitted_end_sample_ = chunk.end_sample;
+    
+    // Keep the lead-in the next chunk starts with (OverlapBudget). It stays
+    // in blocks the chunk also references, so nothing is copied or moved;
+    // blocks wholly before the new start are released to the chunks still
+    // using them.
+    size_t overlap_samples = OverlapBudget::leadSamples(config_);
+    size_t consumed = samples > overlap_samples ? samples - overlap_samples : samples;
+    buffer_.consume(consumed);
+    buffer_start_sample_ += consumed;
+    chunk.next_start_sample = buffer_start_sample_;
+    
+    // The scan position moves with the buffer. The pause run may now reach
+    // back past the start of what is kept, but a window only qualifies past
+    // the optimal size, so it always lies within the buffer.
+    scanned_ = scanned_ > consumed ? scanned_ - consumed : 0;
+}
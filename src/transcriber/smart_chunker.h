@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "audio_pool.h"
+#include "transcriber.h"
+#include "voice_activity.h"
+
+// Splits the sample stream into chunks at natural pauses. A chunk ends at the
+// first run of min_silence_duration_ms without voice starting past the
+// optimal length, or is forced at the maximum length. Pauses are 20 ms frames
+// a FrameVad finds no voice in: a fixed level (frame RMS over
+// silence_threshold) and no hangover, so a pause is placed to the frame. The
+// current pause run is carried between calls, so each sample is examined
+// exactly once. Audio is buffered in pooled SampleBlocks and chunks are emitted as
+// spans over them.
+class SmartChunker {
+public:
+    SmartChunker(const TranscriptionConfig& config, AudioBlockPool& pool);
+    
+    // Fill chunk (reusing its span storage) and return true when one is cut
+    bool processAudio(const float* new_audio, size_t count, AudioChunk& chunk);
+    // Emits whatever audio is left after the last chunk (end of input)
+    bool flush(AudioChunk& chunk);
+    void reset();
+    
+    // Retargets chunk lengths from the next block on (adaptive sizing)
+    void setDurations(int min_ms, int optimal_ms, int max_ms);
+    
+private:
+    TranscriptionConfig config_;
+    SampleBuffer buffer_;
+    uint64_t buffer_start_sample_;  // Timeline position of the first buffered sample
+    uint64_t emitted_end_sample_;   // End of the last chunk handed out
+    size_t scanned_;                // Buffered samples already fed to the VAD
+    LevelVad pause_vad_;
+    uint64_t vad_fed_;              // Samples fed since the VAD was reset (frame alignment)
+    size_t silence_run_;            // Pause frames ending at the last frame boundary, up to a split's worth
+    
+    void extractChunk(size_t samples, AudioChunk& chunk);
+    
+    static constexpr int SAMPLE_RATE = 16000;
+    static constexpr size_t FRAME_SAMPLES = 320;  // 20 ms, as the gate's frames
+};
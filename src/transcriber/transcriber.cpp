@@ -1,10 +1,18 @@
 #include "transcriber.h"
+#include "pcm_convert.h"
+#include "wav_file.h"
+#include "resampler.h"
+#include "smart_chunker.h"
 #include "whisper.h"
 #include <iostream>
 #include <fstream>
 #include <algorithm>
 #include <cmath>
+#include <iomanip>
 #include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <poll.h>
 #include <unistd.h>
 #include <sstream>
 
@@ -12,9 +20,20 @@ StreamingTranscriber::StreamingTranscriber(const TranscriptionConfig& config)
     : config_(config)
     , whisper_ctx_(nullptr)
     , whisper_state_(nullptr)
-    , running_energy_avg_(0.0f)
-    , last_chunk_timestamp_(0.0f)
-    , smart_chunker_(std::make_unique<SmartChunker>(config)) {
+    , chunk_queue_(std::make_unique<ChunkQueue>(
+          config.chunk_queue_size, config.queue_overflow_policy,
+          static_cast<size_t>(config.max_chunk_duration_ms) * SAMPLE_RATE / 1000))
+    , vad_(config)
+    , edge_trimmer_(config)
+    , fixed_buffer_(pool_)
+    , fixed_start_sample_(0)
+    , smart_chunker_(std::make_unique<SmartChunker>(config, pool_))
+    , chunk_controller_(config)
+    , chunk_sizing_generation_(0)
+    , stream_buffer_(pool_)
+    , stream_start_sample_(0)
+    , stream_new_samples_(0)
+    , stream_has_speech_(false) {
 }
 
 StreamingTranscriber::~StreamingTranscriber() {
@@ -23,50 +42,169 @@ StreamingTranscriber::~StreamingTranscriber() {
     if (whisper_state_) {
         whisper_free_state(whisper_state_);
     }
-    if (whisper_ctx_) {
-        whisper_free(whisper_ctx_);
-    }
+    whisper_ctx_ = nullptr;
+    model_.reset();
 }
 
 bool StreamingTranscriber::initialize() {
     std::cout << "🤖 Loading Whisper model: " << config_.model_path << std::endl;
-    
-    // Initialize whisper context
-    struct whisper_context_params cparams = whisper_context_default_params();
-    cparams.use_gpu = true; // Enable Metal acceleration on macOS
-    
-    whisper_ctx_ = whisper_init_from_file_with_params(config_.model_path.c_str(), cparams);
-    if (!whisper_ctx_) {
-        std::cerr << "❌ Failed to load model: " << config_.model_path << std::endl;
+    startup_ = StartupTimings();
+    auto elapsed_ms = [](std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    };
+    
+    // The context is shared with other transcribers in this process; use_gpu
+    // enables Metal acceleration on macOS
+    auto step_start = std::chrono::steady_clock::now();
+    model_ = WhisperModel::acquire(config_.model_path, true);
+    if (!model_) {
         return false;
     }
-    
-    // Create whisper state for thread-safe processing
+    whisper_ctx_ = model_->context();
+    startup_.model_load_ms = elapsed_ms(step_start);
+    startup_.model_shared = model_.use_count() > 1;
+    startup_.model_bytes = startup_.model_shared ? 0 : model_->residentBytes();
+    
+    // Create whisper state for thread-safe processing. Its buffers are only
+    // touched by a decode, so their memory is counted through the warmup.
+    size_t resident_before_state = residentMemoryBytes();
+    step_start = std::chrono::steady_clock::now();
     whisper_state_ = whisper_init_state(whisper_ctx_);
     if (!whisper_state_) {
         std::cerr << "❌ Failed to create whisper state" << std::endl;
         return false;
     }
+    startup_.state_ms = elapsed_ms(step_start);
     
     std::cout << "✅ Model loaded successfully" << std::endl;
+    
+    if (config_.enable_vad && config_.vad_mode == VadMode::Whisper) {
+        std::cout << "🎯 Loading VAD model: " << config_.vad_model_path << std::endl;
+        step_start = std::chrono::steady_clock::now();
+        size_t resident_before_vad = residentMemoryBytes();
+        if (!vad_.initialize()) {
+            return false;
+        }
+        startup_.vad_load_ms = elapsed_ms(step_start);
+        size_t resident_after_vad = residentMemoryBytes();
+        if (resident_after_vad > resident_before_vad) {
+            resident_before_state += resident_after_vad - resident_before_vad;  // Not the state's
+        }
+    }
+    
+    if (config_.warmup) {
+        step_start = std::chrono::steady_clock::now();
+        if (!warmup()) {
+            std::cerr << "⚠️ Warmup decode failed; the first chunk will pay the setup cost" << std::endl;
+        }
+        startup_.warmup_ms = elapsed_ms(step_start);
+    }
+    size_t resident_after_state = residentMemoryBytes();
+    startup_.state_bytes = resident_after_state > resident_before_state ? resident_after_state - resident_before_state : 0;
+    
     std::cout << "🧠 Threads: " << config_.threads << std::endl;
     std::cout << "🌍 Language: " << config_.language << std::endl;
     
     return true;
 }
 
-void StreamingTranscriber::start(const std::string& pipe_path, TranscriptionCallback callback) {
+void StreamingTranscriber::start(const std::string& source_path, TranscriptionCallback callback) {
+    if (is_running_.load()) {
+        std::cerr << "⚠️ Transcriber is already running" << std::endl;
+        return;
+    }
+    
+    if (config_.transport == AudioTransport::SharedMemory) {
+        shm_ring_ = std::make_unique<ShmAudioRing>();
+        if (!shm_ring_->attach(source_path)) {
+            shm_ring_.reset();
+            return;
+        }
+        if (shm_ring_->sampleRate() != SAMPLE_RATE) {
+            std::cerr << "❌ Shared memory ring runs at " << shm_ring_->sampleRate()
+                      << "Hz, expected " << SAMPLE_RATE << "Hz" << std::endl;
+            shm_ring_.reset();
+            return;
+        }
+        launch(nullptr, callback);
+        return;
+    }
+    
+    PcmSourceConfig source_config;
+    source_config.kind = PcmSourceKind::Fifo;
+    source_config.target = source_path;
+    owned_source_ = std::make_unique<PcmSource>(source_config);
+    if (!owned_source_->open()) {
+        owned_source_.reset();
+        return;
+    }
+    launch(owned_source_.get(), callback);
+}
+
+void StreamingTranscriber::start(PcmSource& source, TranscriptionCallback callback) {
     if (is_running_.load()) {
         std::cerr << "⚠️ Transcriber is already running" << std::endl;
         return;
     }
     
+    launch(&source, callback);
+}
+
+bool StreamingTranscriber::sourceEnded() const {
+    // The chunker cut its last chunk after the ring ran dry, so once the queue
+    // is empty only a decode in flight can still produce results
+    return chunker_drained_.load() && chunk_queue_->size() == 0 && !decoding_.load();
+}
+
+void StreamingTranscriber::launch(PcmSource* source, TranscriptionCallback callback) {
     callback_ = callback;
+    vad_.reset();
+    stream_buffer_.clear();
+    stream_start_sample_ = 0;
+    stream_new_samples_ = 0;
+    stream_has_speech_ = false;
+    stream_commit_sample_.store(0);
+    agreement_.reset();
+    last_partial_text_.clear();
+    dropped_samples_.store(0);
+    gap_overflow_samples_.store(0);
+    source_ended_.store(false);
+    chunker_drained_.store(false);
+    decoding_.store(false);
+    frame_stats_ = AudioFrameStats();
+    
+    // The ring must hold at least one full pipe read. Under the block policy
+    // the chunker stalls until the decoder takes a chunk, so the ring also
+    // holds a max-length chunk; live audio past that is dropped and counted.
+    size_t ring_samples = std::max<size_t>(config_.ring_buffer_size, config_.read_block_bytes / sizeof(float));
+    if (config_.queue_overflow_policy == QueueOverflowPolicy::Block) {
+        ring_samples = std::max<size_t>(ring_samples, static_cast<size_t>(config_.max_chunk_duration_ms) * SAMPLE_RATE / 1000);
+    }
+    sample_ring_ = std::make_unique<SpscRingBuffer<float>>(ring_samples);
+    gap_ring_ = std::make_unique<SpscRingBuffer<SampleGap>>(GAP_RING_SIZE);
+    
     is_running_.store(true);
     
-    // Start threads
-    audio_reader_thread_ = std::thread(&StreamingTranscriber::audioReaderThread, this, pipe_path);
-    transcription_thread_ = std::thread(&StreamingTranscriber::transcriptionThread, this);
+    // A shared scheduler decodes for many transcribers; registered before the
+    // chunker can wake it
+    if (scheduler_) {
+        DecodeSessionOptions options;
+        options.priority = config_.decode_priority;
+        options.weight = config_.decode_weight;
+        options.latency_slo_ms = config_.latency_slo_ms;
+        scheduler_session_ = scheduler_->add([this]() { return is_running_.load() && decodeNext(); }, options);
+    }
+    
+    // Start threads; shared memory needs no reader, the chunker reads the ring in place
+    if (shm_ring_) {
+        chunker_thread_ = std::thread(&StreamingTranscriber::sharedMemoryChunkerThread, this);
+    } else {
+        audio_reader_thread_ = std::thread(&StreamingTranscriber::audioReaderThread, this, source);
+        chunker_thread_ = std::thread(&StreamingTranscriber::chunkerThread, this);
+    }
+    if (!scheduler_) {
+        transcription_thread_ = std::thread(&StreamingTranscriber::transcriptionThread, this);
+    }
     
     std::cout << "🎯 Streaming transcription started" << std::endl;
 }
@@ -77,382 +215,810 @@ void StreamingTranscriber::stop() {
     }
     
     is_running_.store(false);
-    audio_queue_cv_.notify_all();
+    chunk_queue_->close();
+    samples_ready_.notify();
     
     if (audio_reader_thread_.joinable()) {
         audio_reader_thread_.join();
     }
+    if (chunker_thread_.joinable()) {
+        chunker_thread_.join();
+    }
     if (transcription_thread_.joinable()) {
         transcription_thread_.join();
     }
+    if (scheduler_) {
+        scheduler_->remove(scheduler_session_);
+    }
     
+    if (shm_ring_ && shm_ring_->dropped() > 0) {
+        std::cerr << "⚠️ Producer dropped " << shm_ring_->dropped() << " samples (shared ring full)" << std::endl;
+    }
+    if (dropped_samples_.load() > 0) {
+        std::cerr << "⚠️ Dropped " << dropped_samples_.load() << " samples (ring buffer full"
+                  << (config_.queue_overflow_policy == QueueOverflowPolicy::Block ? " while the chunker waited on the decoder" : "")
+                  << ")" << std::endl;
+    }
+    if (gap_overflow_samples_.load() > 0) {
+        std::cerr << "⚠️ Dropped " << gap_overflow_samples_.load() << " samples into a gap while the gap ring was full"
+                  << std::endl;
+    }
+    ChunkQueueStats stats = chunk_queue_->stats();
+    if (stats.dropped_oldest + stats.dropped_newest + stats.coalesced + stats.blocked > 0) {
+        std::cerr << "⚠️ Chunk queue overflow: " << stats.dropped_oldest << " oldest dropped, "
+                  << stats.dropped_newest << " newest dropped, " << stats.coalesced << " coalesced, "
+                  << stats.blocked << " blocked" << std::endl;
+    }
+    if (frame_stats_.sequence_gaps + frame_stats_.restarts + frame_stats_.format_errors + frame_stats_.resyncs > 0) {
+        std::cerr << "⚠️ Audio stream: " << frame_stats_.sequence_gaps << " gaps ("
+                  << frame_stats_.silence_samples << " samples of silence inserted), "
+                  << frame_stats_.restarts << " capture restarts, "
+                  << frame_stats_.format_errors << " unsupported frames, "
+                  << frame_stats_.resyncs << " bytes skipped" << std::endl;
+    }
+    owned_source_.reset();
     std::cout << "🛑 Transcription stopped" << std::endl;
 }
 
-void StreamingTranscriber::audioReaderThread(const std::string& pipe_path) {
-    std::ifstream pipe(pipe_path, std::ios::binary);
-    if (!pipe.is_open()) {
-        std::cerr << "❌ Failed to open pipe: " << pipe_path << std::endl;
-        return;
+ChunkQueueStats StreamingTranscriber::queueStats() const {
+    return chunk_queue_->stats();
+}
+
+bool StreamingTranscriber::transcribeFile(const std::string& wav_path, int decoders, TranscriptionCallback callback) {
+    if (is_running_.load()) {
+        std::cerr << "⚠️ Transcriber is already running" << std::endl;
+        return false;
     }
     
-    std::vector<float> read_buffer;
-    read_buffer.reserve(4096); // Buffer for reading from pipe
+    WavFile wav;
+    if (!wav.open(wav_path)) {
+        return false;
+    }
     
-    auto start_time = std::chrono::steady_clock::now();
+    is_running_.store(true);
+    auto wall_start = std::chrono::steady_clock::now();
+    
+    // 16 kHz files are read (and downmixed) straight from the mapping; other
+    // rates are converted once up front since decoders need random access
+    std::vector<float> resampled;
+    const bool native_rate = wav.sampleRate() == SAMPLE_RATE;
+    if (!native_rate) {
+        std::cout << "🔄 Resampling " << wav.sampleRate() << "Hz " << wav.channels()
+                  << "-channel audio to " << SAMPLE_RATE << "Hz mono" << std::endl;
+        PolyphaseResampler resampler(wav.sampleRate(), SAMPLE_RATE);
+        std::vector<float> mono(CHUNKER_BLOCK_SAMPLES * 16);
+        resampled.reserve(wav.frames() * uint64_t(SAMPLE_RATE) / wav.sampleRate() + 1);
+        for (size_t offset = 0; offset < wav.frames();) {
+            size_t count = wav.readMono(offset, mono.data(), mono.size());
+            offset += count;
+            resampler.process(mono.data(), count, resampled);
+        }
+        resampler.flush(resampled);
+    }
+    const size_t total_samples = native_rate ? wav.frames() : resampled.size();
+    auto read_audio = [&](size_t offset, float* out, size_t count) -> size_t {
+        if (native_rate) {
+            return wav.readMono(offset, out, count);
+        }
+        count = offset < total_samples ? std::min(count, total_samples - offset) : 0;
+        std::copy(resampled.begin() + offset, resampled.begin() + offset + count, out);
+        return count;
+    };
+    
+    // Chunk at full speed, keeping only boundaries; decoders re-read their
+    // audio from the source so the whole file is never held in memory twice
+    std::vector<AudioChunk> chunks;
+    SmartChunker chunker(config_, pool_);
+    std::vector<float> block(CHUNKER_BLOCK_SAMPLES * 16);
+    AudioChunk cut;
+    auto keep = [&chunks, &cut](bool emitted) {
+        if (!emitted) {
+            return false;
+        }
+        AudioChunk boundary;
+        boundary.start_sample = cut.start_sample;
+        boundary.end_sample = cut.end_sample;
+        boundary.next_start_sample = cut.next_start_sample;
+        boundary.is_final = cut.is_final;
+        chunks.push_back(std::move(boundary));
+        return true;
+    };
+    for (size_t offset = 0; offset < total_samples;) {
+        size_t count = read_audio(offset, block.data(), block.size());
+        offset += count;
+        if (keep(chunker.processAudio(block.data(), count, cut))) {
+            // A large block can complete more than one chunk
+            while (keep(chunker.processAudio(block.data(), 0, cut))) {
+            }
+        }
+    }
+    keep(chunker.flush(cut));
+    cut.audio.clear();
     
-    while (is_running_.load()) {
-        // Read audio data in chunks
-        float sample;
-        if (pipe.read(reinterpret_cast<char*>(&sample), sizeof(float))) {
-            read_buffer.push_back(sample);
+    if (chunks.empty()) {
+        is_running_.store(false);
+        return true;
+    }
+    
+    // Decoder 0 reuses the streaming state; the rest share the same context
+    decoders = std::clamp<int>(decoders, 1, chunks.size());
+    std::vector<whisper_state*> states = {whisper_state_};
+    size_t resident_before_states = residentMemoryBytes();
+    while (static_cast<int>(states.size()) < decoders) {
+        whisper_state* state = whisper_init_state(whisper_ctx_);
+        if (!state) {
+            std::cerr << "⚠️ Could only create " << states.size() << " decoder states" << std::endl;
+            break;
+        }
+        states.push_back(state);
+    }
+    decoders = states.size();
+    
+    // Each decoder takes a contiguous run of chunks so prompt and audio context
+    // chain within its run; only the decoders - 1 seams start without context
+    std::vector<size_t> run_start = {0};
+    uint64_t run_samples = total_samples / decoders;
+    for (size_t i = 1; i < chunks.size() && static_cast<int>(run_start.size()) < decoders; i++) {
+        if (chunks[i].start_sample >= run_samples * run_start.size()) {
+            run_start.push_back(i);
+        }
+    }
+    run_start.push_back(chunks.size());
+    
+    // Results are handed to the callback strictly in chunk order
+    std::vector<TranscriptionResult> results(chunks.size());
+    std::vector<bool> done(chunks.size(), false);
+    size_t next_result = 0;
+    size_t silent_chunks = 0;
+    std::mutex results_mutex;
+    
+    auto decode_run = [&](whisper_state* state, size_t first, size_t last) {
+        // A run starting mid-file still knows where the previous run's audio
+        // ended, so the lead-in it shares with that run is not transcribed twice
+        ContextWindow context;
+        context.end_sample = first > 0 ? chunks[first - 1].end_sample : 0;
+        std::vector<TimedWord> words;
+        AudioChunk chunk;
+        SampleBuffer buffer(pool_);
+        std::vector<float> samples;
+        for (size_t i = first; i < last && is_running_.load(); i++) {
+            chunk.start_sample = chunks[i].start_sample;
+            chunk.end_sample = chunks[i].end_sample;
+            chunk.next_start_sample = chunks[i].next_start_sample;
+            samples.resize(chunk.end_sample - chunk.start_sample);
+            read_audio(chunk.start_sample, samples.data(), samples.size());
+            buffer.clear();
+            buffer.append(samples.data(), samples.size());
+            buffer.view(0, samples.size(), chunk.audio);
             
-            // Process buffer periodically (every 1024 samples ~64ms at 16kHz)
-            if (read_buffer.size() >= 1024) {
-                auto current_time = std::chrono::steady_clock::now();
-                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(current_time - start_time);
-                float timestamp = elapsed.count() / 1000.0f;
-                
-                // Use smart chunking if enabled, otherwise use fixed chunking
-                if (config_.enable_smart_chunking) {
-                    auto chunk = smart_chunker_->processAudio(read_buffer, timestamp);
-                    if (chunk.has_value()) {
-                        // Add to processing queue
-                        std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-                        if (audio_queue_.size() < MAX_QUEUE_SIZE) {
-                            audio_queue_.emplace(chunk->audio, chunk->timestamp);
-                            audio_queue_cv_.notify_one();
-                        }
-                    }
-                } else {
-                    // Original fixed chunking logic
-                    const int chunk_samples = (config_.chunk_duration_ms * SAMPLE_RATE) / 1000;
-                    if (read_buffer.size() >= chunk_samples) {
-                        std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-                        if (audio_queue_.size() < MAX_QUEUE_SIZE) {
-                            audio_queue_.emplace(read_buffer, timestamp);
-                            audio_queue_cv_.notify_one();
-                        }
-                        
-                        // Keep overlap for next chunk
-                        const int overlap_samples = (config_.overlap_ms * SAMPLE_RATE) / 1000;
-                        if (overlap_samples > 0 && read_buffer.size() > overlap_samples) {
-                            std::vector<float> overlap_data(
-                                read_buffer.end() - overlap_samples, read_buffer.end()
-                            );
-                            read_buffer = std::move(overlap_data);
-                        } else {
-                            read_buffer.clear();
-                        }
-                    }
+            // The streaming VAD adapts to arrival order, so offline mode only
+            // skips chunks that never rise above the silence threshold
+            TranscriptionResult result;
+            float energy = std::sqrt(chunk.audio.sumOfSquares() / chunk.audio.size());
+            
+            bool silent = config_.enable_vad && energy < config_.silence_threshold;
+            if (silent) {
+                result.start_sample = chunk.start_sample;
+                result.end_sample = chunk.end_sample;
+            } else {
+                if (config_.trim_edges) {
+                    edge_trimmer_.trim(chunk);
                 }
-                
-                // Clear read buffer for smart chunking (it manages its own buffer)
-                if (config_.enable_smart_chunking) {
-                    read_buffer.clear();
+                result = transcribeWithContext(state, config_.threads, context, chunk, words);
+                updateContext(context, result, chunk, words);
+            }
+            
+            std::lock_guard<std::mutex> lock(results_mutex);
+            silent_chunks += silent ? 1 : 0;
+            results[i] = std::move(result);
+            done[i] = true;
+            while (next_result < results.size() && done[next_result]) {
+                if (!results[next_result].text.empty() && callback) {
+                    callback(results[next_result]);
                 }
+                next_result++;
             }
-        } else {
-            // Pipe closed or error
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
+    };
+    
+    std::vector<std::thread> workers;
+    for (size_t run = 0; run + 1 < run_start.size(); run++) {
+        workers.emplace_back(decode_run, states[run], run_start[run], run_start[run + 1]);
+    }
+    for (auto& worker : workers) {
+        worker.join();
     }
+    
+    // Extra decoders reuse the weights; their states are all they add
+    size_t resident_after_decode = residentMemoryBytes();
+    if (decoders > 1 && resident_after_decode > resident_before_states) {
+        std::cout << "🧮 " << decoders << " decoders share one model (" << model_->residentBytes() / (1024 * 1024)
+                  << " MiB): +" << (resident_after_decode - resident_before_states) / (decoders - 1) / (1024 * 1024)
+                  << " MiB per extra decoder state" << std::endl;
+    }
+    for (size_t i = 1; i < states.size(); i++) {
+        whisper_free_state(states[i]);
+    }
+    
+    bool completed = is_running_.exchange(false);
+    
+    double wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    double audio_seconds = double(total_samples) / SAMPLE_RATE;
+    double rtf = audio_seconds > 0 ? wall_seconds / audio_seconds : 0.0;
+    std::cout << "⚡ Transcribed " << std::fixed << std::setprecision(1) << audio_seconds << "s of audio in "
+              << wall_seconds << "s across " << decoders << " decoders ("
+              << chunks.size() << " chunks, " << silent_chunks << " silent), RTF "
+              << std::setprecision(3) << rtf << std::setprecision(1)
+              << " (" << (rtf > 0 ? 1.0 / rtf : 0.0) << "x real time)" << std::defaultfloat << std::endl;
+    
+    return completed;
 }
 
-void StreamingTranscriber::transcriptionThread() {
+void StreamingTranscriber::audioReaderThread(PcmSource* source) {
+    // Read whole blocks (4-64 KiB, rounded down to whole samples) straight into
+    // preallocated sample storage instead of one iostream call per sample
+    size_t block_bytes = std::clamp(config_.read_block_bytes, 4096, 65536);
+    block_bytes -= block_bytes % sizeof(float);
+    
+    // Framed input may leave up to one partial frame in the buffer between reads
+    size_t buffer_bytes = block_bytes + (config_.framed_input ? AUDIO_FRAME_MAX_BYTES : 0);
+    std::vector<float> read_buffer(buffer_bytes / sizeof(float));
+    char* read_bytes = reinterpret_cast<char*>(read_buffer.data());
+    size_t pending_bytes = 0; // Partial sample or frame carried over from the previous read
+    uint64_t ingested = 0;    // Samples taken from the pipe, including dropped ones
+    
+    // Record where samples are missing so the chunker keeps the timeline
+    // intact. A gap the full gap ring cannot take is held, and audio arriving
+    // meanwhile joins it until there is room: losing the gap instead would
+    // shift every later sample on the timeline.
+    SampleGap held_gap = {0, 0};
+    auto queue_gap = [&]() {
+        if (held_gap.count > 0 && gap_ring_->write(&held_gap, 1) == 1) {
+            held_gap.count = 0;
+        }
+        return held_gap.count == 0;
+    };
+    auto record_gap = [&](uint64_t count) {
+        if (held_gap.count == 0) {
+            held_gap.position = ingested;
+        }
+        held_gap.count += count;
+        ingested += count;
+        queue_gap();
+        samples_ready_.notify();
+    };
+    
+    // Hand samples to the chunker without waiting on it; if the chunker has
+    // fallen behind, drop the overflow rather than stall the pipe. Recorded
+    // audio has no deadline, so it waits for room instead.
+    bool live = source->isLive();
+    auto push_samples = [&](const float* samples, size_t count) {
+        while (!live && !queue_gap() && is_running_.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        if (!queue_gap()) {
+            gap_overflow_samples_.fetch_add(count);
+            record_gap(count);
+            return;
+        }
+        size_t written = sample_ring_->write(samples, count);
+        while (!live && written < count && is_running_.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            written += sample_ring_->write(samples + written, count - written);
+        }
+        ingested += written;
+        if (written < count) {
+            record_gap(count - written);
+            dropped_samples_.fetch_add(count - written);
+        }
+        samples_ready_.notify();
+    };
+    
+    AudioFrameParser frame_parser(SAMPLE_RATE);
+    
+    // Raw int16 input is converted block by block into this buffer
+    std::vector<float> convert_buffer;
+    if (!config_.framed_input && config_.raw_format == AudioSampleFormat::Int16) {
+        convert_buffer.resize(buffer_bytes / sizeof(int16_t));
+    }
+    
     while (is_running_.load()) {
-        std::unique_lock<std::mutex> lock(audio_queue_mutex_);
-        audio_queue_cv_.wait(lock, [this] {
-            return !audio_queue_.empty() || !is_running_.load();
-        });
+        // Wait for data with a timeout so stop() is honored while the pipe is
+        // idle, and a producer that died without closing it is noticed
+        struct pollfd pfd = {source->fd(), POLLIN, 0};
+        if (poll(&pfd, 1, 100) <= 0) {
+            if (!source->producerAlive() && !source->recover(is_running_)) {
+                break;
+            }
+            continue;
+        }
         
-        if (!is_running_.load()) {
-            break;
+        size_t to_read = std::min(block_bytes, buffer_bytes - pending_bytes);
+        ssize_t bytes_read = read(source->fd(), read_bytes + pending_bytes, to_read);
+        if (bytes_read < 0 && (errno == EINTR || errno == EAGAIN)) {
+            continue;
+        }
+        if (bytes_read <= 0) {
+            // End of stream: a partial frame or sample from it is useless to the next one
+            pending_bytes = 0;
+            if (!source->recover(is_running_)) {
+                break;
+            }
+            continue;
         }
         
-        if (!audio_queue_.empty()) {
-            auto [audio_data, timestamp] = std::move(audio_queue_.front());
-            audio_queue_.pop();
-            lock.unlock();
-            
-            processAudioChunk(audio_data, timestamp);
+        size_t total_bytes = pending_bytes + bytes_read;
+        size_t consumed_bytes;
+        if (config_.framed_input) {
+            consumed_bytes = frame_parser.parse(read_bytes, total_bytes, push_samples, record_gap);
+        } else if (config_.raw_format == AudioSampleFormat::Int16) {
+            size_t sample_count = total_bytes / sizeof(int16_t);
+            convertS16ToFloat(reinterpret_cast<const int16_t*>(read_bytes), convert_buffer.data(), sample_count);
+            push_samples(convert_buffer.data(), sample_count);
+            consumed_bytes = sample_count * sizeof(int16_t);
+        } else {
+            size_t sample_count = total_bytes / sizeof(float);
+            push_samples(read_buffer.data(), sample_count);
+            consumed_bytes = sample_count * sizeof(float);
+        }
+        
+        // Move the unconsumed tail to the front for the next read
+        pending_bytes = total_bytes - consumed_bytes;
+        if (pending_bytes > 0) {
+            std::memmove(read_bytes, read_bytes + consumed_bytes, pending_bytes);
         }
-    }
-}
-
-void StreamingTranscriber::processAudioChunk(const std::vector<float>& audio_data, float timestamp) {
-    // Apply VAD if enabled
-    if (config_.enable_vad && !detectVoiceActivity(audio_data)) {
-        return;
     }
     
-    // Transcribe with or without context
-    TranscriptionResult result;
-    if (config_.enable_context) {
-        result = transcribeWithContext(audio_data, timestamp);
-    } else {
-        result = transcribeChunk(audio_data, timestamp);
+    if (config_.framed_input) {
+        frame_stats_ = frame_parser.stats();
+    }
+    while (!queue_gap() && is_running_.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
     }
     
-    // Update context for next transcription
-    if (config_.enable_context && !result.text.empty()) {
-        updateContext(result, audio_data);
+    if (is_running_.load()) {
+        std::cout << "📭 Audio source ended: " << source->describe() << std::endl;
+        source_ended_.store(true);
+        samples_ready_.notify();
     }
+}
+
+void StreamingTranscriber::chunkerThread() {
+    std::vector<float> block(CHUNKER_BLOCK_SAMPLES);
+    const std::vector<float> silence(CHUNKER_BLOCK_SAMPLES, 0.0f);
     
-    // Call callback with result
-    if (!result.text.empty() && callback_) {
-        callback_(result);
+    uint64_t position = 0; // Timeline position of the next sample to consume
+    SampleGap gap = {0, 0};
+    
+    while (is_running_.load()) {
+        // Samples written so far, counted before looking for a gap: a gap the
+        // reader records after this lies beyond them, so reading no further
+        // never runs past a gap we have not seen yet
+        size_t available = sample_ring_->size();
+        if (gap.count == 0) {
+            gap_ring_->read(&gap, 1);
+        }
+        
+        // Substitute silence for dropped samples once we reach them
+        if (gap.count > 0 && gap.position == position) {
+            while (gap.count > 0) {
+                size_t count = std::min<uint64_t>(gap.count, silence.size());
+                feedChunker(silence.data(), count);
+                gap.count -= count;
+                position += count;
+            }
+            continue;
+        }
+        
+        // Never read past a pending gap
+        size_t limit = std::min(block.size(), available);
+        if (gap.count > 0) {
+            limit = std::min<uint64_t>(limit, gap.position - position);
+        }
+        
+        size_t sample_count = sample_ring_->read(block.data(), limit);
+        if (sample_count == 0) {
+            // The source ended and everything it gave has been chunked: cut
+            // what the chunker still holds into a last chunk
+            bool ending = source_ended_.load() && !chunker_drained_.load() && sample_ring_->size() == 0 &&
+                          gap.count == 0 && gap_ring_->size() == 0;
+            if (ending) {
+                flushChunker();
+            }
+            chunk_queue_->flush();
+            wakeDecoder();
+            if (ending && !chunk_queue_->holding()) {
+                chunker_drained_.store(true);
+            }
+            // A held coalesced chunk is retried soon; otherwise sleep until the reader writes
+            auto timeout = std::chrono::milliseconds(chunk_queue_->holding() ? 5 : 100);
+            samples_ready_.waitFor([&]() {
+                return !is_running_.load() || sample_ring_->size() > 0 || (gap.count == 0 && gap_ring_->size() > 0) ||
+                       (source_ended_.load() && !chunker_drained_.load());
+            }, timeout);
+            continue;
+        }
+        
+        feedChunker(block.data(), sample_count);
+        position += sample_count;
+        
+        // Retry a held coalesced chunk now that the transcriber may have caught up
+        chunk_queue_->flush();
+        wakeDecoder();
     }
 }
 
-bool StreamingTranscriber::detectVoiceActivity(const std::vector<float>& audio_data) {
-    if (!config_.enable_vad) {
-        return true;
+void StreamingTranscriber::sharedMemoryChunkerThread() {
+    while (is_running_.load()) {
+        // Chunk straight from the shared mapping: no pipe read and no sample
+        // ring in between. The chunker still copies into its pooled blocks,
+        // which chunks keep long after this slot is handed back to the producer.
+        const float* samples;
+        size_t sample_count = std::min<size_t>(shm_ring_->peek(&samples), CHUNKER_BLOCK_SAMPLES);
+        if (sample_count == 0) {
+            // The producer ended the stream and everything it wrote first has
+            // been chunked (checked in that order, so no late write is missed):
+            // cut what the chunker still holds into a last chunk
+            bool ending = shm_ring_->streamEnded() && !chunker_drained_.load() && shm_ring_->peek(&samples) == 0;
+            if (ending && !source_ended_.load()) {
+                std::cout << "📭 Audio source ended: shared memory ring" << std::endl;
+                source_ended_.store(true);
+            }
+            if (ending) {
+                flushChunker();
+            }
+            chunk_queue_->flush();
+            wakeDecoder();
+            if (ending && !chunk_queue_->holding()) {
+                chunker_drained_.store(true);
+            }
+            shm_ring_->waitForData(100);
+            continue;
+        }
+        
+        feedChunker(samples, sample_count);
+        shm_ring_->consume(sample_count);
+        
+        // Retry a held coalesced chunk now that the transcriber may have caught up
+        chunk_queue_->flush();
+        wakeDecoder();
+    }
+}
+
+void StreamingTranscriber::feedChunker(const float* samples, size_t count) {
+    if (config_.streaming_partials) {
+        feedStream(samples, count);
+        return;
     }
     
-    // Calculate RMS energy
-    float energy = 0.0f;
-    for (float sample : audio_data) {
-        energy += sample * sample;
+    // Use smart chunking if enabled, otherwise use fixed chunking
+    if (config_.enable_smart_chunking) {
+        if (config_.adaptive_chunking && chunk_controller_.generation() != chunk_sizing_generation_) {
+            chunk_sizing_generation_ = chunk_controller_.generation();
+            int min_ms, optimal_ms, max_ms;
+            chunk_controller_.durations(min_ms, optimal_ms, max_ms);
+            smart_chunker_->setDurations(min_ms, optimal_ms, max_ms);
+        }
+        if (!next_chunk_) {
+            next_chunk_ = chunk_queue_->acquire();
+        }
+        if (smart_chunker_->processAudio(samples, count, *next_chunk_)) {
+            enqueueChunk(std::move(next_chunk_));
+        }
+        return;
     }
-    energy = std::sqrt(energy / audio_data.size());
     
-    // Update running average
-    const float alpha = 0.1f; // Smoothing factor
-    running_energy_avg_ = alpha * energy + (1.0f - alpha) * running_energy_avg_;
+    // Original fixed chunking logic
+    const size_t chunk_samples = (config_.chunk_duration_ms * SAMPLE_RATE) / 1000;
+    const size_t overlap_samples = OverlapBudget::leadSamples(config_);
     
-    // Voice activity threshold
-    return energy > config_.vad_threshold * running_energy_avg_;
+    fixed_buffer_.append(samples, count);
+    if (fixed_buffer_.size() >= chunk_samples) {
+        AudioChunkPtr chunk = chunk_queue_->acquire();
+        fixed_buffer_.view(0, fixed_buffer_.size(), chunk->audio);
+        chunk->start_sample = fixed_start_sample_;
+        chunk->end_sample = fixed_start_sample_ + fixed_buffer_.size();
+        
+        // Keep overlap for next chunk (still in blocks the chunk shares)
+        size_t consumed = fixed_buffer_.size();
+        if (overlap_samples > 0 && consumed > overlap_samples) {
+            consumed -= overlap_samples;
+        }
+        fixed_buffer_.consume(consumed);
+        fixed_start_sample_ += consumed;
+        chunk->next_start_sample = fixed_start_sample_;
+        
+        enqueueChunk(std::move(chunk));
+    }
 }
 
-TranscriptionResult StreamingTranscriber::transcribeChunk(const std::vector<float>& audio_data, float timestamp) {
-    TranscriptionResult result;
-    result.timestamp = timestamp;
-    result.is_partial = false;
-    result.confidence = 0.0f;
-    
-    // Prepare whisper parameters
-    struct whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
-    
-    wparams.strategy = WHISPER_SAMPLING_GREEDY;
-    wparams.n_threads = config_.threads;
-    wparams.n_max_text_ctx = 16384;
-    wparams.language = config_.language.c_str();
-    wparams.translate = config_.translate;
-    wparams.no_context = false;
-    wparams.single_segment = false;
-    wparams.print_realtime = false;
-    wparams.print_progress = false;
-    wparams.print_timestamps = false;
-    wparams.print_special = false;
-    wparams.suppress_blank = true;
-    wparams.suppress_non_speech_tokens = true;
-    wparams.temperature = config_.temperature;
-    wparams.max_tokens = config_.max_tokens;
-    
-    // Run transcription
-    if (whisper_full_with_state(whisper_ctx_, whisper_state_, wparams, 
-                               audio_data.data(), audio_data.size()) != 0) {
-        std::cerr << "❌ Transcription failed" << std::endl;
-        return result;
+void StreamingTranscriber::flushChunker() {
+    if (config_.streaming_partials) {
+        // Close the utterance still open; the decoder commits all of it
+        if (!stream_has_speech_) {
+            return;
+        }
+        AudioChunkPtr chunk = chunk_queue_->acquire();
+        stream_buffer_.view(0, stream_buffer_.size(), chunk->audio);
+        chunk->start_sample = stream_start_sample_;
+        chunk->end_sample = stream_start_sample_ + stream_buffer_.size();
+        chunk->is_final = true;
+        stream_buffer_.consume(stream_buffer_.size());
+        stream_start_sample_ = chunk->end_sample;
+        stream_has_speech_ = false;
+        chunk->queued_at = std::chrono::steady_clock::now();
+        auto queued_at = chunk->queued_at;
+        if (chunk_queue_->push(std::move(chunk))) {
+            wakeDecoder(queued_at);
+        }
+        return;
     }
     
-    // Extract results
-    const int n_segments = whisper_full_n_segments_from_state(whisper_state_);
-    std::string transcription;
-    
-    for (int i = 0; i < n_segments; ++i) {
-        const char* text = whisper_full_get_segment_text_from_state(whisper_state_, i);
-        if (text && strlen(text) > 0) {
-            // Clean up the text
-            std::string segment_text(text);
-            
-            // Remove leading/trailing whitespace
-            segment_text.erase(0, segment_text.find_first_not_of(" \t\n\r"));
-            segment_text.erase(segment_text.find_last_not_of(" \t\n\r") + 1);
-            
-            if (!segment_text.empty()) {
-                if (!transcription.empty()) {
-                    transcription += " ";
-                }
-                transcription += segment_text;
-            }
+    if (config_.enable_smart_chunking) {
+        if (!next_chunk_) {
+            next_chunk_ = chunk_queue_->acquire();
+        }
+        if (smart_chunker_->flush(*next_chunk_)) {
+            enqueueChunk(std::move(next_chunk_));
         }
+        return;
     }
     
-    result.text = transcription;
+    // Fixed chunking keeps only the last chunk's lead-in once it has cut one
+    bool cut_before = fixed_start_sample_ > 0;
+    if (fixed_buffer_.size() == 0 || (cut_before && fixed_buffer_.size() <= OverlapBudget::leadSamples(config_))) {
+        return;
+    }
+    AudioChunkPtr chunk = chunk_queue_->acquire();
+    fixed_buffer_.view(0, fixed_buffer_.size(), chunk->audio);
+    chunk->start_sample = fixed_start_sample_;
+    chunk->end_sample = fixed_start_sample_ + fixed_buffer_.size();
+    chunk->next_start_sample = chunk->end_sample;
+    chunk->is_final = true;
+    fixed_buffer_.consume(fixed_buffer_.size());
+    fixed_start_sample_ = chunk->end_sample;
+    enqueueChunk(std::move(chunk));
+}
+
+void StreamingTranscriber::feedStream(const float* samples, size_t count) {
+    stream_buffer_.append(samples, count);
+    stream_new_samples_ += count;
+    
+    // Drop audio whose words the decoder has committed; the prompt carries their text
+    uint64_t committed = stream_commit_sample_.load(std::memory_order_acquire);
+    if (committed > stream_start_sample_) {
+        size_t trim = std::min<uint64_t>(committed - stream_start_sample_, stream_buffer_.size());
+        stream_buffer_.consume(trim);
+        stream_start_sample_ += trim;
+    }
     
-    // Calculate average confidence (simplified)
-    if (n_segments > 0) {
-        float total_confidence = 0.0f;
-        for (int i = 0; i < n_segments; ++i) {
-            // Whisper doesn't provide direct confidence, so we use a heuristic
-            // based on segment length and audio energy
-            total_confidence += 0.8f; // Placeholder confidence
+    // Send the window once per interval of new audio, and only once the
+    // decoder has taken the last one: a slow decoder sees longer windows
+    // less often instead of falling behind
+    const size_t interval_samples = static_cast<size_t>(config_.partial_interval_ms) * SAMPLE_RATE / 1000;
+    const size_t max_samples = static_cast<size_t>(config_.max_chunk_duration_ms) * SAMPLE_RATE / 1000;
+    bool full = stream_buffer_.size() >= max_samples;
+    if (!full && (stream_new_samples_ < interval_samples || chunk_queue_->size() > 0)) {
+        return;
+    }
+    stream_new_samples_ = 0;
+    
+    AudioChunkPtr chunk = chunk_queue_->acquire();
+    stream_buffer_.view(0, stream_buffer_.size(), chunk->audio);
+    chunk->start_sample = stream_start_sample_;
+    chunk->end_sample = stream_start_sample_ + stream_buffer_.size();
+    
+    // A pause (or whisper's 30 s limit) closes the utterance: the decoder
+    // commits everything left and the next window starts empty
+    bool speech = !config_.enable_vad || vad_.containsSpeech(*chunk);
+    chunk->is_final = full || !speech;
+    if (speech && !full) {
+        stream_has_speech_ = true;
+    } else {
+        size_t keep = stream_has_speech_ ? 0 : static_cast<size_t>(STREAM_LEAD_MS) * SAMPLE_RATE / 1000;
+        size_t trim = stream_buffer_.size() > keep ? stream_buffer_.size() - keep : 0;
+        stream_buffer_.consume(trim);
+        stream_start_sample_ += trim;
+        if (!stream_has_speech_) {
+            // Silence with nothing pending: no decode needed
+            chunk_queue_->recycle(std::move(chunk));
+            return;
         }
-        result.confidence = total_confidence / n_segments;
+        stream_has_speech_ = false;
+    }
+    chunk->queued_at = std::chrono::steady_clock::now();
+    auto queued_at = chunk->queued_at;
+    if (chunk_queue_->push(std::move(chunk))) {
+        wakeDecoder(queued_at);
     }
-    
-    return result;
 }
 
-// Voice Activity Detector Implementation
-VoiceActivityDetector::VoiceActivityDetector(float threshold, int window_size)
-    : threshold_(threshold)
-    , window_size_(window_size)
-    , background_energy_(0.0f)
-    , frame_count_(0) {
-    energy_buffer_.reserve(window_size);
+void StreamingTranscriber::enqueueChunk(AudioChunkPtr chunk) {
+    // Gate here rather than in the transcription thread: the VAD sees every
+    // sample exactly once and in order (even for chunks the queue would drop),
+    // and a chunk without speech never takes a queue slot
+    if (config_.enable_vad && !vad_.containsSpeech(*chunk)) {
+        chunk_queue_->recycle(std::move(chunk));
+        return;
+    }
+    if (config_.trim_edges) {
+        edge_trimmer_.trim(*chunk);
+    }
+    chunk->queued_at = std::chrono::steady_clock::now();
+    auto queued_at = chunk->queued_at;
+    if (chunk_queue_->push(std::move(chunk))) {
+        wakeDecoder(queued_at);
+    }
 }
 
-bool VoiceActivityDetector::isVoiceActive(const std::vector<float>& audio_data) {
-    float energy = calculateEnergy(audio_data);
-    
-    // Update background energy estimate
-    updateBackgroundEnergy(energy);
-    
-    // Add to energy buffer
-    energy_buffer_.push_back(energy);
-    if (energy_buffer_.size() > window_size_) {
-        energy_buffer_.erase(energy_buffer_.begin());
+void StreamingTranscriber::transcriptionThread() {
+    while (is_running_.load()) {
+        if (!decodeNext()) {
+            chunk_queue_->waitForChunk(std::chrono::milliseconds(100));
+        }
     }
-    
-    // Calculate average energy over window
-    float avg_energy = 0.0f;
-    for (float e : energy_buffer_) {
-        avg_energy += e;
+}
+
+bool StreamingTranscriber::decodeNext() {
+    // Raised before the pop so sourceEnded() never sees an empty queue
+    // without also seeing the chunk taken from it
+    decoding_.store(true);
+    AudioChunkPtr chunk = chunk_queue_->pop();
+    if (!chunk) {
+        decoding_.store(false);
+        return false;
     }
-    avg_energy /= energy_buffer_.size();
     
-    // Voice activity decision
-    return avg_energy > threshold_ * background_energy_;
+    auto decode_start = std::chrono::steady_clock::now();
+    processAudioChunk(*chunk);
+    
+    if (config_.adaptive_chunking) {
+        auto decode_end = std::chrono::steady_clock::now();
+        chunk_controller_.recordDecode(
+            chunk->audio.size(),
+            std::chrono::duration<double>(decode_start - chunk->queued_at).count(),
+            std::chrono::duration<double>(decode_end - decode_start).count(),
+            chunk_queue_->size());
+    }
+    chunk_queue_->recycle(std::move(chunk));
+    decoding_.store(false);
+    return true;
 }
 
-void VoiceActivityDetector::reset() {
-    energy_buffer_.clear();
-    background_energy_ = 0.0f;
-    frame_count_ = 0;
+void StreamingTranscriber::wakeDecoder() {
+    if (scheduler_ && chunk_queue_->size() > 0) {
+        scheduler_->notify(scheduler_session_);
+    }
 }
 
-float VoiceActivityDetector::calculateEnergy(const std::vector<float>& audio_data) {
-    float energy = 0.0f;
-    for (float sample : audio_data) {
-        energy += sample * sample;
+void StreamingTranscriber::wakeDecoder(std::chrono::steady_clock::time_point queued_at) {
+    if (scheduler_) {
+        scheduler_->notify(scheduler_session_, queued_at);
     }
-    return std::sqrt(energy / audio_data.size());
 }
 
-void VoiceActivityDetector::updateBackgroundEnergy(float energy) {
-    const float alpha = 0.01f; // Very slow adaptation
+void StreamingTranscriber::processAudioChunk(const AudioChunk& chunk) {
+    if (config_.streaming_partials) {
+        processStreamWindow(chunk);
+        return;
+    }
     
-    if (frame_count_ == 0) {
-        background_energy_ = energy;
-    } else {
-        // Only update background if current energy is low (likely background)
-        if (energy < background_energy_ * 2.0f) {
-            background_energy_ = alpha * energy + (1.0f - alpha) * background_energy_;
-        }
+    // The context window is kept even without enable_context: overlap
+    // removal needs to know what the previous decode covered
+    TranscriptionResult result;
+    {
+        std::lock_guard<std::mutex> lock(context_mutex_);
+        thread_local std::vector<TimedWord> words;
+        result = transcribeWithContext(whisper_state_, config_.threads, context_, chunk, words);
+        updateContext(context_, result, chunk, words);
     }
     
-    frame_count_++;
-}
-
-// SmartChunker Implementation
-SmartChunker::SmartChunker(const TranscriptionConfig& config)
-    : config_(config)
-    , last_speech_time_(0.0f)
-    , vad_(config.silence_threshold) {
+    // Call callback with result
+    if (!result.text.empty() && callback_) {
+        callback_(result);
+    }
 }
 
-std::optional<AudioChunk> SmartChunker::processAudio(const std::vector<float>& new_audio, float timestamp) {
-    buffer_.insert(buffer_.end(), new_audio.begin(), new_audio.end());
-    
-    int samples_per_ms = SAMPLE_RATE / 1000;
-    int min_samples = config_.min_chunk_duration_ms * samples_per_ms;
-    int max_samples = config_.max_chunk_duration_ms * samples_per_ms;
-    int optimal_samples = config_.optimal_chunk_duration_ms * samples_per_ms;
+void StreamingTranscriber::processStreamWindow(const AudioChunk& chunk) {
+    // Pad short windows so whisper does not skip them; padding only adds silence
+    thread_local std::vector<float> audio;
+    audio.assign(std::max<size_t>(chunk.audio.size(), WHISPER_MIN_SAMPLES), 0.0f);
+    chunk.audio.copyTo(audio.data());
+    
+    TranscriptionResult decoded;
+    std::vector<TimedWord> words;
+    std::string prompt = agreement_.prompt(config_.max_prompt_tokens / 2);
+    if (!runWhisper(whisper_state_, audio.data(), audio.size(), prompt, config_.threads, decoded, &words)) {
+        std::cerr << "❌ Streaming transcription failed" << std::endl;
+        return;
+    }
     
-    // Don't process if we don't have minimum chunk
-    if (buffer_.size() < min_samples) {
-        return std::nullopt;
+    // Word times are relative to the window; drop any placed in the padding
+    words.erase(std::remove_if(words.begin(), words.end(), [&](TimedWord& word) {
+        word.start_sample += chunk.start_sample;
+        word.end_sample = std::min(word.end_sample + chunk.start_sample, chunk.end_sample);
+        return word.start_sample >= chunk.end_sample;
+    }), words.end());
+    
+    std::vector<TimedWord> committed;
+    agreement_.insert(std::move(words), committed);
+    if (chunk.is_final) {
+        agreement_.flush(committed);
     }
     
-    // Look for natural break points (silence) around optimal size
-    if (buffer_.size() >= optimal_samples) {
-        int silence_samples = config_.min_silence_duration_ms * samples_per_ms;
-        
-        // Search for silence window starting from optimal size
-        for (int i = optimal_samples; i < buffer_.size() - silence_samples && i < max_samples; i++) {
-            if (isSilentWindow(buffer_, i, silence_samples)) {
-                // Found good break point
-                return extractChunk(i + silence_samples / 2);
+    auto make_result = [](const std::vector<TimedWord>& words, bool partial) {
+        TranscriptionResult result;
+        result.is_partial = partial;
+        result.confidence = 0.0f;
+        for (const TimedWord& word : words) {
+            if (!result.text.empty()) {
+                result.text += " ";
             }
+            result.text += word.text;
         }
-    }
+        if (!words.empty()) {
+            result.start_sample = words.front().start_sample;
+            result.end_sample = words.back().end_sample;
+        }
+        result.timestamp = float(result.start_sample) / SAMPLE_RATE;
+        return result;
+    };
     
-    // Force chunk at max duration
-    if (buffer_.size() >= max_samples) {
-        return extractChunk(max_samples);
+    if (callback_ && (!committed.empty() || chunk.is_final)) {
+        TranscriptionResult result = make_result(committed, false);
+        result.ends_utterance = chunk.is_final;
+        callback_(result);
+    }
+    TranscriptionResult partial = make_result(agreement_.tentative(), true);
+    if (callback_ && partial.text != last_partial_text_) {
+        last_partial_text_ = partial.text;
+        callback_(partial);
     }
     
-    return std::nullopt;
-}
-
-void SmartChunker::reset() {
-    buffer_.clear();
-    last_speech_time_ = 0.0f;
-    vad_.reset();
-}
-
-bool SmartChunker::isSilentWindow(const std::vector<float>& audio, int start, int length) {
-    for (int i = start; i < start + length && i < audio.size(); i++) {
-        if (std::abs(audio[i]) > config_.silence_threshold) {
-            return false;
+    // Let the chunker trim committed audio once the window is long enough to
+    // make re-decoding it costly, or at a sentence end where whisper loses
+    // little context by starting afresh
+    if (!chunk.is_final && !committed.empty()) {
+        char last = committed.back().text.empty() ? ' ' : committed.back().text.back();
+        bool sentence_end = last == '.' || last == '?' || last == '!';
+        size_t trim_samples = static_cast<size_t>(config_.partial_trim_ms) * SAMPLE_RATE / 1000;
+        if (sentence_end || chunk.audio.size() >= trim_samples) {
+            stream_commit_sample_.store(agreement_.committedEnd(), std::memory_order_release);
         }
     }
-    return true;
 }
 
-AudioChunk SmartChunker::extractChunk(int samples) {
-    AudioChunk chunk;
-    chunk.audio.assign(buffer_.begin(), buffer_.begin() + samples);
-    chunk.timestamp = last_speech_time_;
-    chunk.is_final = false;
-    
-    // Keep overlap for context (2 seconds)
-    int overlap_samples = 2 * SAMPLE_RATE;
-    if (samples > overlap_samples) {
-        buffer_.erase(buffer_.begin(), buffer_.begin() + (samples - overlap_samples));
-    } else {
-        buffer_.clear();
-    }
+// The first whisper_full call on a context pays for backend setup, kernel and
+// graph preparation and faulting in the weights. Decoding a second of silence
+// here moves that cost out of the first real chunk's latency.
+bool StreamingTranscriber::warmup() {
+    std::vector<float> silence(WHISPER_MIN_SAMPLES, 0.0f);
+    
+    struct whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    wparams.n_threads = config_.threads;
+    wparams.language = config_.language.c_str();
+    wparams.translate = config_.translate;
+    wparams.no_context = true;
+    wparams.single_segment = true;
+    wparams.max_tokens = 1;
+    wparams.print_realtime = false;
+    wparams.print_progress = false;
+    wparams.print_timestamps = false;
+    wparams.print_special = false;
     
-    last_speech_time_ += float(samples - overlap_samples) / SAMPLE_RATE;
-    return chunk;
+    // whisper.cpp keeps the decoded tokens as the next call's prompt
+    discard_warmup_context_ = true;
+    return whisper_full_with_state(whisper_ctx_, whisper_state_, wparams, silence.data(), silence.size()) == 0;
 }
 
-// Context Management Implementation
-TranscriptionResult StreamingTranscriber::transcribeWithContext(const std::vector<float>& audio_data, float timestamp) {
-    // Prepare audio with context
-    std::vector<float> contextual_audio = prepareContextualAudio(audio_data);
-    
-    // Prepare context prompt
-    std::string context_prompt;
-    {
-        std::lock_guard<std::mutex> lock(context_mutex_);
-        context_prompt = prepareContextPrompt(context_.previous_text);
-    }
-    
-    TranscriptionResult result;
-    result.timestamp = timestamp;
-    result.is_partial = false;
-    result.confidence = 0.0f;
-    
-    // Prepare whisper parameters with context
+bool StreamingTranscriber::runWhisper(whisper_state* state, const float* audio, size_t count,
+                                      const std::string& prompt, int n_threads, TranscriptionResult& result,
+                                      std::vector<TimedWord>* words) {
+    // Prepare whisper parameters
     struct whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
     
     wparams.strategy = WHISPER_SAMPLING_GREEDY;
-    wparams.n_threads = config_.threads;
+    wparams.n_threads = n_threads;
     wparams.n_max_text_ctx = 16384;
     wparams.language = config_.language.c_str();
     wparams.translate = config_.translate;
@@ -466,25 +1032,34 @@ TranscriptionResult StreamingTranscriber::transcribeWithContext(const std::vecto
     wparams.suppress_non_speech_tokens = true;
     wparams.temperature = config_.temperature;
     wparams.max_tokens = config_.max_tokens;
-    
-    // Set context prompt
-    wparams.initial_prompt = context_prompt.empty() ? nullptr : context_prompt.c_str();
+    wparams.initial_prompt = prompt.empty() ? nullptr : prompt.c_str();
+    
+    // Word timing places words against the overlap and the streaming window;
+    // successive streaming decodes of one window must not prompt themselves
+    // with the previous hypothesis
+    wparams.token_timestamps = words != nullptr;
+    wparams.no_context = config_.streaming_partials;
+    if (state == whisper_state_ && discard_warmup_context_) {
+        wparams.no_context = true;
+        discard_warmup_context_ = false;
+    }
     
     // Run transcription
-    if (whisper_full_with_state(whisper_ctx_, whisper_state_, wparams, 
-                               contextual_audio.data(), contextual_audio.size()) != 0) {
-        std::cerr << "❌ Contextual transcription failed" << std::endl;
-        return result;
+    if (whisper_full_with_state(whisper_ctx_, state, wparams, audio, count) != 0) {
+        return false;
     }
     
     // Extract results
-    const int n_segments = whisper_full_n_segments_from_state(whisper_state_);
+    const int n_segments = whisper_full_n_segments_from_state(state);
     std::string transcription;
     
     for (int i = 0; i < n_segments; ++i) {
-        const char* text = whisper_full_get_segment_text_from_state(whisper_state_, i);
+        const char* text = whisper_full_get_segment_text_from_state(state, i);
         if (text && strlen(text) > 0) {
+            // Clean up the text
             std::string segment_text(text);
+            
+            // Remove leading/trailing whitespace
             segment_text.erase(0, segment_text.find_first_not_of(" \t\n\r"));
             segment_text.erase(segment_text.find_last_not_of(" \t\n\r") + 1);
             
@@ -499,43 +1074,120 @@ TranscriptionResult StreamingTranscriber::transcribeWithContext(const std::vecto
     
     result.text = transcription;
     
-    // Calculate confidence
+    if (words) {
+        // Tokens starting with a space (or a segment) start a word; the rest
+        // (word pieces, punctuation) extend it. Special tokens sort after EOT.
+        const whisper_token eot = whisper_token_eot(whisper_ctx_);
+        words->clear();
+        for (int i = 0; i < n_segments; ++i) {
+            const int n_tokens = whisper_full_n_tokens_from_state(state, i);
+            bool segment_start = true;
+            for (int j = 0; j < n_tokens; ++j) {
+                whisper_token_data token = whisper_full_get_token_data_from_state(state, i, j);
+                const char* piece = whisper_full_get_token_text_from_state(whisper_ctx_, state, i, j);
+                if (token.id >= eot || !piece || !*piece) {
+                    continue;
+                }
+                int64_t t0 = std::max<int64_t>(token.t0, 0);
+                int64_t t1 = std::max<int64_t>(token.t1, t0);
+                if (segment_start || piece[0] == ' ' || words->empty()) {
+                    std::string text(piece);
+                    text.erase(0, text.find_first_not_of(' '));
+                    if (!text.empty()) {
+                        words->push_back({text, uint64_t(t0) * SAMPLE_RATE / 100, uint64_t(t1) * SAMPLE_RATE / 100});
+                        segment_start = false;
+                    }
+                } else {
+                    words->back().text += piece;
+                    words->back().end_sample = uint64_t(t1) * SAMPLE_RATE / 100;
+                }
+            }
+        }
+    }
+    
+    // Whisper doesn't provide direct confidence, so we use a placeholder
     if (n_segments > 0) {
-        result.confidence = 0.8f; // Placeholder
+        result.confidence = 0.8f;
     }
     
-    // Remove contextual overlap if enabled
-    if (config_.remove_context_overlap && !context_.previous_text.empty()) {
-        result = removeContextualOverlap(result);
+    return true;
+}
+
+// Context Management Implementation
+TranscriptionResult StreamingTranscriber::transcribeWithContext(whisper_state* state, int n_threads,
+                                                                const ContextWindow& context,
+                                                                const AudioChunk& chunk,
+                                                                std::vector<TimedWord>& words) {
+    // Whisper needs contiguous samples; this gather is the chunk's only copy,
+    // into a buffer each decoder thread reuses. The chunk already starts with
+    // its lead-in from the previous chunk, so no audio is prepended here; a
+    // source's last chunk can be shorter than whisper takes and is padded.
+    thread_local std::vector<float> audio;
+    audio.resize(std::max<size_t>(chunk.audio.size(), WHISPER_MIN_SAMPLES));
+    chunk.audio.copyTo(audio.data());
+    std::fill(audio.begin() + chunk.audio.size(), audio.end(), 0.0f);
+    
+    // Prepare context prompt
+    std::string context_prompt = config_.enable_context ? prepareContextPrompt(context.previous_text) : "";
+    
+    TranscriptionResult result;
+    result.start_sample = chunk.start_sample;
+    result.end_sample = chunk.end_sample;
+    result.timestamp = float(chunk.start_sample) / SAMPLE_RATE;
+    result.is_partial = false;
+    result.confidence = 0.0f;
+    
+    if (!runWhisper(state, audio.data(), audio.size(), context_prompt, n_threads, result, &words)) {
+        std::cerr << "❌ Transcription failed" << std::endl;
+        words.clear();
+        return result;
+    }
+    
+    // Remove what the previous chunk already transcribed from the shared audio
+    size_t redundant = OverlapBudget::redundantSamples(chunk, context.end_sample);
+    size_t dropped = config_.remove_context_overlap ? removeContextualOverlap(context, redundant, words) : 0;
+    if (dropped > 0) {
+        result.text.clear();
+        for (const TimedWord& word : words) {
+            if (!result.text.empty()) {
+                result.text += " ";
+            }
+            result.text += word.text;
+        }
     }
+    overlap_.record(chunk.audio.size(), redundant, dropped);
     
     return result;
 }
 
-void StreamingTranscriber::updateContext(const TranscriptionResult& result, const std::vector<float>& audio_data) {
-    std::lock_guard<std::mutex> lock(context_mutex_);
+void StreamingTranscriber::updateContext(ContextWindow& context, const TranscriptionResult& result,
+                                         const AudioChunk& chunk, const std::vector<TimedWord>& words) {
+    context.end_sample = chunk.end_sample;
+    
+    // Words in the audio the next chunk starts with (word times are relative to
+    // the chunk). The chunker recorded where that is: its lead-in follows the
+    // adapted chunk length, and trimming may have moved this chunk's edges
+    uint64_t tail_start = chunk.next_start_sample > chunk.start_sample ? chunk.next_start_sample - chunk.start_sample : 0;
+    context.tail_words.clear();
+    for (const TimedWord& word : words) {
+        if (word.end_sample > tail_start) {
+            context.tail_words.push_back(word.text);
+        }
+    }
     
-    // Update text context
-    context_.previous_text = result.text;
-    context_.timestamp = result.timestamp;
+    // The prompt only moves on when something was said
+    if (result.text.empty()) {
+        return;
+    }
+    context.previous_text = result.text;
+    context.timestamp = result.timestamp;
     
     // Count words for prompt truncation
-    context_.word_count = 0;
+    context.word_count = 0;
     std::istringstream iss(result.text);
     std::string word;
     while (iss >> word) {
-        context_.word_count++;
-    }
-    
-    // Update audio context (keep last N seconds)
-    int context_samples = (config_.context_duration_ms * SAMPLE_RATE) / 1000;
-    if (audio_data.size() <= context_samples) {
-        context_.previous_audio = audio_data;
-    } else {
-        context_.previous_audio.assign(
-            audio_data.end() - context_samples, 
-            audio_data.end()
-        );
+        context.word_count++;
     }
 }
 
@@ -571,79 +1223,41 @@ std::string StreamingTranscriber::prepareContextPrompt(const std::string& previo
     return prompt;
 }
 
-TranscriptionResult StreamingTranscriber::removeContextualOverlap(const TranscriptionResult& result) {
-    // Simple overlap removal - look for common words at the beginning
-    TranscriptionResult clean_result = result;
-    
-    if (context_.previous_text.empty() || result.text.empty()) {
-        return clean_result;
+size_t StreamingTranscriber::removeContextualOverlap(const ContextWindow& context, size_t redundant_samples,
+                                                     std::vector<TimedWord>& words) {
+    if (redundant_samples == 0 || words.empty()) {
+        return 0;
     }
     
-    // Split into words
-    std::istringstream prev_iss(context_.previous_text);
-    std::istringstream curr_iss(result.text);
-    
-    std::vector<std::string> prev_words;
-    std::vector<std::string> curr_words;
-    
-    std::string word;
-    while (prev_iss >> word) prev_words.push_back(word);
-    while (curr_iss >> word) curr_words.push_back(word);
+    // Words wholly inside the lead-in were heard in full by the previous chunk
+    size_t inside = 0;
+    while (inside < words.size() && words[inside].end_sample <= redundant_samples) {
+        inside++;
+    }
     
-    // Find overlap (last words of previous match first words of current)
-    int overlap_count = 0;
-    int max_check = std::min(prev_words.size(), curr_words.size());
-    max_check = std::min(max_check, 10); // Don't check more than 10 words
+    // Words straddling the boundary were heard by both chunks, or cut off at
+    // the end of the previous one; drop them only when the previous chunk's
+    // words over the same audio end with them
+    const size_t slack = SAMPLE_RATE / 2;
+    size_t straddling = 0;
+    while (inside + straddling < words.size() &&
+           words[inside + straddling].start_sample < redundant_samples + slack) {
+        straddling++;
+    }
+    size_t max_check = std::min({straddling, context.tail_words.size(), size_t(10)});
     
-    for (int i = 1; i <= max_check; i++) {
+    size_t overlap_count = 0;
+    for (size_t i = 1; i <= max_check; i++) {
         bool matches = true;
-        for (int j = 0; j < i; j++) {
-            if (prev_words[prev_words.size() - i + j] != curr_words[j]) {
-                matches = false;
-                break;
-            }
+        for (size_t j = 0; j < i && matches; j++) {
+            matches = sameSpokenWord(context.tail_words[context.tail_words.size() - i + j], words[inside + j].text);
         }
         if (matches) {
             overlap_count = i;
         }
     }
     
-    // Remove overlapping words from current result
-    if (overlap_count > 0 && overlap_count < curr_words.size()) {
-        std::string clean_text;
-        for (int i = overlap_count; i < curr_words.size(); i++) {
-            if (!clean_text.empty()) {
-                clean_text += " ";
-            }
-            clean_text += curr_words[i];
-        }
-        clean_result.text = clean_text;
-    }
-    
-    return clean_result;
+    size_t dropped = inside + overlap_count;
+    words.erase(words.begin(), words.begin() + dropped);
+    return dropped;
 }
-
-std::vector<float> StreamingTranscriber::prepareContextualAudio(const std::vector<float>& current_audio) {
-    std::lock_guard<std::mutex> lock(context_mutex_);
-    
-    // If no previous context, return current audio
-    if (context_.previous_audio.empty()) {
-        return current_audio;
-    }
-    
-    // Combine previous context audio with current audio
-    std::vector<float> contextual_audio;
-    contextual_audio.reserve(context_.previous_audio.size() + current_audio.size());
-    
-    // Add previous audio context
-    contextual_audio.insert(contextual_audio.end(), 
-                           context_.previous_audio.begin(), 
-                           context_.previous_audio.end());
-    
-    // Add current audio
-    contextual_audio.insert(contextual_audio.end(), 
-                           current_audio.begin(), 
-                           current_audio.end());
-    
-    return contextual_audio;
-}
\ No newline at end of file
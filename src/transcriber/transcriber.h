@@ -6,10 +6,22 @@
 #include <functional>
 #include <atomic>
 #include <thread>
-#include <queue>
 #include <mutex>
-#include <condition_variable>
 #include <optional>
+#include "ring_buffer.h"
+#include "wire_protocol.h"
+#include "shm_ring.h"
+#include "audio_pool.h"
+#include "chunk_queue.h"
+#include "vad_gate.h"
+#include "chunk_controller.h"
+#include "local_agreement.h"
+#include "overlap_budget.h"
+#include "edge_trim.h"
+#include "pcm_source.h"
+#include "whisper_model.h"
+#include "decode_scheduler.h"
+#include "wakeup.h"
 
 struct whisper_context;
 struct whisper_state;
@@ -17,17 +29,34 @@ struct whisper_state;
 // Forward declarations
 class SmartChunker;
 
+// Samples lost between the pipe reader and the chunker
+struct SampleGap {
+    uint64_t position;  // Timeline position of the first lost sample
+    uint64_t count;
+};
+
+// How audio reaches the transcriber from the capture process
+enum class AudioTransport {
+    Pipe,          // A PcmSource (command, FIFO, file or stdin) read by audioReaderThread
+    SharedMemory   // ShmAudioRing read in place by the chunker
+};
+
 struct TranscriptionConfig {
     std::string model_path;
     std::string language = "en";
     bool translate = false;
     int threads = 4;
+    bool warmup = true;                  // Decode silence once at startup to pay first-call setup early
     float temperature = 0.0f;
     int max_tokens = 224;
     bool enable_vad = true;
     float vad_threshold = 0.6f;
+    VadMode vad_mode = VadMode::Energy;
+    std::string vad_model_path = "models/ggml-silero-v5.1.2.bin"; // VadMode::Whisper only
+    int vad_window_ms = 200;             // Energy smoothing window of the frame VAD
+    int vad_hangover_ms = 300;           // Voice stays on this long after energy drops
     int chunk_duration_ms = 3000;
-    int overlap_ms = 500;
+    int overlap_ms = 500;                // Lead-in re-fed to each chunk without context
     bool timestamps = true;
     
     // Smart chunking parameters
@@ -37,26 +66,70 @@ struct TranscriptionConfig {
     float silence_threshold = 0.02f;
     int min_silence_duration_ms = 300;   // 300ms silence to split
     bool enable_smart_chunking = true;
+    bool trim_edges = true;              // Strip quiet chunk edges before decoding
+    int edge_guard_ms = 200;             // Quiet audio kept next to the first/last loud sample
+    
+    // Adaptive chunk sizing (smart chunking only)
+    bool adaptive_chunking = false;      // Resize chunks from measured decode speed
+    int target_latency_ms = 8000;        // First word of a chunk to its text
+    int adaptive_min_optimal_ms = 3000;  // Bounds on the adapted optimal length
+    int adaptive_max_optimal_ms = 20000;
+    
+    // Streaming partials (live input; replaces chunking)
+    bool streaming_partials = false;     // Re-decode a growing window, commit what stays stable
+    int partial_interval_ms = 500;       // New audio between re-decodes
+    int partial_trim_ms = 10000;         // Window length past which committed audio is trimmed
     
     // Context management parameters
     bool enable_context = true;
-    int context_duration_ms = 2000;      // 2 seconds of audio context
+    int context_duration_ms = 2000;      // Lead-in re-fed to each chunk (see OverlapBudget)
     int max_prompt_tokens = 200;         // Max tokens for context prompt
     bool remove_context_overlap = true;  // Remove overlap from final output
+    
+    // Ingestion parameters
+    AudioTransport transport = AudioTransport::Pipe;
+    int read_block_bytes = 16384;        // Bytes per read(2) from the pipe (4-64 KiB)
+    bool framed_input = false;           // Pipe carries AudioFrameHeader frames, not raw samples
+    AudioSampleFormat raw_format = AudioSampleFormat::Float32; // Sample format of an unframed pipe
+    int ring_buffer_size = 16384;        // Samples buffered between pipe reader and chunker
+    int chunk_queue_size = 10;           // Chunks waiting for transcription
+    QueueOverflowPolicy queue_overflow_policy = QueueOverflowPolicy::DropNewest;
+    
+    // Scheduling on a shared DecodeScheduler (daemon sessions)
+    DecodePriority decode_priority = DecodePriority::Live;
+    float decode_weight = 1.0f;          // Share of decode time within its class
+    int latency_slo_ms = 0;              // Chunk queued to decoded; 0 = class default
+};
+
+// Where initialize() spent its time
+struct StartupTimings {
+    double model_load_ms = 0.0;
+    double state_ms = 0.0;      // Decoder state and its compute buffers
+    double vad_load_ms = 0.0;   // Silero model (VadMode::Whisper only)
+    double warmup_ms = 0.0;     // Silence decode; 0 with warmup off
+    bool model_shared = false;  // Another session in this process had it loaded
+    size_t model_bytes = 0;     // RSS growth from loading the weights; 0 when shared
+    size_t state_bytes = 0;     // RSS growth from the decoder state and its first decode
+
+    double totalMs() const { return model_load_ms + state_ms + vad_load_ms + warmup_ms; }
 };
 
 struct TranscriptionResult {
     std::string text;
-    float timestamp;
+    float timestamp;            // Seconds, derived from start_sample
     float confidence;
-    bool is_partial;
+    bool is_partial;            // Streaming: unconfirmed words, replaced by the next result
+    uint64_t start_sample = 0;  // Position on the session sample timeline
+    uint64_t end_sample = 0;
+    bool ends_utterance = false; // Streaming: committed words close an utterance (pause or window limit)
 };
 
 struct ContextWindow {
     std::string previous_text;
-    std::vector<float> previous_audio;
     float timestamp;
     int word_count = 0;
+    uint64_t end_sample = 0;              // Where the previous decode ended
+    std::vector<std::string> tail_words;  // Its words in the audio the next chunk starts with
 };
 
 using TranscriptionCallback = std::function<void(const TranscriptionResult&)>;
@@ -67,98 +140,124 @@ public:
     ~StreamingTranscriber();
     
     bool initialize();
-    void start(const std::string& pipe_path, TranscriptionCallback callback);
+    // Reads a FIFO at source_path, or attaches to the shared memory ring of that name
+    void start(const std::string& source_path, TranscriptionCallback callback);
+    // Pipe transport from an opened source; the caller keeps it alive until stop()
+    void start(PcmSource& source, TranscriptionCallback callback);
+    // Decode on a scheduler shared with other transcribers instead of a
+    // thread of our own; set before start(), and the scheduler outlives stop()
+    void useScheduler(DecodeScheduler* scheduler) { scheduler_ = scheduler; }
     void stop();
     bool isRunning() const { return is_running_.load(); }
+    // The source ran out (file or stdin at EOF, or a command not restarted)
+    // and everything read from it, down to the chunker's last partial chunk,
+    // has been decoded and handed to the callback
+    bool sourceEnded() const;
+    ChunkQueueStats queueStats() const;
+    AudioPoolStats poolStats() const { return pool_.stats(); }
+    ChunkSizingStats chunkSizingStats() const { return chunk_controller_.stats(); }
+    OverlapStats overlapStats() const { return overlap_.stats(); }
+    EdgeTrimStats edgeTrimStats() const { return edge_trimmer_.stats(); }
+    StartupTimings startupTimings() const { return startup_; }
+    
+    // Offline mode: transcribes a WAV file as fast as the decoders allow and
+    // returns when done (or when stop() is called). Results arrive in order.
+    bool transcribeFile(const std::string& wav_path, int decoders, TranscriptionCallback callback);
     
 private:
-    void audioReaderThread(const std::string& pipe_path);
+    void launch(PcmSource* source, TranscriptionCallback callback);
+    void audioReaderThread(PcmSource* source);
+    void chunkerThread();
+    void sharedMemoryChunkerThread();
+    void feedChunker(const float* samples, size_t count);
+    void feedStream(const float* samples, size_t count);
+    void flushChunker();  // End of input: emits the audio the chunker still holds
     void transcriptionThread();
-    void processAudioChunk(const std::vector<float>& audio_data, float timestamp);
-    bool detectVoiceActivity(const std::vector<float>& audio_data);
-    TranscriptionResult transcribeChunk(const std::vector<float>& audio_data, float timestamp);
+    bool decodeNext();    // One queued chunk; false if there was none
+    void wakeDecoder();   // Tells the scheduler chunks may be queued
+    void wakeDecoder(std::chrono::steady_clock::time_point queued_at);  // A chunk was queued
+    void processAudioChunk(const AudioChunk& chunk);
+    void processStreamWindow(const AudioChunk& chunk);
+    void enqueueChunk(AudioChunkPtr chunk);
+    bool warmup();
+    bool runWhisper(whisper_state* state, const float* audio, size_t count,
+                    const std::string& prompt, int n_threads, TranscriptionResult& result,
+                    std::vector<TimedWord>* words = nullptr);
     
-    // Context management methods
-    TranscriptionResult transcribeWithContext(const std::vector<float>& audio_data, float timestamp);
-    void updateContext(const TranscriptionResult& result, const std::vector<float>& audio_data);
+    // Context management methods; each decoder state chains its own window
+    TranscriptionResult transcribeWithContext(whisper_state* state, int n_threads, const ContextWindow& context,
+                                              const AudioChunk& chunk, std::vector<TimedWord>& words);
+    void updateContext(ContextWindow& context, const TranscriptionResult& result,
+                       const AudioChunk& chunk, const std::vector<TimedWord>& words);
     std::string prepareContextPrompt(const std::string& previous_text);
-    TranscriptionResult removeContextualOverlap(const TranscriptionResult& result);
-    std::vector<float> prepareContextualAudio(const std::vector<float>& current_audio);
+    size_t removeContextualOverlap(const ContextWindow& context, size_t redundant_samples,
+                                   std::vector<TimedWord>& words);
     
     TranscriptionConfig config_;
-    whisper_context* whisper_ctx_;
+    AudioBlockPool pool_;  // Declared first: outlives every buffer, chunk and context holding its blocks
+    std::shared_ptr<WhisperModel> model_;
+    whisper_context* whisper_ctx_;  // model_'s context
     whisper_state* whisper_state_;
+    bool discard_warmup_context_ = false;  // The next decode on whisper_state_ must not prompt with the warmup's text
+    StartupTimings startup_;
     
     std::atomic<bool> is_running_{false};
     std::thread audio_reader_thread_;
+    std::thread chunker_thread_;
     std::thread transcription_thread_;
+    DecodeScheduler* scheduler_ = nullptr;  // Replaces transcription_thread_ when set
+    uint64_t scheduler_session_ = 0;
     
-    // Audio processing
-    std::queue<std::pair<std::vector<float>, float>> audio_queue_;
-    std::mutex audio_queue_mutex_;
-    std::condition_variable audio_queue_cv_;
+    // Samples handed from the pipe reader to the chunker
+    std::unique_ptr<SpscRingBuffer<float>> sample_ring_;
+    std::unique_ptr<SpscRingBuffer<SampleGap>> gap_ring_;
+    Wakeup samples_ready_;  // The chunker waits here for the reader
+    std::unique_ptr<ShmAudioRing> shm_ring_;
+    std::unique_ptr<PcmSource> owned_source_;  // FIFO opened by start(source_path)
+    std::atomic<bool> source_ended_{false};
+    std::atomic<bool> chunker_drained_{false};  // The chunker has queued its last chunk after source_ended_
+    std::atomic<bool> decoding_{false};         // A chunk is popped and its results not yet delivered
+    std::atomic<uint64_t> dropped_samples_{0};
+    std::atomic<uint64_t> gap_overflow_samples_{0};  // Audio merged into a gap the full gap ring could not take
+    AudioFrameStats frame_stats_;
     
-    // VAD state
-    std::vector<float> vad_buffer_;
-    float running_energy_avg_;
+    // Chunks handed from the chunker to the transcription thread
+    std::unique_ptr<ChunkQueue> chunk_queue_;
+    AudioChunkPtr next_chunk_;  // Being filled by the smart chunker
+    
+    // Decides which chunks are worth decoding, and how much of each
+    VoiceActivityGate vad_;
+    EdgeTrimmer edge_trimmer_;
     
     // Callback
     TranscriptionCallback callback_;
     
-    // Overlap handling
-    std::vector<float> overlap_buffer_;
-    float last_chunk_timestamp_;
+    // Fixed chunking state (overlap carried at the front of the buffer)
+    SampleBuffer fixed_buffer_;
+    uint64_t fixed_start_sample_;
     
     // Smart chunking
     std::unique_ptr<SmartChunker> smart_chunker_;
+    AdaptiveChunkController chunk_controller_;
+    uint64_t chunk_sizing_generation_;  // Controller generation the chunker runs with
+    
+    // Streaming partials: the chunker grows one window and trims what the
+    // decoder has committed; agreement_ belongs to the transcription thread
+    SampleBuffer stream_buffer_;
+    uint64_t stream_start_sample_;
+    size_t stream_new_samples_;              // Arrived since the last window was sent
+    bool stream_has_speech_;                 // A window since the last final one held speech
+    std::atomic<uint64_t> stream_commit_sample_{0};
+    LocalAgreement agreement_;
+    std::string last_partial_text_;
     
     // Context management
     ContextWindow context_;
     std::mutex context_mutex_;
+    OverlapBudget overlap_;
     
     static constexpr int SAMPLE_RATE = 16000;
-    static constexpr int MAX_QUEUE_SIZE = 10;
+    static constexpr int CHUNKER_BLOCK_SAMPLES = 4096;
+    static constexpr int GAP_RING_SIZE = 256;
+    static constexpr int STREAM_LEAD_MS = 300;         // Audio kept ahead of speech onset
 };
-
-class VoiceActivityDetector {
-public:
-    VoiceActivityDetector(float threshold = 0.6f, int window_size = 512);
-    
-    bool isVoiceActive(const std::vector<float>& audio_data);
-    void reset();
-    
-private:
-    float threshold_;
-    int window_size_;
-    std::vector<float> energy_buffer_;
-    float background_energy_;
-    int frame_count_;
-    
-    float calculateEnergy(const std::vector<float>& audio_data);
-    void updateBackgroundEnergy(float energy);
-};
-
-struct AudioChunk {
-    std::vector<float> audio;
-    float timestamp;
-    bool is_final = false;
-};
-
-class SmartChunker {
-public:
-    SmartChunker(const TranscriptionConfig& config);
-    
-    std::optional<AudioChunk> processAudio(const std::vector<float>& new_audio, float timestamp);
-    void reset();
-    
-private:
-    TranscriptionConfig config_;
-    std::vector<float> buffer_;
-    float last_speech_time_;
-    VoiceActivityDetector vad_;
-    
-    bool isSilentWindow(const std::vector<float>& audio, int start, int length);
-    AudioChunk extractChunk(int samples);
-    
-    static constexpr int SAMPLE_RATE = 16000;
-};
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "vad_gate.h"
+#include "chunk_queue.h"
+#include "transcriber.h"
+#include <algorithm>
+
+namespace {
+
+constexpr int SAMPLE_RATE = 16000;
+constexpr int FRAME_MS = 20;  // Energy and spectral frames
+
+} // namespace
+
+const char* vadModeName(VadMode mode) {
+    switch (mode) {
+        case VadMode::Energy: return "energy";
+        case VadMode::Spectral: return "spectral";
+        case VadMode::Whisper: return "whisper";
+    }
+    return "unknown";
+}
+
+VoiceActivityGate::VoiceActivityGate(const TranscriptionConfig& config)
+    : mode_(config.vad_mode)
+    , model_path_(config.vad_model_path)
+    , threshold_(config.vad_threshold)
+    , whisper_hangover_frames_(config.vad_hangover_ms * SAMPLE_RATE / 1000 / WhisperVadPolicy::FRAME_SAMPLES)
+    , vad_(std::in_place_type<EnergyVad>, ENERGY_VAD_ONSET_FRAMES, config.vad_hangover_ms / FRAME_MS,
+           config.vad_threshold, FRAME_MS * SAMPLE_RATE / 1000,
+           std::max(config.vad_window_ms / FRAME_MS, 1), config.silence_threshold)
+    , position_(0) {
+    if (mode_ == VadMode::Spectral) {
+        vad_.emplace<SpectralVad>(SPECTRAL_VAD_ONSET_FRAMES, config.vad_hangover_ms / FRAME_MS,
+                                  config.vad_threshold, SAMPLE_RATE,
+                                  std::max(config.vad_window_ms / FRAME_MS, 1),
+                                  config.vad_hangover_ms / FRAME_MS, config.silence_threshold);
+    }
+}
+
+bool VoiceActivityGate::initialize() {
+    if (mode_ != VadMode::Whisper) {
+        return true;
+    }
+    WhisperVad& vad = vad_.emplace<WhisperVad>(WHISPER_VAD_ONSET_FRAMES, whisper_hangover_frames_,
+                                               model_path_, threshold_);
+    return vad.policy().isLoaded();
+}
+
+bool VoiceActivityGate::containsSpeech(const AudioChunk& chunk) {
+    size_t skip = position_ > chunk.start_sample
+        ? std::min<uint64_t>(position_ - chunk.start_sample, chunk.audio.size())
+        : 0;
+    position_ = std::max(position_, chunk.end_sample);
+
+    return std::visit([&](auto& vad) {
+        size_t voiced_frames = 0;
+        for (const SampleSpan::Segment& segment : chunk.audio.segments()) {
+            if (skip >= segment.count) {
+                skip -= segment.count;
+                continue;
+            }
+            voiced_frames += vad.process(segment.data + skip, segment.count - skip);
+            skip = 0;
+        }
+        // A chunk with nothing new (end-of-stream remainder) follows the current state
+        return voiced_frames > 0 || vad.isVoiceActive();
+    }, vad_);
+}
+
+size_t VoiceActivityGate::process(const float* samples, size_t count) {
+    return std::visit([&](auto& vad) { return vad.process(samples, count); }, vad_);
+}
+
+bool VoiceActivityGate::isVoiceActive() const {
+    return std::visit([](const auto& vad) { return vad.isVoiceActive(); }, vad_);
+}
+
+void VoiceActivityGate::reset() {
+    std::visit([](auto& vad) { vad.reset(); }, vad_);
+    position_ = 0;
+}
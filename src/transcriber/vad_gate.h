@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <variant>
+#include "voice_activity.h"
+#include "whisper_vad.h"
+
+struct AudioChunk;
+struct TranscriptionConfig;
+
+// How the VAD decides audio holds speech
+enum class VadMode {
+    Energy,    // Frame energy over the noise floor
+    Spectral,  // Energy plus speech-band shape, flatness, ZCR and modulation
+    Whisper    // whisper.cpp's built-in Silero VAD (needs vad_model_path)
+};
+
+const char* vadModeName(VadMode mode);
+
+// The pipeline's one VAD: every chunk the smart or fixed chunker cuts is
+// checked here before it is queued, and chunks without speech never reach
+// the decoder. The backend is chosen at runtime, but each one is a FrameVad
+// instantiation held in a variant, so the choice is dispatched once per call
+// and the per-frame loop underneath has no virtual calls.
+class VoiceActivityGate {
+public:
+    explicit VoiceActivityGate(const TranscriptionConfig& config);
+
+    // Loads the backend's model when it has one (Whisper)
+    bool initialize();
+
+    // Feeds the part of the chunk earlier chunks did not already cover
+    // (fixed chunks overlap) and returns whether the chunk holds speech
+    bool containsSpeech(const AudioChunk& chunk);
+
+    size_t process(const float* samples, size_t count);
+    bool isVoiceActive() const;
+    VadMode mode() const { return mode_; }
+    void reset();
+
+private:
+    VadMode mode_;
+    std::string model_path_;
+    float threshold_;
+    size_t whisper_hangover_frames_;
+    std::variant<EnergyVad, SpectralVad, WhisperVad> vad_;
+    uint64_t position_;  // Timeline position the detector has been fed up to
+};
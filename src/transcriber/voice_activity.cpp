@@ -0,0 +1,197 @@
+#include "voice_activity.h"
+#include "audio_energy.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Speech-likeness limits of the spectral detector, set on the labelled mix
+// of audio_bench vad-eval
+constexpr float SPEECH_BAND_LOW_HZ = 300.0f;
+constexpr float SPEECH_BAND_HIGH_HZ = 3400.0f;
+constexpr float MIN_SPEECH_BAND_RATIO = 0.5f;
+constexpr float MAX_SPECTRAL_FLATNESS = 0.3f;
+constexpr float MAX_ZERO_CROSSING_RATE = 0.25f;
+constexpr float MIN_MODULATION_DB = 3.0f;
+constexpr int MODULATION_WINDOW_MS = 500;
+constexpr int SPECTRAL_FRAME_MS = 20;
+
+size_t fftSizeFor(size_t frame_samples) {
+    size_t size = 4;
+    while (size < frame_samples) {
+        size <<= 1;
+    }
+    return size;
+}
+
+} // namespace
+
+EnergyVadPolicy::EnergyVadPolicy(float threshold, size_t frame_samples, size_t window_frames, float min_energy)
+    : frame_samples_(std::max<size_t>(frame_samples, 1))
+    , min_energy_(min_energy)
+    , energy_ring_(std::max<size_t>(window_frames, 1)) {
+    // Map sensitivity onto RMS ratios over the noise floor: the default 0.6
+    // switches on at 3.4x (~10.6 dB) and off below 2.2x (~6.8 dB)
+    threshold = std::clamp(threshold, 0.0f, 1.0f);
+    on_ratio_ = 1.0f + 4.0f * threshold;
+    off_ratio_ = 1.0f + 2.0f * threshold;
+    reset();
+}
+
+void EnergyVadPolicy::reset() {
+    std::fill(energy_ring_.begin(), energy_ring_.end(), 0.0f);
+    ring_next_ = 0;
+    ring_filled_ = 0;
+    energy_sum_ = 0.0;
+    energy_compensation_ = 0.0;
+    background_energy_ = 0.0f;
+    frame_count_ = 0;
+}
+
+FrameVerdict EnergyVadPolicy::classify(const float* frame) {
+    float energy = std::sqrt(energySumOfSquares(frame, frame_samples_) / frame_samples_);
+    updateBackgroundEnergy(energy);
+
+    // Replace the oldest energy in the window: one add, one subtract
+    if (ring_filled_ == energy_ring_.size()) {
+        addToSum(-double(energy_ring_[ring_next_]));
+    } else {
+        ring_filled_++;
+    }
+    energy_ring_[ring_next_] = energy;
+    addToSum(energy);
+    ring_next_ = (ring_next_ + 1) % energy_ring_.size();
+
+    float smoothed = static_cast<float>(energy_sum_ / ring_filled_);
+    if (smoothed > std::max(on_ratio_ * background_energy_, min_energy_)) {
+        return FrameVerdict::Onset;
+    }
+    if (smoothed > std::max(off_ratio_ * background_energy_, min_energy_)) {
+        return FrameVerdict::Hold;
+    }
+    return FrameVerdict::Silence;
+}
+
+void EnergyVadPolicy::addToSum(double value) {
+    double y = value - energy_compensation_;
+    double t = energy_sum_ + y;
+    energy_compensation_ = (t - energy_sum_) - y;
+    energy_sum_ = t;
+}
+
+void EnergyVadPolicy::updateBackgroundEnergy(float energy) {
+    const float alpha = 0.01f; // Very slow adaptation
+
+    if (frame_count_ == 0) {
+        background_energy_ = energy;
+    } else if (energy < background_energy_ * 2.0f) {
+        // Only update background if current energy is low (likely background)
+        background_energy_ = alpha * energy + (1.0f - alpha) * background_energy_;
+    } else {
+        // Creep up so a room that got louder (or digital silence that
+        // turned into room noise) is eventually learned
+        background_energy_ = std::max(background_energy_, 1e-5f) * 1.0005f;
+    }
+
+    frame_count_++;
+}
+
+LevelVadPolicy::LevelVadPolicy(float level, size_t frame_samples)
+    : frame_samples_(std::max<size_t>(frame_samples, 1))
+    , min_sum_of_squares_(level * level * frame_samples_) {
+}
+
+FrameVerdict LevelVadPolicy::classify(const float* frame) {
+    return energySumOfSquares(frame, frame_samples_) > min_sum_of_squares_ ? FrameVerdict::Onset : FrameVerdict::Silence;
+}
+
+SpectralVadPolicy::SpectralVadPolicy(float threshold, int sample_rate, size_t window_frames,
+                                     size_t hangover_frames, float min_energy)
+    : energy_(ENERGY_VAD_ONSET_FRAMES, hangover_frames, threshold,
+              std::max(sample_rate * SPECTRAL_FRAME_MS / 1000, 2), window_frames, min_energy)
+    , frame_samples_(std::max(sample_rate * SPECTRAL_FRAME_MS / 1000, 2))
+    , fft_(fftSizeFor(frame_samples_))
+    , window_(fft_.size(), 0.0f)
+    , windowed_(fft_.size(), 0.0f)
+    , power_(fft_.bins())
+    , level_ring_(MODULATION_WINDOW_MS / SPECTRAL_FRAME_MS) {
+    const double pi = 3.14159265358979323846;
+    for (size_t i = 0; i < frame_samples_; i++) {
+        window_[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * pi * i / (frame_samples_ - 1)));
+    }
+
+    float bin_hz = float(sample_rate) / fft_.size();
+    band_begin_ = std::max<size_t>(size_t(SPEECH_BAND_LOW_HZ / bin_hz), 1);
+    band_end_ = std::min(size_t(SPEECH_BAND_HIGH_HZ / bin_hz) + 1, fft_.bins());
+    band_end_ = std::max(band_end_, band_begin_ + 1);
+    reset();
+}
+
+void SpectralVadPolicy::reset() {
+    energy_.reset();
+    std::fill(level_ring_.begin(), level_ring_.end(), 0.0f);
+    level_next_ = 0;
+    level_filled_ = 0;
+    features_ = Features();
+}
+
+FrameVerdict SpectralVadPolicy::classify(const float* frame) {
+    bool loud = energy_.process(frame, frame_samples_) > 0;
+    float mean_square = energySumOfSquares(frame, frame_samples_) / frame_samples_;
+    features_.energy = std::sqrt(mean_square);
+
+    size_t crossings = 0;
+    for (size_t i = 1; i < frame_samples_; i++) {
+        crossings += (frame[i - 1] < 0.0f) != (frame[i] < 0.0f);
+    }
+    features_.zero_crossing_rate = float(crossings) / (frame_samples_ - 1);
+
+    // Syllables swing the level by 10 dB or more several times a second;
+    // fans and held notes barely move it
+    level_ring_[level_next_] = 10.0f * std::log10(mean_square + 1e-10f);
+    level_next_ = (level_next_ + 1) % level_ring_.size();
+    level_filled_ = std::min(level_filled_ + 1, level_ring_.size());
+    float level_sum = 0.0f;
+    float level_sum_sq = 0.0f;
+    for (size_t i = 0; i < level_filled_; i++) {
+        level_sum += level_ring_[i];
+        level_sum_sq += level_ring_[i] * level_ring_[i];
+    }
+    float level_mean = level_sum / level_filled_;
+    features_.modulation_db = std::sqrt(std::max(level_sum_sq / level_filled_ - level_mean * level_mean, 0.0f));
+
+    // Quiet frames still feed the modulation history above, but the spectrum
+    // of room noise says nothing, so skip the FFT
+    if (!loud) {
+        features_.speech_band_ratio = 0.0f;
+        features_.flatness = 1.0f;
+        return FrameVerdict::Silence;
+    }
+
+    for (size_t i = 0; i < frame_samples_; i++) {
+        windowed_[i] = frame[i] * window_[i];
+    }
+    fft_.powerSpectrum(windowed_.data(), power_.data());
+
+    float total = 0.0f;
+    for (size_t k = 1; k < power_.size(); k++) {
+        total += power_[k];
+    }
+    float band = 0.0f;
+    float log_band = 0.0f;
+    for (size_t k = band_begin_; k < band_end_; k++) {
+        band += power_[k];
+        log_band += std::log(power_[k] + 1e-20f);
+    }
+    size_t band_bins = band_end_ - band_begin_;
+    features_.speech_band_ratio = total > 0.0f ? band / total : 0.0f;
+    features_.flatness = band > 0.0f
+        ? std::exp(log_band / band_bins) / (band / band_bins)
+        : 1.0f;
+
+    bool speech_like = features_.speech_band_ratio >= MIN_SPEECH_BAND_RATIO
+        && features_.flatness <= MAX_SPECTRAL_FLATNESS
+        && features_.zero_crossing_rate <= MAX_ZERO_CROSSING_RATE
+        && features_.modulation_db >= MIN_MODULATION_DB;
+    return speech_like ? FrameVerdict::Onset : FrameVerdict::Silence;
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "fft.h"
+
+// What a VAD policy makes of one frame
+enum class FrameVerdict {
+    Silence,  // Nothing speech-like; counts down the hangover
+    Hold,     // Enough to keep voice on, not enough to switch it on
+    Onset     // Speech-like enough to switch voice on
+};
+
+// Frame loop shared by every VAD backend. The backend is a compile-time
+// Policy providing
+//   size_t frameSamples() const;
+//   FrameVerdict classify(const float* frame);  // frameSamples() samples
+//   void reset();
+// so the per-frame call is direct and inlinable, with no virtual dispatch.
+// FrameVad adds partial-frame carry-over (whole frames are classified in
+// place, only a frame straddling two calls is copied) and the hysteresis:
+// voice switches on after onset_frames Onset frames in a row and off after
+// hangover_frames frames of Silence.
+template <typename Policy>
+class FrameVad {
+public:
+    template <typename... PolicyArgs>
+    FrameVad(size_t onset_frames, size_t hangover_frames, PolicyArgs&&... policy_args)
+        : policy_(std::forward<PolicyArgs>(policy_args)...)
+        , onset_frames_(std::max<size_t>(onset_frames, 1))
+        , hangover_frames_(hangover_frames)
+        , partial_(policy_.frameSamples()) {
+        reset();
+    }
+
+    // Feeds samples of any length; returns how many of the frames completed
+    // by this call were voiced
+    size_t process(const float* samples, size_t count) {
+        const size_t frame_samples = partial_.size();
+        size_t voiced_frames = 0;
+        while (count > 0) {
+            if (partial_fill_ == 0 && count >= frame_samples) {
+                voiced_frames += step(policy_.classify(samples)) ? 1 : 0;
+                samples += frame_samples;
+                count -= frame_samples;
+                continue;
+            }
+            size_t n = std::min(count, frame_samples - partial_fill_);
+            std::copy(samples, samples + n, partial_.begin() + partial_fill_);
+            partial_fill_ += n;
+            samples += n;
+            count -= n;
+            if (partial_fill_ == frame_samples) {
+                voiced_frames += step(policy_.classify(partial_.data())) ? 1 : 0;
+                partial_fill_ = 0;
+            }
+        }
+        return voiced_frames;
+    }
+
+    bool isVoiceActive() const { return voiced_; }
+
+    void reset() {
+        policy_.reset();
+        partial_fill_ = 0;
+        voiced_ = false;
+        onset_run_ = 0;
+        hangover_left_ = 0;
+    }
+
+    Policy& policy() { return policy_; }
+    const Policy& policy() const { return policy_; }
+
+private:
+    Policy policy_;
+    size_t onset_frames_;
+    size_t hangover_frames_;
+    std::vector<float> partial_;      // Frame straddling two process() calls
+    size_t partial_fill_;
+    bool voiced_;
+    size_t onset_run_;                // Consecutive Onset frames while off
+    size_t hangover_left_;
+
+    bool step(FrameVerdict verdict) {
+        if (!voiced_) {
+            onset_run_ = verdict == FrameVerdict::Onset ? onset_run_ + 1 : 0;
+            if (onset_run_ >= onset_frames_) {
+                voiced_ = true;
+                hangover_left_ = hangover_frames_;
+            }
+        } else if (verdict != FrameVerdict::Silence) {
+            hangover_left_ = hangover_frames_;
+        } else if (hangover_left_ > 0) {
+            hangover_left_--;
+        } else {
+            voiced_ = false;
+            onset_run_ = 0;
+        }
+        return voiced_;
+    }
+};
+
+// Energy backend. Each frame's RMS goes into a fixed ring whose sum is kept
+// running (Kahan-compensated, so adding and evicting for hours does not
+// drift), making the smoothed energy O(1) per frame for any window length.
+// The smoothed energy is compared against a slowly tracked noise floor:
+// Onset above on_ratio x floor, Hold above off_ratio x floor.
+class EnergyVadPolicy {
+public:
+    // threshold is the user-facing sensitivity (0.0-1.0, higher needs louder
+    // speech); min_energy is an absolute RMS below which nothing is voice
+    EnergyVadPolicy(float threshold = 0.6f, size_t frame_samples = 320, size_t window_frames = 10,
+                    float min_energy = 0.0f);
+
+    size_t frameSamples() const { return frame_samples_; }
+    FrameVerdict classify(const float* frame);
+    float noiseFloor() const { return background_energy_; }
+    void reset();
+
+private:
+    size_t frame_samples_;
+    float on_ratio_;
+    float off_ratio_;
+    float min_energy_;
+
+    std::vector<float> energy_ring_;  // Last window_frames frame energies
+    size_t ring_next_;
+    size_t ring_filled_;
+    double energy_sum_;               // Running sum of the ring
+    double energy_compensation_;      // Kahan low-order bits
+
+    float background_energy_;
+    uint64_t frame_count_;
+
+    void addToSum(double value);
+    void updateBackgroundEnergy(float energy);
+};
+
+// Fixed-level backend: a frame is voice when its RMS is over level. Nothing
+// is learned, so it answers the same from the first frame on. The smart
+// chunker finds pauses with it; an adaptive floor seeded mid-speech would
+// take the speech for background.
+class LevelVadPolicy {
+public:
+    LevelVadPolicy(float level, size_t frame_samples);
+
+    size_t frameSamples() const { return frame_samples_; }
+    FrameVerdict classify(const float* frame);
+    void reset() {}
+
+private:
+    size_t frame_samples_;
+    float min_sum_of_squares_;  // level squared times frame length: no sqrt per frame
+};
+
+// Spectral backend for rooms where loud does not mean speech. Frames that
+// pass an energy detector are also required to look like voiced speech: most
+// of their power in the 300-3400 Hz band, a peaky (harmonic) rather than flat
+// spectrum there, a low zero-crossing rate, and a level that moves with
+// syllables (log-energy spread over the last 500 ms). Keyboard clicks fail
+// flatness and onset length, fans fail flatness and modulation, sustained
+// music fails modulation.
+class SpectralVadPolicy {
+public:
+    struct Features {
+        float energy = 0.0f;              // Frame RMS
+        float speech_band_ratio = 0.0f;   // Share of power in 300-3400 Hz
+        float flatness = 1.0f;            // Geometric / arithmetic mean power in band
+        float zero_crossing_rate = 0.0f;  // Sign changes per sample
+        float modulation_db = 0.0f;       // Std dev of frame level over 500 ms
+    };
+
+    // window_frames and hangover_frames configure the energy detector
+    SpectralVadPolicy(float threshold = 0.6f, int sample_rate = 16000, size_t window_frames = 10,
+                      size_t hangover_frames = 15, float min_energy = 0.0f);
+
+    size_t frameSamples() const { return frame_samples_; }
+    FrameVerdict classify(const float* frame);
+    float noiseFloor() const { return energy_.policy().noiseFloor(); }
+    const Features& lastFeatures() const { return features_; }
+    void reset();
+
+private:
+    FrameVad<EnergyVadPolicy> energy_;  // Loudness gate, fed one frame at a time
+    size_t frame_samples_;
+    size_t band_begin_;               // FFT bins of the speech band
+    size_t band_end_;
+
+    RealFft fft_;
+    std::vector<float> window_;       // Hann over the frame, zeros to FFT size
+    std::vector<float> windowed_;
+    std::vector<float> power_;
+
+    std::vector<float> level_ring_;   // Recent frame levels in dB
+    size_t level_next_;
+    size_t level_filled_;
+
+    Features features_;
+};
+
+using EnergyVad = FrameVad<EnergyVadPolicy>;
+using LevelVad = FrameVad<LevelVadPolicy>;
+using SpectralVad = FrameVad<SpectralVadPolicy>;
+
+// Onset frames each backend wants before switching voice on: one loud frame
+// is enough for the smoothed energy, a lone speech-like spectrum is not
+constexpr size_t ENERGY_VAD_ONSET_FRAMES = 1;
+constexpr size_t SPECTRAL_VAD_ONSET_FRAMES = 3;
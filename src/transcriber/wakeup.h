@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+// Lets a thread sleep until a lock-free queue it polls has something for it.
+//
+// The waiter re-checks its condition under the mutex before sleeping, and
+// notify() only takes the mutex when someone is waiting, so producers stay
+// lock-free while the consumer is busy. The fences pair up so that either the
+// waiter sees the producer's update or the producer sees the waiter.
+class Wakeup {
+public:
+    Wakeup() = default;
+    Wakeup(const Wakeup&) = delete;
+    Wakeup& operator=(const Wakeup&) = delete;
+
+    // Returns ready() once it holds or the timeout passes
+    template <typename Ready>
+    bool waitFor(Ready ready, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiters_.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool result = cv_.wait_for(lock, timeout, ready);
+        waiters_.fetch_sub(1);
+        return result;
+    }
+
+    // Call after publishing what a waiter's ready() checks
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cv_.notify_all();
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::atomic<int> waiters_{0};
+};
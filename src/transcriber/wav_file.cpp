@@ -0,0 +1,176 @@
+#include "wav_file.h"
+#include "pcm_convert.h"
+#include "resampler.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint16_t WAV_FORMAT_PCM = 1;
+constexpr uint16_t WAV_FORMAT_FLOAT = 3;
+constexpr uint16_t WAV_FORMAT_EXTENSIBLE = 0xFFFE;
+
+uint32_t readU32(const char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint16_t readU16(const char* p) {
+    uint16_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+} // namespace
+
+WavFile::WavFile()
+    : mapping_(nullptr)
+    , mapping_bytes_(0)
+    , data_(nullptr)
+    , sample_rate_(0)
+    , channels_(0)
+    , format_(AudioSampleFormat::Float32)
+    , frames_(0) {
+}
+
+WavFile::~WavFile() {
+    if (mapping_) {
+        munmap(mapping_, mapping_bytes_);
+    }
+}
+
+bool WavFile::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "❌ Failed to open audio file: " << path << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 44) {
+        std::cerr << "❌ Audio file too small: " << path << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    mapping_bytes_ = st.st_size;
+    mapping_ = mmap(nullptr, mapping_bytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        std::cerr << "❌ Failed to map audio file: " << path << std::endl;
+        return false;
+    }
+    madvise(mapping_, mapping_bytes_, MADV_SEQUENTIAL);
+
+    const char* base = static_cast<const char*>(mapping_);
+    if (std::memcmp(base, "RIFF", 4) != 0 || std::memcmp(base + 8, "WAVE", 4) != 0) {
+        std::cerr << "❌ Not a WAV file: " << path << std::endl;
+        return false;
+    }
+
+    // Walk the chunk list for "fmt " and "data"
+    uint16_t wav_format = 0;
+    uint16_t bits = 0;
+    size_t data_bytes = 0;
+    size_t offset = 12;
+    while (offset + 8 <= mapping_bytes_) {
+        const char* chunk = base + offset;
+        size_t chunk_bytes = readU32(chunk + 4);
+        size_t body = offset + 8;
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && chunk_bytes >= 16 && body + 16 <= mapping_bytes_) {
+            wav_format = readU16(base + body);
+            channels_ = readU16(base + body + 2);
+            sample_rate_ = readU32(base + body + 4);
+            bits = readU16(base + body + 14);
+            if (wav_format == WAV_FORMAT_EXTENSIBLE && chunk_bytes >= 26) {
+                wav_format = readU16(base + body + 24);
+            }
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            data_ = base + body;
+            data_bytes = std::min(chunk_bytes, mapping_bytes_ - body);
+            break;
+        }
+
+        offset = body + chunk_bytes + (chunk_bytes & 1);
+    }
+
+    if (wav_format == WAV_FORMAT_PCM && bits == 16) {
+        format_ = AudioSampleFormat::Int16;
+    } else if (wav_format == WAV_FORMAT_FLOAT && bits == 32) {
+        format_ = AudioSampleFormat::Float32;
+    } else {
+        std::cerr << "❌ Unsupported WAV format (need 16-bit PCM or 32-bit float): " << path << std::endl;
+        return false;
+    }
+    if (!data_ || channels_ == 0 || sample_rate_ == 0) {
+        std::cerr << "❌ Malformed WAV file: " << path << std::endl;
+        return false;
+    }
+
+    frames_ = data_bytes / (sampleFormatBytes(static_cast<uint16_t>(format_)) * channels_);
+    return true;
+}
+
+size_t WavFile::readFloat(size_t offset, float* out, size_t count, uint16_t channel) const {
+    if (offset >= frames_ || channel >= channels_) {
+        return 0;
+    }
+    count = std::min(count, frames_ - offset);
+
+    if (format_ == AudioSampleFormat::Int16) {
+        const int16_t* samples = reinterpret_cast<const int16_t*>(data_);
+        if (channels_ == 1) {
+            convertS16ToFloat(samples + offset, out, count);
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                out[i] = samples[(offset + i) * channels_ + channel] * (1.0f / 32768.0f);
+            }
+        }
+    } else {
+        const float* samples = reinterpret_cast<const float*>(data_);
+        if (channels_ == 1) {
+            std::memcpy(out, samples + offset, count * sizeof(float));
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                out[i] = samples[(offset + i) * channels_ + channel];
+            }
+        }
+    }
+    return count;
+}
+
+size_t WavFile::readMono(size_t offset, float* out, size_t count) const {
+    if (channels_ == 1) {
+        return readFloat(offset, out, count);
+    }
+    if (offset >= frames_) {
+        return 0;
+    }
+    count = std::min(count, frames_ - offset);
+
+    // Convert a block of interleaved frames at a time, then downmix
+    constexpr size_t BLOCK_FRAMES = 1024;
+    std::vector<float> interleaved(std::min(count, BLOCK_FRAMES) * channels_);
+    for (size_t done = 0; done < count;) {
+        size_t frames = std::min(count - done, BLOCK_FRAMES);
+        size_t samples = frames * channels_;
+        size_t first = (offset + done) * channels_;
+        if (format_ == AudioSampleFormat::Int16) {
+            convertS16ToFloat(reinterpret_cast<const int16_t*>(data_) + first, interleaved.data(), samples);
+        } else {
+            std::memcpy(interleaved.data(), reinterpret_cast<const float*>(data_) + first, samples * sizeof(float));
+        }
+        downmixToMono(interleaved.data(), frames, channels_, out + done);
+        done += frames;
+    }
+    return count;
+}
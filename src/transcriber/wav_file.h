@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "wire_protocol.h"
+
+// Read-only, memory-mapped WAV file (PCM 16-bit or IEEE float 32-bit).
+// Sample data is used in place from the mapping; nothing is read up front.
+class WavFile {
+public:
+    WavFile();
+    ~WavFile();
+
+    WavFile(const WavFile&) = delete;
+    WavFile& operator=(const WavFile&) = delete;
+
+    bool open(const std::string& path);
+
+    uint32_t sampleRate() const { return sample_rate_; }
+    uint16_t channels() const { return channels_; }
+    AudioSampleFormat format() const { return format_; }
+    size_t frames() const { return frames_; }
+    const char* data() const { return data_; }
+
+    // Converts frames [offset, offset + count) of one channel to float and
+    // returns how many were written
+    size_t readFloat(size_t offset, float* out, size_t count, uint16_t channel = 0) const;
+
+    // Same, averaging all channels into mono
+    size_t readMono(size_t offset, float* out, size_t count) const;
+
+private:
+    void* mapping_;
+    size_t mapping_bytes_;
+    const char* data_;
+    uint32_t sample_rate_;
+    uint16_t channels_;
+    AudioSampleFormat format_;
+    size_t frames_;
+};
@@ -0,0 +1,73 @@
+#include "whisper_model.h"
+#include "whisper.h"
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <unistd.h>
+
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+
+namespace {
+
+std::mutex g_models_mutex;
+std::map<std::string, std::weak_ptr<WhisperModel>> g_models;  // Guarded by g_models_mutex
+
+} // namespace
+
+std::shared_ptr<WhisperModel> WhisperModel::acquire(const std::string& path, bool use_gpu) {
+    // Held across the load so two sessions starting together load once
+    std::lock_guard<std::mutex> lock(g_models_mutex);
+    std::shared_ptr<WhisperModel> model = g_models[path].lock();
+    if (model) {
+        std::cout << "♻️ Sharing loaded model with " << model.use_count() - 1 << " other session(s)" << std::endl;
+        return model;
+    }
+
+    struct whisper_context_params cparams = whisper_context_default_params();
+    cparams.use_gpu = use_gpu;
+
+    size_t resident_before = residentMemoryBytes();
+
+    whisper_context* ctx = whisper_init_from_file_with_params(path.c_str(), cparams);
+    if (!ctx) {
+        std::cerr << "❌ Failed to load model: " << path << std::endl;
+        return nullptr;
+    }
+
+    size_t resident_after = residentMemoryBytes();
+    model.reset(new WhisperModel(path, ctx, resident_after > resident_before ? resident_after - resident_before : 0));
+    g_models[path] = model;
+    return model;
+}
+
+WhisperModel::WhisperModel(const std::string& path, whisper_context* ctx, size_t resident_bytes)
+    : path_(path)
+    , ctx_(ctx)
+    , resident_bytes_(resident_bytes) {
+}
+
+WhisperModel::~WhisperModel() {
+    whisper_free(ctx_);
+}
+
+size_t residentMemoryBytes() {
+#ifdef __APPLE__
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.resident_size;
+#else
+    std::ifstream statm("/proc/self/statm");
+    size_t total_pages = 0;
+    size_t resident_pages = 0;
+    if (!(statm >> total_pages >> resident_pages)) {
+        return 0;
+    }
+    return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+struct whisper_context;
+struct whisper_state;
+
+// Shortest input to hand whisper_full: 1.1 s at 16 kHz. whisper.cpp refuses
+// input under 1000 ms of mel frames, and the extra 100 ms keeps frame
+// rounding from pushing a padded chunk back under that.
+constexpr size_t WHISPER_MIN_SAMPLES = 17600;
+
+// A loaded whisper context shared by every transcriber in the process.
+// whisper.cpp copies the weights into buffers it owns, so a model's memory
+// cannot be shared between processes; within one, the weights are loaded
+// once and each session only adds its own whisper_state (KV caches and
+// compute buffers). acquire() returns the live instance for a path if there
+// is one, so a second session costs no model memory.
+class WhisperModel {
+public:
+    static std::shared_ptr<WhisperModel> acquire(const std::string& path, bool use_gpu);
+    ~WhisperModel();
+
+    WhisperModel(const WhisperModel&) = delete;
+    WhisperModel& operator=(const WhisperModel&) = delete;
+
+    whisper_context* context() const { return ctx_; }
+    const std::string& path() const { return path_; }
+    // Process RSS growth while the weights were loaded
+    size_t residentBytes() const { return resident_bytes_; }
+
+private:
+    WhisperModel(const std::string& path, whisper_context* ctx, size_t resident_bytes);
+
+    std::string path_;
+    whisper_context* ctx_;
+    size_t resident_bytes_;
+};
+
+// Resident set size of this process in bytes, or 0 where unsupported
+size_t residentMemoryBytes();
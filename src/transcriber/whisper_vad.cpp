@@ -0,0 +1,70 @@
+#include "whisper_vad.h"
+#include "whisper.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// Windows scored ahead of each frame to warm the LSTM up (256 ms)
+constexpr size_t CONTEXT_SAMPLES = 8 * WhisperVadPolicy::WINDOW_SAMPLES;
+static_assert(CONTEXT_SAMPLES <= WhisperVadPolicy::FRAME_SAMPLES, "context is taken from one frame");
+
+} // namespace
+
+WhisperVadPolicy::WhisperVadPolicy(const std::string& model_path, float threshold, int threads)
+    : ctx_(nullptr)
+    , input_(CONTEXT_SAMPLES + FRAME_SAMPLES)
+    , context_fill_(0)
+    , probability_(0.0f) {
+    on_probability_ = std::clamp(threshold, 0.05f, 0.95f);
+    off_probability_ = std::max(on_probability_ - 0.15f, 0.01f);
+
+    whisper_vad_context_params params = whisper_vad_default_context_params();
+    params.n_threads = std::max(threads, 1);
+    ctx_ = whisper_vad_init_from_file_with_params(model_path.c_str(), params);
+    if (!ctx_) {
+        std::cerr << "❌ Failed to load VAD model: " << model_path << std::endl;
+    }
+}
+
+WhisperVadPolicy::~WhisperVadPolicy() {
+    if (ctx_) {
+        whisper_vad_free(ctx_);
+    }
+}
+
+FrameVerdict WhisperVadPolicy::classify(const float* frame) {
+    if (!ctx_) {
+        return FrameVerdict::Silence;
+    }
+
+    // One model call per stride; the context is the only audio copied twice
+    std::memcpy(input_.data() + CONTEXT_SAMPLES, frame, FRAME_SAMPLES * sizeof(float));
+    const float* input = input_.data() + CONTEXT_SAMPLES - context_fill_;
+    int input_samples = static_cast<int>(context_fill_ + FRAME_SAMPLES);
+
+    probability_ = 0.0f;
+    if (whisper_vad_detect_speech(ctx_, input, input_samples)) {
+        int n_probs = whisper_vad_n_probs(ctx_);
+        const float* probs = whisper_vad_probs(ctx_);
+        for (int i = std::max(n_probs - static_cast<int>(STRIDE_WINDOWS), 0); i < n_probs; i++) {
+            probability_ = std::max(probability_, probs[i]);
+        }
+    }
+    std::memcpy(input_.data(), frame + FRAME_SAMPLES - CONTEXT_SAMPLES, CONTEXT_SAMPLES * sizeof(float));
+    context_fill_ = CONTEXT_SAMPLES;
+
+    if (probability_ >= on_probability_) {
+        return FrameVerdict::Onset;
+    }
+    if (probability_ >= off_probability_) {
+        return FrameVerdict::Hold;
+    }
+    return FrameVerdict::Silence;
+}
+
+void WhisperVadPolicy::reset() {
+    context_fill_ = 0;
+    probability_ = 0.0f;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "voice_activity.h"
+
+struct whisper_vad_context;
+
+// whisper.cpp's built-in VAD (Silero) as a FrameVad backend.
+// whisper_vad_detect_speech restarts the model's LSTM state on every call and
+// the API offers no way to carry it, so each call warms the model up on the
+// windows before the ones being scored. To keep that overhead small a frame
+// is a stride of eight 512-sample model windows (256 ms at 16 kHz), scored in
+// one call after the previous stride's last eight windows: two windows of
+// model work per window of audio. The frame's probability is the highest of
+// its windows; the threshold is the probability that switches voice on.
+class WhisperVadPolicy {
+public:
+    static constexpr size_t WINDOW_SAMPLES = 512;  // Silero's input window
+    static constexpr size_t STRIDE_WINDOWS = 8;
+    static constexpr size_t FRAME_SAMPLES = WINDOW_SAMPLES * STRIDE_WINDOWS;
+
+    WhisperVadPolicy(const std::string& model_path, float threshold = 0.5f, int threads = 1);
+    ~WhisperVadPolicy();
+
+    WhisperVadPolicy(const WhisperVadPolicy&) = delete;
+    WhisperVadPolicy& operator=(const WhisperVadPolicy&) = delete;
+
+    bool isLoaded() const { return ctx_ != nullptr; }
+    size_t frameSamples() const { return FRAME_SAMPLES; }
+    FrameVerdict classify(const float* frame);
+    float lastProbability() const { return probability_; }
+    void reset();
+
+private:
+    whisper_vad_context* ctx_;
+    float on_probability_;
+    float off_probability_;
+    std::vector<float> input_;    // Context windows from the last frame, then the current frame
+    size_t context_fill_;         // Context samples at the end of the context area
+    float probability_;
+};
+
+using WhisperVad = FrameVad<WhisperVadPolicy>;
+
+// The model already smooths over its context, so one confident frame is enough
+constexpr size_t WHISPER_VAD_ONSET_FRAMES = 1;
@@ -0,0 +1,154 @@
+#include "wire_protocol.h"
+#include "pcm_convert.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+AudioFrameParser::AudioFrameParser(uint32_t expected_sample_rate)
+    : expected_sample_rate_(expected_sample_rate)
+    , have_stream_(false)
+    , stream_id_(0)
+    , expected_sequence_(0)
+    , expected_time_ns_(0)
+    , last_frame_samples_(0)
+    , convert_buffer_(AUDIO_FRAME_MAX_PAYLOAD / sizeof(int16_t)) {
+}
+
+size_t AudioFrameParser::parse(const char* data, size_t size,
+                               const FrameSamplesHandler& on_samples, const FrameGapHandler& on_gap) {
+    static const char magic[4] = {'A', 'U', 'D', 'F'};
+    size_t offset = 0;
+
+    while (size - offset >= sizeof(AudioFrameHeader)) {
+        // Only the fixed-size header is copied; the payload is used in place
+        AudioFrameHeader header;
+        std::memcpy(&header, data + offset, sizeof(header));
+
+        if (!isValidHeader(header)) {
+            // Resync: skip ahead to the next candidate magic
+            const char* next = std::search(data + offset + 1, data + size, magic, magic + 4);
+            size_t next_offset = next - data;
+            if (next_offset + 4 > size) {
+                // Keep a possible partial magic at the tail for the next read
+                next_offset = std::max(offset + 1, size - 3);
+            }
+            stats_.resyncs += next_offset - offset;
+            offset = next_offset;
+            continue;
+        }
+
+        size_t frame_bytes = header.header_size + header.payload_bytes;
+        if (size - offset < frame_bytes) {
+            break;
+        }
+
+        handleFrame(header, data + offset + header.header_size, on_samples, on_gap);
+        offset += frame_bytes;
+    }
+
+    return offset;
+}
+
+bool AudioFrameParser::isValidHeader(const AudioFrameHeader& header) const {
+    return header.magic == AUDIO_FRAME_MAGIC &&
+           header.version >= 1 &&
+           header.header_size >= sizeof(AudioFrameHeader) &&
+           header.header_size % sizeof(float) == 0 &&
+           header.header_size + header.payload_bytes <= AUDIO_FRAME_MAX_BYTES &&
+           header.sample_rate > 0 &&
+           header.channels > 0;
+}
+
+void AudioFrameParser::handleFrame(const AudioFrameHeader& header, const char* payload,
+                                   const FrameSamplesHandler& on_samples, const FrameGapHandler& on_gap) {
+    stats_.frames++;
+
+    if (have_stream_ && header.stream_id != stream_id_) {
+        // Capture restarted: its clock and sequence start over
+        std::cerr << "⚠️ Audio capture restarted (stream " << std::hex << header.stream_id
+                  << std::dec << ")" << std::endl;
+        stats_.restarts++;
+        have_stream_ = false;
+        resampler_.reset();
+    }
+
+    if (have_stream_ && header.sequence != expected_sequence_) {
+        int32_t lost = static_cast<int32_t>(header.sequence - expected_sequence_);
+        if (lost < 0) {
+            stats_.stale_frames++;
+            return;
+        }
+
+        // Size the gap from the capture clock, falling back to frame counts
+        uint64_t gap_samples = uint64_t(lost) * last_frame_samples_;
+        if (header.capture_time_ns > expected_time_ns_ && expected_time_ns_ > 0) {
+            gap_samples = (header.capture_time_ns - expected_time_ns_) * expected_sample_rate_ / 1000000000ull;
+        }
+
+        stats_.sequence_gaps++;
+        stats_.lost_frames += lost;
+        reportGap(gap_samples, on_gap);
+    }
+
+    const size_t sample_bytes = sampleFormatBytes(header.sample_format);
+    const size_t bytes_per_frame = sample_bytes * header.channels;
+    const uint64_t frame_count = bytes_per_frame > 0 ? header.payload_bytes / bytes_per_frame : 0;
+
+    have_stream_ = true;
+    stream_id_ = header.stream_id;
+    expected_sequence_ = header.sequence + 1;
+    expected_time_ns_ = header.capture_time_ns + frame_count * 1000000000ull / header.sample_rate;
+
+    if (sample_bytes == 0 || header.payload_bytes % bytes_per_frame != 0) {
+        // Cannot consume this frame; keep its duration on the timeline
+        stats_.format_errors++;
+        reportGap(frame_count * expected_sample_rate_ / header.sample_rate, on_gap);
+        return;
+    }
+
+    last_frame_samples_ = frame_count * expected_sample_rate_ / header.sample_rate;
+    const size_t sample_count = frame_count * header.channels;
+    const bool native = header.channels == 1 && header.sample_rate == expected_sample_rate_;
+
+    const float* samples;
+    if (header.sample_format == static_cast<uint16_t>(AudioSampleFormat::Int16)) {
+        convertS16ToFloat(reinterpret_cast<const int16_t*>(payload), convert_buffer_.data(), sample_count);
+        samples = convert_buffer_.data();
+    } else if (!native || reinterpret_cast<uintptr_t>(payload) % alignof(float) != 0) {
+        // Converted in place below, or left misaligned by a preceding odd-sized frame
+        std::memcpy(convert_buffer_.data(), payload, header.payload_bytes);
+        samples = convert_buffer_.data();
+    } else {
+        samples = reinterpret_cast<const float*>(payload);
+    }
+
+    if (native) {
+        on_samples(samples, frame_count);
+        return;
+    }
+
+    stats_.converted_frames++;
+    downmixToMono(samples, frame_count, header.channels, convert_buffer_.data());
+    if (header.sample_rate == expected_sample_rate_) {
+        on_samples(convert_buffer_.data(), frame_count);
+        return;
+    }
+
+    if (!resampler_ || resampler_->inputRate() != header.sample_rate) {
+        resampler_ = std::make_unique<PolyphaseResampler>(header.sample_rate, expected_sample_rate_);
+    }
+    resample_buffer_.clear();
+    resampler_->process(convert_buffer_.data(), frame_count, resample_buffer_);
+    if (!resample_buffer_.empty()) {
+        on_samples(resample_buffer_.data(), resample_buffer_.size());
+    }
+}
+
+void AudioFrameParser::reportGap(uint64_t samples, const FrameGapHandler& on_gap) {
+    samples = std::min<uint64_t>(samples, uint64_t(AUDIO_MAX_GAP_FILL_SECONDS) * expected_sample_rate_);
+    if (samples == 0) {
+        return;
+    }
+    stats_.silence_samples += samples;
+    on_gap(samples);
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "resampler.h"
+
+// Framed audio wire protocol for the capture -> transcriber pipe.
+//
+// The stream is a sequence of frames, each an AudioFrameHeader followed by
+// payload_bytes of interleaved little-endian samples. header_size lets newer
+// producers append fields that older readers skip. Frames at any sample rate
+// and channel count are downmixed and resampled to the expected rate. Raw
+// (headerless float32 mono 16 kHz) input remains supported by the reader.
+
+static constexpr uint32_t AUDIO_FRAME_MAGIC = 0x46445541;  // "AUDF" little-endian
+static constexpr uint16_t AUDIO_WIRE_VERSION = 1;
+static constexpr uint32_t AUDIO_FRAME_MAX_PAYLOAD = 65536;
+static constexpr int AUDIO_MAX_GAP_FILL_SECONDS = 60;
+
+enum class AudioSampleFormat : uint16_t {
+    Float32 = 1,
+    Int16 = 2     // Signed 16-bit little-endian, converted to float on arrival
+};
+
+// Bytes per sample for a format, or 0 if unknown
+inline size_t sampleFormatBytes(uint16_t format) {
+    switch (static_cast<AudioSampleFormat>(format)) {
+        case AudioSampleFormat::Float32: return 4;
+        case AudioSampleFormat::Int16: return 2;
+    }
+    return 0;
+}
+
+#pragma pack(push, 1)
+struct AudioFrameHeader {
+    uint32_t magic;            // AUDIO_FRAME_MAGIC
+    uint16_t version;          // AUDIO_WIRE_VERSION
+    uint16_t header_size;      // Bytes from frame start to payload, multiple of 4
+    uint32_t sample_rate;
+    uint16_t channels;
+    uint16_t sample_format;    // AudioSampleFormat
+    uint32_t stream_id;        // Random per capture process; changes on restart
+    uint32_t sequence;         // Increments by one per frame
+    uint32_t payload_bytes;
+    uint32_t reserved;
+    uint64_t capture_time_ns;  // Producer monotonic clock at first sample
+};
+#pragma pack(pop)
+
+static_assert(sizeof(AudioFrameHeader) == 40, "AudioFrameHeader must stay 40 bytes");
+
+static constexpr size_t AUDIO_FRAME_MAX_BYTES = sizeof(AudioFrameHeader) + AUDIO_FRAME_MAX_PAYLOAD;
+
+struct AudioFrameStats {
+    uint64_t frames = 0;
+    uint64_t sequence_gaps = 0;    // Discontinuities in the sequence number
+    uint64_t lost_frames = 0;
+    uint64_t silence_samples = 0;  // Samples of silence inserted for gaps
+    uint64_t restarts = 0;         // Capture stream_id changes
+    uint64_t format_errors = 0;    // Frames in a format we cannot consume
+    uint64_t converted_frames = 0; // Frames downmixed or resampled on arrival
+    uint64_t stale_frames = 0;     // Duplicate or out-of-order frames
+    uint64_t resyncs = 0;          // Bytes skipped hunting for a frame header
+};
+
+using FrameSamplesHandler = std::function<void(const float* samples, size_t count)>;
+using FrameGapHandler = std::function<void(uint64_t silence_samples)>;
+
+// Parses frames in place: float32 mono payloads at the expected rate are
+// handed to on_samples as pointers into the caller's buffer, so the buffer
+// must be 4-byte aligned. Anything else is converted in reusable scratch
+// buffers first.
+class AudioFrameParser {
+public:
+    explicit AudioFrameParser(uint32_t expected_sample_rate);
+
+    // Consumes every complete frame in data and returns the number of bytes used;
+    // the caller keeps the remainder and prepends it to the next read.
+    size_t parse(const char* data, size_t size,
+                 const FrameSamplesHandler& on_samples, const FrameGapHandler& on_gap);
+
+    const AudioFrameStats& stats() const { return stats_; }
+
+private:
+    void handleFrame(const AudioFrameHeader& header, const char* payload,
+                     const FrameSamplesHandler& on_samples, const FrameGapHandler& on_gap);
+    void reportGap(uint64_t samples, const FrameGapHandler& on_gap);
+    bool isValidHeader(const AudioFrameHeader& header) const;
+
+    uint32_t expected_sample_rate_;
+    bool have_stream_;
+    uint32_t stream_id_;
+    uint32_t expected_sequence_;
+    uint64_t expected_time_ns_;
+    uint64_t last_frame_samples_;
+    AudioFrameStats stats_;
+    std::vector<float> convert_buffer_;
+    std::unique_ptr<PolyphaseResampler> resampler_;  // Kept across frames for filter history
+    std::vector<float> resample_buffer_;
+};